@@ -3,6 +3,7 @@
 set prefix="C:\Program Files\WebIssues Client\1.0"
 set config=release
 set syssqlite=no
+set benchmarks=no
 set msvc=no
 set incdir=
 set libdir=
@@ -17,6 +18,7 @@ if "%1" == "" goto arg_done
 if "%1" == "-prefix" goto arg_prefix
 if "%1" == "-debug" goto arg_debug
 if "%1" == "-system-sqlite" goto arg_syssqlite
+if "%1" == "-benchmarks" goto arg_benchmarks
 if "%1" == "-msvc" goto arg_msvc
 if "%1" == "-I" goto arg_incdir
 if "%1" == "-L" goto arg_libdir
@@ -40,6 +42,10 @@ goto arg_next
 set syssqlite=yes
 goto arg_next
 
+:arg_benchmarks
+set benchmarks=yes
+goto arg_next
+
 :arg_msvc
 set msvc=yes
 goto arg_next
@@ -59,8 +65,8 @@ shift
 goto arg_loop
 
 :show_usage
-echo Usage: configure [-prefix DIR] [-debug] [-system-sqlite] [-msvc]
-echo                  [-I DIRS] [-L DIRS]
+echo Usage: configure [-prefix DIR] [-debug] [-system-sqlite] [-benchmarks]
+echo                  [-msvc] [-I DIRS] [-L DIRS]
 echo.
 echo Options:
 echo.
@@ -68,6 +74,7 @@ echo   -prefix DIR    Set the instalation directory to DIR
 echo                    (default: C:\Program Files\WebIssues Client\1.0)
 echo   -debug         Build with debugging symbols
 echo   -system-sqlite Use system SQLite library
+echo   -benchmarks    Build the performance benchmarks
 echo   -msvc          Generate Visual Studio solution
 echo   -I DIRS        Specify additional include directories
 echo   -L DIRS        Specify additional library directories
@@ -104,6 +111,7 @@ echo CONFIG += %config% >>config.pri
 echo PREFIX = %prefix:\=\\% >>config.pri
 
 if "%syssqlite%" == "yes" echo CONFIG += system-sqlite >>config.pri
+if "%benchmarks%" == "yes" echo CONFIG += benchmarks >>config.pri
 
 if "%msvc%" == "yes" goto gen_msvc
 
@@ -61,8 +61,11 @@
 
 Application* application = NULL;
 
-Application::Application( int& argc, char** argv ) : QApplication( argc, argv ),
+Application::Application( int& argc, char** argv, bool headless ) : QApplication( argc, argv ),
+    m_mainWindow( NULL ),
     m_portable( false ),
+    m_headless( headless ),
+    m_updateClient( NULL ),
     m_printer( NULL )
 {
     Q_INIT_RESOURCE( icons );
@@ -92,11 +95,6 @@ Application::Application( int& argc, char** argv ) : QApplication( argc, argv ),
     setWindowIcon( IconLoader::icon( "webissues" ) );
     setQuitOnLastWindowClosed( false );
 
-    viewManager = new ViewManager();
-    dialogManager = new DialogManager();
-
-    m_mainWindow = new MainWindow();
-
     m_editorFont.setFamily( "Verdana, DejaVu Sans" );
     m_editorFont.setPointSizeF( font().pointSizeF() );
     m_editorFont.setStyleHint( QFont::SansSerif );
@@ -105,6 +103,14 @@ Application::Application( int& argc, char** argv ) : QApplication( argc, argv ),
 
     m_manager->setProxyFactory( new NetworkProxyFactory() );
 
+    if ( m_headless )
+        return;
+
+    viewManager = new ViewManager();
+    dialogManager = new DialogManager();
+
+    m_mainWindow = new MainWindow();
+
     m_updateClient = new UpdateClient( "webissues", version(), m_manager );
 
     connect( m_updateClient, SIGNAL( stateChanged() ), this, SLOT( showUpdateState() ) );
@@ -118,8 +124,10 @@ Application::Application( int& argc, char** argv ) : QApplication( argc, argv ),
 
 Application::~Application()
 {
-    m_settings->setValue( "ShutdownVisible", m_mainWindow->isVisible() );
-    m_settings->setValue( "ShutdownConnected", dataManager != NULL && dataManager->currentUserAccess() != NoAccess );
+    if ( !m_headless ) {
+        m_settings->setValue( "ShutdownVisible", m_mainWindow->isVisible() );
+        m_settings->setValue( "ShutdownConnected", dataManager != NULL && dataManager->currentUserAccess() != NoAccess );
+    }
 
     delete m_updateSection;
 
@@ -517,6 +525,7 @@ void Application::initializeSettings()
         { "AutoUpdate", true },
         { "TextSizeMultiplier", 100 },
         { "DefaultAttachmentAction", (int)ActionAsk },
+        { "AttachmentsCacheSize", 50 },
         { "FolderUpdateInterval", 1 },
         { "UpdateInterval", 5 },
         { "ProxyType", (int)QNetworkProxy::NoProxy },
@@ -54,8 +54,11 @@ class Application : public QApplication
 public:
     /**
     * Constructor.
+    * @param headless If @c true, the main window is not created and the
+    * previous state is not restored. It is used to run the application
+    * code without user interface, for example in benchmarks.
     */
-    Application( int& argc, char** argv );
+    Application( int& argc, char** argv, bool headless = false );
 
     /**
     * Destructor.
@@ -220,6 +223,7 @@ private:
     QString m_sharedCachePath;
 
     bool m_portable;
+    bool m_headless;
 
     LocalSettings* m_settings;
     BookmarksStore* m_bookmarks;
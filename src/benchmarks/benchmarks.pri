@@ -0,0 +1,36 @@
+include( $$PWD/../../config.pri )
+
+TEMPLATE = app
+
+CONFIG  += qt console
+CONFIG  -= app_bundle
+QT      += widgets printsupport network xml sql webkit webkitwidgets
+
+INCLUDEPATH += $$PWD/.. $$PWD/common
+
+CONFIG( debug, debug|release ) {
+    COMMON_DIR = $$OUT_PWD/../debug
+} else {
+    COMMON_DIR = $$OUT_PWD/../release
+}
+
+# the application code and helper classes shared by all benchmarks
+LIBS += -L$$COMMON_DIR -lcommon
+
+win32-msvc* {
+    PRE_TARGETDEPS += $$COMMON_DIR/common.lib
+} else {
+    PRE_TARGETDEPS += $$COMMON_DIR/libcommon.a
+}
+
+system-sqlite {
+    LIBS += -lsqlite3
+}
+
+win32 {
+    LIBS += -lshell32 -lcrypt32
+}
+
+!win32 | build_pass {
+    DESTDIR = $$COMMON_DIR
+}
@@ -0,0 +1,20 @@
+TEMPLATE = subdirs
+
+SUBDIRS  = common \
+           definitioninfo \
+           issuedetails \
+           markup \
+           queries \
+           refresh \
+           replay \
+           summaryreport \
+           tablereport
+
+definitioninfo.depends = common
+issuedetails.depends = common
+markup.depends = common
+queries.depends = common
+refresh.depends = common
+replay.depends = common
+summaryreport.depends = common
+tablereport.depends = common
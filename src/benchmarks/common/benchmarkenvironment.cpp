@@ -0,0 +1,198 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "benchmarkenvironment.h"
+
+#include "commands/commandmanager.h"
+#include "commands/issuebatch.h"
+#include "commands/loginbatch.h"
+#include "commands/updatebatch.h"
+#include "data/datamanager.h"
+#include "data/query.h"
+
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+
+BenchmarkEnvironment::BenchmarkEnvironment( int argc, char** argv ) :
+    m_loop( NULL ),
+    m_successful( false ),
+    m_downloadSkipped( false ),
+    m_fileFailed( false )
+{
+    for ( int i = 0; i < argc; i++ )
+        m_arguments.append( QString::fromLocal8Bit( argv[ i ] ) );
+
+    if ( qgetenv( "QT_QPA_PLATFORM" ).isEmpty() )
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+    // the application only parses its own options, so the remaining arguments can be passed as well
+    m_data.append( QByteArray( argv[ 0 ] ) );
+    m_data.append( "-data" );
+    m_data.append( QFile::encodeName( m_dir.path() + "/data" ) );
+    m_data.append( "-cache" );
+    m_data.append( QFile::encodeName( m_dir.path() + "/cache" ) );
+    m_data.append( "-shared" );
+    m_data.append( QFile::encodeName( m_dir.path() + "/shared" ) );
+
+    for ( int i = 1; i < argc; i++ )
+        m_data.append( QByteArray( argv[ i ] ) );
+
+    for ( int i = 0; i < m_data.count(); i++ )
+        m_argv.append( m_data[ i ].data() );
+    m_argv.append( NULL );
+
+    m_argc = m_data.count();
+}
+
+BenchmarkEnvironment::~BenchmarkEnvironment()
+{
+}
+
+bool BenchmarkEnvironment::openConnection( QNetworkAccessManager* manager, const QUrl& url )
+{
+    commandManager = new CommandManager( manager );
+    commandManager->setServerUrl( url );
+
+    dataManager = new DataManager();
+
+    LoginBatch* batch = new LoginBatch();
+    batch->hello();
+    batch->login( "admin", "admin" );
+
+    if ( !executeBatch( batch ) || !dataManager->isValid() || dataManager->currentUserAccess() == NoAccess ) {
+        closeConnection();
+        return false;
+    }
+
+    return true;
+}
+
+void BenchmarkEnvironment::closeConnection()
+{
+    delete dataManager;
+    dataManager = NULL;
+
+    delete commandManager;
+    commandManager = NULL;
+}
+
+bool BenchmarkEnvironment::clearCache()
+{
+    QDir dir( m_dir.path() + "/cache" );
+    return dir.removeRecursively();
+}
+
+bool BenchmarkEnvironment::executeBatch( AbstractBatch* batch )
+{
+    QEventLoop loop;
+
+    connect( batch, SIGNAL( completed( bool ) ), this, SLOT( batchCompleted( bool ) ) );
+
+    m_loop = &loop;
+    m_successful = false;
+
+    commandManager->execute( batch );
+
+    loop.exec();
+
+    m_loop = NULL;
+
+    return m_successful;
+}
+
+void BenchmarkEnvironment::batchCompleted( bool successful )
+{
+    m_successful = successful;
+
+    if ( m_loop )
+        m_loop->quit();
+}
+
+QString BenchmarkEnvironment::downloadAttachment( int issueId, int fileId, const QString& name, int size, bool* skipped )
+{
+    QString path = dataManager->findFilePath( fileId );
+
+    if ( !path.isEmpty() ) {
+        if ( skipped )
+            *skipped = true;
+        return path;
+    }
+
+    path = dataManager->generateFilePath( name );
+    dataManager->allocFileSpace( size );
+
+    IssueBatch* batch = new IssueBatch( issueId );
+    batch->getAttachment( fileId, path );
+
+    connect( batch, SIGNAL( completed( bool ) ), this, SLOT( attachmentCompleted() ) );
+
+    m_fileHash.clear();
+    m_downloadSkipped = false;
+    m_fileFailed = false;
+
+    if ( !executeBatch( batch ) || m_fileFailed ) {
+        QFile::remove( path );
+        return QString();
+    }
+
+    if ( skipped )
+        *skipped = m_downloadSkipped;
+
+    return dataManager->commitFile( fileId, path, size, m_fileHash );
+}
+
+void BenchmarkEnvironment::attachmentCompleted()
+{
+    // the batch is deleted right after it is completed
+    IssueBatch* batch = (IssueBatch*)sender();
+
+    m_fileHash = batch->fileHash();
+    m_downloadSkipped = batch->isDownloadSkipped();
+    m_fileFailed = batch->fileError() != QFile::NoError;
+}
+
+bool BenchmarkEnvironment::updateAll()
+{
+    UpdateBatch* batch = new UpdateBatch();
+    batch->updateSettings();
+    batch->updateUsers();
+    batch->updateTypes();
+    batch->updateProjects();
+    batch->updateStates();
+
+    if ( !executeBatch( batch ) )
+        return false;
+
+    Query query;
+
+    batch = new UpdateBatch();
+
+    if ( !query.execQuery( "SELECT project_id FROM projects" ) )
+        return false;
+    while ( query.next() )
+        batch->updateSummary( query.value( 0 ).toInt() );
+
+    if ( !query.execQuery( "SELECT folder_id FROM folders" ) )
+        return false;
+    while ( query.next() )
+        batch->updateFolder( query.value( 0 ).toInt() );
+
+    return executeBatch( batch );
+}
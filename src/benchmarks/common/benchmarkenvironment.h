@@ -0,0 +1,148 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef BENCHMARKENVIRONMENT_H
+#define BENCHMARKENVIRONMENT_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QUrl>
+#include <QVector>
+
+class AbstractBatch;
+
+class QEventLoop;
+class QNetworkAccessManager;
+
+/**
+* Environment for running the application code in benchmarks.
+*
+* The environment must be created before the Application, which should
+* be constructed in headless mode using argc() and argv(). The data and
+* cache files of the application are stored in a temporary directory which
+* is removed when the environment is destroyed, and the offscreen platform
+* is used unless another one is explicitly selected.
+*/
+class BenchmarkEnvironment : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param argc The number of arguments passed to the benchmark.
+    * @param argv The arguments passed to the benchmark.
+    */
+    BenchmarkEnvironment( int argc, char** argv );
+
+    /**
+    * Destructor.
+    */
+    ~BenchmarkEnvironment();
+
+public:
+    /**
+    * Return the number of arguments to pass to the Application.
+    */
+    int& argc() { return m_argc; }
+
+    /**
+    * Return the arguments to pass to the Application.
+    */
+    char** argv() { return m_argv.data(); }
+
+    /**
+    * Return the arguments passed to the benchmark.
+    */
+    const QStringList& arguments() const { return m_arguments; }
+
+    /**
+    * Return the path of the temporary directory.
+    */
+    QString path() const { return m_dir.path(); }
+
+    /**
+    * Connect to a server and log in as the administrator.
+    * The global CommandManager and DataManager are created.
+    * @param manager The network access manager used to send commands.
+    * @param url The URL of the server.
+    * @return @c true if the connection was opened successfully.
+    */
+    bool openConnection( QNetworkAccessManager* manager, const QUrl& url = QUrl( "http://localhost/" ) );
+
+    /**
+    * Close the connection opened by openConnection().
+    */
+    void closeConnection();
+
+    /**
+    * Remove the cache of the application, including the database.
+    * The connection must be closed first, so that the next connection
+    * starts with an empty cache.
+    * @return @c true if the cache was removed successfully.
+    */
+    bool clearCache();
+
+    /**
+    * Execute the batch and wait until it is completed.
+    * @return @c true if the batch was completed successfully.
+    */
+    bool executeBatch( AbstractBatch* batch );
+
+    /**
+    * Download an attachment to the file cache in the same way as the issue view.
+    * The download is skipped if the server reports the hash of a file which is already cached.
+    * @param issueId Identifier of the issue containing the attachment.
+    * @param fileId Identifier of the attachment.
+    * @param name Name of the file.
+    * @param size Size of the file in bytes.
+    * @param skipped If not @c NULL, returns @c true if nothing was downloaded.
+    * @return Path of the cached file or empty string if the download failed.
+    */
+    QString downloadAttachment( int issueId, int fileId, const QString& name, int size, bool* skipped = NULL );
+
+    /**
+    * Download settings, users, types, projects, states,
+    * project summaries and the lists of issues in all folders.
+    * @return @c true if all data was updated successfully.
+    */
+    bool updateAll();
+
+private slots:
+    void batchCompleted( bool successful );
+    void attachmentCompleted();
+
+private:
+    QTemporaryDir m_dir;
+
+    QList<QByteArray> m_data;
+    QVector<char*> m_argv;
+    int m_argc;
+
+    QStringList m_arguments;
+
+    QEventLoop* m_loop;
+    bool m_successful;
+
+    QByteArray m_fileHash;
+    bool m_downloadSkipped;
+    bool m_fileFailed;
+};
+
+#endif
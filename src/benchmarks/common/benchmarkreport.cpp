@@ -0,0 +1,122 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "benchmarkreport.h"
+
+#include "utils/profiler.h"
+
+#include <stdio.h>
+
+BenchmarkReport::BenchmarkReport( const QString& title ) :
+    m_stream( stdout ),
+    m_failures( 0 )
+{
+    m_stream << title << endl;
+    m_stream << QString( title.length(), QLatin1Char( '=' ) ) << endl;
+}
+
+BenchmarkReport::~BenchmarkReport()
+{
+    if ( m_failures > 0 )
+        m_stream << endl << m_failures << " check(s) FAILED" << endl;
+}
+
+void BenchmarkReport::beginSection( const QString& title )
+{
+    m_stream << endl << title << endl;
+    m_stream << QString( title.length(), QLatin1Char( '-' ) ) << endl;
+}
+
+void BenchmarkReport::addTime( const QString& name, qint64 microseconds, int count )
+{
+    QString value = formatTime( microseconds ) + " ms";
+    if ( count > 1 )
+        value += QString( " (%1 us per operation)" ).arg( QString::number( static_cast<double>( microseconds ) / count, 'f', 2 ) );
+
+    writeLine( name, value );
+}
+
+void BenchmarkReport::addThroughput( const QString& name, qint64 microseconds, qint64 bytes )
+{
+    double megabytes = bytes / ( 1024.0 * 1024.0 );
+    double seconds = qMax( microseconds, (qint64)1 ) / 1000000.0;
+
+    writeLine( name, QString( "%1 MB/s (%2 MB in %3 ms)" ).arg( QString::number( megabytes / seconds, 'f', 2 ),
+        QString::number( megabytes, 'f', 2 ), formatTime( microseconds ) ) );
+}
+
+void BenchmarkReport::addValue( const QString& name, const QString& value )
+{
+    writeLine( name, value );
+}
+
+void BenchmarkReport::addFailure( const QString& message )
+{
+    m_stream << "FAILED: " << message << endl;
+
+    m_failures++;
+}
+
+void BenchmarkReport::addProfilerStatistics()
+{
+    foreach ( const Profiler::Statistics& statistics, Profiler::statistics() ) {
+        QString name = QString::fromLatin1( statistics.m_name );
+
+        // counters are reported as raw values
+        if ( statistics.m_counter ) {
+            writeLine( name, QString( "%1 samples, total %2, maximum %3" ).arg( statistics.m_count ).arg( statistics.m_total ).arg( statistics.m_maximum ) );
+        } else {
+            writeLine( name, QString( "%1 calls, total %2 ms, average %3 ms, maximum %4 ms" ).arg( statistics.m_count ).arg( formatTime( statistics.m_total ),
+                formatTime( statistics.m_total / statistics.m_count ), formatTime( statistics.m_maximum ) ) );
+        }
+    }
+}
+
+void BenchmarkReport::addQueryStatistics()
+{
+    foreach ( const Profiler::QueryStatistics& statistics, Profiler::queryStatistics() ) {
+        m_stream << endl << statistics.m_sql.simplified() << endl;
+
+        writeLine( "  time", QString( "%1 calls, average %2 ms, maximum %3 ms" ).arg( statistics.m_count ).arg( formatTime( statistics.m_total / statistics.m_count ),
+            formatTime( statistics.m_maximum ) ) );
+        writeLine( "  rows", QString::number( statistics.m_rows ) );
+
+        foreach ( const QString& step, statistics.m_plan )
+            writeLine( "  plan", step );
+    }
+}
+
+void BenchmarkReport::addPeakMemory()
+{
+    qint64 memory = Profiler::peakMemoryUsage();
+    if ( memory >= 0 )
+        writeLine( "Peak memory usage", QString( "%1 MB" ).arg( QString::number( memory / 1024.0, 'f', 1 ) ) );
+    else
+        writeLine( "Peak memory usage", "unknown" );
+}
+
+QString BenchmarkReport::formatTime( qint64 microseconds )
+{
+    return QString::number( microseconds / 1000.0, 'f', 3 );
+}
+
+void BenchmarkReport::writeLine( const QString& name, const QString& value )
+{
+    m_stream << name.leftJustified( 40, QLatin1Char( ' ' ) ) << ' ' << value << endl;
+}
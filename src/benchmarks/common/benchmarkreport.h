@@ -0,0 +1,119 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+
+#include <QString>
+#include <QTextStream>
+
+/**
+* Class printing the results of a benchmark.
+*
+* Results are written to the standard output as aligned columns, so that
+* the output of two runs can be compared using a diff tool. Failed checks
+* are counted and reflected in the exit code of the benchmark.
+*/
+class BenchmarkReport
+{
+public:
+    /**
+    * Constructor.
+    * @param title The title of the benchmark.
+    */
+    BenchmarkReport( const QString& title );
+
+    /**
+    * Destructor.
+    */
+    ~BenchmarkReport();
+
+public:
+    /**
+    * Start a new section of results.
+    */
+    void beginSection( const QString& title );
+
+    /**
+    * Report the time of an operation.
+    * @param name Name of the operation.
+    * @param microseconds Total time of all repetitions in microseconds.
+    * @param count Number of repetitions.
+    */
+    void addTime( const QString& name, qint64 microseconds, int count = 1 );
+
+    /**
+    * Report the throughput of an operation.
+    * @param name Name of the operation.
+    * @param microseconds Total time in microseconds.
+    * @param bytes Amount of processed data in bytes.
+    */
+    void addThroughput( const QString& name, qint64 microseconds, qint64 bytes );
+
+    /**
+    * Report an arbitrary value.
+    */
+    void addValue( const QString& name, const QString& value );
+
+    /**
+    * Report a failed check.
+    */
+    void addFailure( const QString& message );
+
+    /**
+    * Report the statistics of operations recorded by the Profiler.
+    */
+    void addProfilerStatistics();
+
+    /**
+    * Report the statistics and plans of queries recorded by the Profiler.
+    */
+    void addQueryStatistics();
+
+    /**
+    * Report the peak resident memory of the process.
+    */
+    void addPeakMemory();
+
+    /**
+    * Return the number of failed checks.
+    */
+    int failures() const { return m_failures; }
+
+    /**
+    * Return the exit code of the benchmark.
+    */
+    int exitCode() const { return m_failures > 0 ? 1 : 0; }
+
+public:
+    /**
+    * Format time given in microseconds as milliseconds.
+    */
+    static QString formatTime( qint64 microseconds );
+
+private:
+    void writeLine( const QString& name, const QString& value );
+
+private:
+    QTextStream m_stream;
+
+    int m_failures;
+};
+
+#endif
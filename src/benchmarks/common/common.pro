@@ -0,0 +1,63 @@
+include( ../../../config.pri )
+
+TEMPLATE = lib
+TARGET   = common
+
+CONFIG  += qt staticlib
+QT      += widgets printsupport network xml sql webkit webkitwidgets
+
+# the sources of the application are compiled once and linked into all benchmarks
+SOURCE_DIR = $$PWD/../..
+
+VPATH       += $$SOURCE_DIR
+INCLUDEPATH += $$SOURCE_DIR
+
+HEADERS += $$SOURCE_DIR/application.h \
+           $$SOURCE_DIR/mainwindow.h
+
+SOURCES += $$SOURCE_DIR/application.cpp \
+           $$SOURCE_DIR/mainwindow.cpp
+
+RESOURCES += \
+           $$SOURCE_DIR/icons/icons.qrc \
+           $$SOURCE_DIR/resources/resources.qrc
+
+include( $$SOURCE_DIR/commands/commands.pri )
+include( $$SOURCE_DIR/data/data.pri )
+include( $$SOURCE_DIR/dialogs/dialogs.pri )
+include( $$SOURCE_DIR/models/models.pri )
+include( $$SOURCE_DIR/sqlite/sqlite.pri )
+include( $$SOURCE_DIR/utils/utils.pri )
+include( $$SOURCE_DIR/views/views.pri )
+include( $$SOURCE_DIR/widgets/widgets.pri )
+include( $$SOURCE_DIR/xmlui/xmlui.pri )
+
+HEADERS += benchmarkenvironment.h \
+           benchmarkreport.h \
+           replaymanager.h \
+           replysource.h \
+           stubserver.h \
+           syntheticserver.h
+
+SOURCES += benchmarkenvironment.cpp \
+           benchmarkreport.cpp \
+           replaymanager.cpp \
+           replysource.cpp \
+           stubserver.cpp \
+           syntheticserver.cpp
+
+PRECOMPILED_HEADER = $$SOURCE_DIR/precompiled.h
+PRECOMPILED_SOURCE = $$SOURCE_DIR/precompiled.cpp
+
+win32-msvc* {
+    QMAKE_CXXFLAGS += -Fd\$(IntDir)
+    CONFIG -= flat
+}
+
+!win32 | build_pass {
+    CONFIG( debug, debug|release ) {
+        DESTDIR = ../debug
+    } else {
+        DESTDIR = ../release
+    }
+}
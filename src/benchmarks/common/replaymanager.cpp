@@ -0,0 +1,132 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "replaymanager.h"
+
+#include "application.h"
+
+#include <QTimer>
+
+#include <cstring>
+
+ReplayManager::ReplayManager( ReplySource* source, QObject* parent ) : QNetworkAccessManager( parent ),
+    m_source( source ),
+    m_requestsCount( 0 ),
+    m_responsesSize( 0 )
+{
+}
+
+ReplayManager::~ReplayManager()
+{
+}
+
+QNetworkReply* ReplayManager::createRequest( Operation operation, const QNetworkRequest& request, QIODevice* outgoingData )
+{
+    QString command;
+    QByteArray attachment;
+
+    ServerResponse response;
+
+    QByteArray body = outgoingData ? outgoingData->readAll() : QByteArray();
+
+    if ( operation == PostOperation && ReplySource::parseRequest( request.header( QNetworkRequest::ContentTypeHeader ).toByteArray(), body, command, attachment ) )
+        response = m_source->response( command, attachment );
+    else
+        response = ServerResponse( "ERROR 400 'Syntax error'" );
+
+    m_requestsCount++;
+    m_responsesSize += response.m_body.size();
+
+    return new ReplayReply( request, response, this );
+}
+
+ReplayReply::ReplayReply( const QNetworkRequest& request, const ServerResponse& response, QObject* parent ) : QNetworkReply( parent ),
+    m_response( response ),
+    m_offset( 0 )
+{
+    setRequest( request );
+    setUrl( request.url() );
+    setOperation( QNetworkAccessManager::PostOperation );
+
+    open( QIODevice::ReadOnly | QIODevice::Unbuffered );
+
+    // signals are emitted when the control returns to the event loop, like for a real reply
+    QTimer::singleShot( 0, this, SLOT( deliver() ) );
+}
+
+ReplayReply::~ReplayReply()
+{
+}
+
+void ReplayReply::abort()
+{
+    if ( isFinished() )
+        return;
+
+    m_offset = m_response.m_body.size();
+
+    setError( OperationCanceledError, "Operation canceled" );
+    setFinished( true );
+
+    emit error( OperationCanceledError );
+    emit finished();
+}
+
+qint64 ReplayReply::bytesAvailable() const
+{
+    return m_response.m_body.size() - m_offset + QNetworkReply::bytesAvailable();
+}
+
+bool ReplayReply::isSequential() const
+{
+    return true;
+}
+
+qint64 ReplayReply::readData( char* data, qint64 maxSize )
+{
+    if ( m_offset >= m_response.m_body.size() )
+        return isFinished() ? -1 : 0;
+
+    qint64 length = qMin( maxSize, m_response.m_body.size() - m_offset );
+    memcpy( data, m_response.m_body.constData() + m_offset, length );
+    m_offset += length;
+
+    return length;
+}
+
+void ReplayReply::deliver()
+{
+    if ( isFinished() )
+        return;
+
+    setAttribute( QNetworkRequest::HttpStatusCodeAttribute, 200 );
+    setHeader( QNetworkRequest::ContentTypeHeader, m_response.m_contentType );
+    setHeader( QNetworkRequest::ContentLengthHeader, m_response.m_body.size() );
+    setRawHeader( "X-WebIssues-Version", application->protocolVersion().toLatin1() );
+
+    emit metaDataChanged();
+
+    emit downloadProgress( m_response.m_body.size(), m_response.m_body.size() );
+
+    emit readyRead();
+
+    setFinished( true );
+
+    emit finished();
+}
@@ -0,0 +1,112 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef REPLAYMANAGER_H
+#define REPLAYMANAGER_H
+
+#include "replysource.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+/**
+* Network access manager answering requests without network access.
+*
+* Commands sent by the CommandManager are passed to the ReplySource and
+* its responses are returned as HTTP replies of a WebIssues server. This
+* way the whole client pipeline, including parsing and validating replies
+* and storing data in the cache, runs without a server.
+*/
+class ReplayManager : public QNetworkAccessManager
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param source The source of responses.
+    * @param parent The parent object.
+    */
+    ReplayManager( ReplySource* source, QObject* parent = NULL );
+
+    /**
+    * Destructor.
+    */
+    ~ReplayManager();
+
+public:
+    /**
+    * Return the number of answered requests.
+    */
+    int requestsCount() const { return m_requestsCount; }
+
+    /**
+    * Return the total size of responses in bytes.
+    */
+    qint64 responsesSize() const { return m_responsesSize; }
+
+protected: // overrides
+    QNetworkReply* createRequest( Operation operation, const QNetworkRequest& request, QIODevice* outgoingData );
+
+private:
+    ReplySource* m_source;
+
+    int m_requestsCount;
+    qint64 m_responsesSize;
+};
+
+/**
+* Network reply with contents provided by the ReplayManager.
+*/
+class ReplayReply : public QNetworkReply
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param request The request which is answered.
+    * @param response The response to the request.
+    * @param parent The parent object.
+    */
+    ReplayReply( const QNetworkRequest& request, const ServerResponse& response, QObject* parent );
+
+    /**
+    * Destructor.
+    */
+    ~ReplayReply();
+
+public: // overrides
+    void abort();
+
+    qint64 bytesAvailable() const;
+
+    bool isSequential() const;
+
+protected: // overrides
+    qint64 readData( char* data, qint64 maxSize );
+
+private slots:
+    void deliver();
+
+private:
+    ServerResponse m_response;
+
+    qint64 m_offset;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "replysource.h"
+
+bool ReplySource::parseRequest( const QByteArray& contentType, const QByteArray& body, QString& command, QByteArray& attachment )
+{
+    int pos = contentType.indexOf( "boundary=" );
+    if ( pos < 0 )
+        return false;
+
+    QByteArray delimiter = "--" + contentType.mid( pos + 9 ).trimmed();
+
+    pos = body.indexOf( delimiter );
+
+    while ( pos >= 0 ) {
+        pos += delimiter.length();
+
+        // the last delimiter is followed by two dashes
+        if ( body.mid( pos, 2 ) == "--" )
+            return !command.isEmpty();
+
+        pos += 2;
+
+        int end = body.indexOf( "\r\n" + delimiter, pos );
+        int headersEnd = body.indexOf( "\r\n\r\n", pos );
+        if ( end < 0 || headersEnd < 0 || headersEnd > end )
+            return false;
+
+        QByteArray headers = body.mid( pos, headersEnd - pos );
+        QByteArray content = body.mid( headersEnd + 4, end - headersEnd - 4 );
+
+        if ( headers.contains( "name=\"command\"" ) )
+            command = QString::fromUtf8( content );
+        else if ( headers.contains( "name=\"file\"" ) )
+            attachment = content;
+
+        pos = end + 2;
+    }
+
+    return false;
+}
+
+bool ReplySource::parseCommand( const QString& command, QString& keyword, QVariantList& args )
+{
+    int length = command.length();
+    int pos = 0;
+
+    // the keyword consists of one or more words in upper case
+    while ( pos < length && command.at( pos ) >= QLatin1Char( 'A' ) && command.at( pos ) <= QLatin1Char( 'Z' ) ) {
+        int start = pos;
+        while ( pos < length && command.at( pos ) >= QLatin1Char( 'A' ) && command.at( pos ) <= QLatin1Char( 'Z' ) )
+            pos++;
+
+        if ( !keyword.isEmpty() )
+            keyword += QLatin1Char( ' ' );
+        keyword += command.mid( start, pos - start );
+
+        if ( pos < length ) {
+            if ( command.at( pos ) != QLatin1Char( ' ' ) )
+                return false;
+            pos++;
+        }
+    }
+
+    if ( keyword.isEmpty() )
+        return false;
+
+    while ( pos < length ) {
+        if ( command.at( pos ) == QLatin1Char( '\'' ) ) {
+            QString string;
+            pos++;
+            while ( pos < length && command.at( pos ) != QLatin1Char( '\'' ) ) {
+                QChar ch = command.at( pos++ );
+                if ( ch == QLatin1Char( '\\' ) && pos < length ) {
+                    ch = command.at( pos++ );
+                    if ( ch == QLatin1Char( 'n' ) )
+                        ch = QLatin1Char( '\n' );
+                    else if ( ch == QLatin1Char( 't' ) )
+                        ch = QLatin1Char( '\t' );
+                }
+                string += ch;
+            }
+            if ( pos >= length )
+                return false;
+            pos++;
+            args.append( string );
+        } else {
+            int start = pos;
+            while ( pos < length && command.at( pos ) != QLatin1Char( ' ' ) )
+                pos++;
+            bool ok;
+            int number = command.mid( start, pos - start ).toInt( &ok );
+            if ( !ok )
+                return false;
+            args.append( number );
+        }
+
+        if ( pos < length ) {
+            if ( command.at( pos ) != QLatin1Char( ' ' ) )
+                return false;
+            pos++;
+        }
+    }
+
+    return true;
+}
+
+QString ReplySource::quoteString( const QString& string )
+{
+    QString result = "\'";
+    int length = string.length();
+    for ( int i = 0; i < length; i++ ) {
+        QChar ch = string[ i ];
+        if ( ch == QLatin1Char( '\\' ) || ch == QLatin1Char( '\'' ) || ch == QLatin1Char( '\n' ) || ch == QLatin1Char( '\t' ) ) {
+            result += QLatin1Char( '\\' );
+            if ( ch == QLatin1Char( '\n' ) )
+                ch = QLatin1Char( 'n' );
+            else if ( ch == QLatin1Char( '\t' ) )
+                ch = QLatin1Char( 't' );
+        }
+        result += ch;
+    }
+    result += QLatin1Char( '\'' );
+    return result;
+}
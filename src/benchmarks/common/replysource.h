@@ -0,0 +1,105 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef REPLYSOURCE_H
+#define REPLYSOURCE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVariant>
+
+/**
+* Response of a simulated WebIssues server.
+*/
+class ServerResponse
+{
+public:
+    /**
+    * Constructor.
+    * @param body The body of the response.
+    * @param contentType The MIME type of the response.
+    */
+    ServerResponse( const QByteArray& body = QByteArray(), const QByteArray& contentType = "text/plain" ) :
+        m_body( body ),
+        m_contentType( contentType )
+    {
+    }
+
+public:
+    /**
+    * The body of the response.
+    */
+    QByteArray m_body;
+
+    /**
+    * The MIME type of the response.
+    */
+    QByteArray m_contentType;
+};
+
+/**
+* Source of responses to commands sent to a simulated server.
+*
+* The source is used by the ReplayManager, which passes the responses
+* directly to the CommandManager, and by the StubServer, which sends
+* them over HTTP.
+*/
+class ReplySource
+{
+public:
+    /**
+    * Destructor.
+    */
+    virtual ~ReplySource() { }
+
+public:
+    /**
+    * Return the response to a command.
+    * @param command The command line, for example <tt>GET DETAILS 1 0 1</tt>.
+    * @param attachment The contents of the attached file, if any.
+    */
+    virtual ServerResponse response( const QString& command, const QByteArray& attachment ) = 0;
+
+public:
+    /**
+    * Extract the command and the attachment from a request.
+    * @param contentType The content type of the request including the boundary.
+    * @param body The <tt>multipart/form-data</tt> body of the request.
+    * @param command Returns the command line.
+    * @param attachment Returns the contents of the attached file.
+    * @return @c true if the request is valid.
+    */
+    static bool parseRequest( const QByteArray& contentType, const QByteArray& body, QString& command, QByteArray& attachment );
+
+    /**
+    * Split a command line into the keyword and arguments.
+    * @param command The command line.
+    * @param keyword Returns the keyword of the command.
+    * @param args Returns the integer and string arguments.
+    * @return @c true if the command is valid.
+    */
+    static bool parseCommand( const QString& command, QString& keyword, QVariantList& args );
+
+    /**
+    * Quote a string argument of a reply line.
+    */
+    static QString quoteString( const QString& string );
+};
+
+#endif
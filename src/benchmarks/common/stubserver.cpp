@@ -0,0 +1,183 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "stubserver.h"
+
+#include "application.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+
+StubServer::StubServer( ReplySource* source, QObject* parent ) : QTcpServer( parent ),
+    m_source( source ),
+    m_latency( 0 ),
+    m_bandwidth( 0 ),
+    m_requestsCount( 0 ),
+    m_responsesSize( 0 )
+{
+}
+
+StubServer::~StubServer()
+{
+}
+
+bool StubServer::start()
+{
+    return listen( QHostAddress::LocalHost, 0 );
+}
+
+QUrl StubServer::url() const
+{
+    return QUrl( QString( "http://127.0.0.1:%1/" ).arg( serverPort() ) );
+}
+
+void StubServer::setLatency( int latency )
+{
+    m_latency = latency;
+}
+
+void StubServer::setBandwidth( int bandwidth )
+{
+    m_bandwidth = bandwidth;
+}
+
+void StubServer::incomingConnection( qintptr handle )
+{
+    new StubConnection( this, handle );
+}
+
+QByteArray StubServer::response( const QByteArray& contentType, const QByteArray& body )
+{
+    QString command;
+    QByteArray attachment;
+
+    ServerResponse response;
+
+    if ( ReplySource::parseRequest( contentType, body, command, attachment ) )
+        response = m_source->response( command, attachment );
+    else
+        response = ServerResponse( "ERROR 400 'Syntax error'\r\n" );
+
+    m_requestsCount++;
+    m_responsesSize += response.m_body.size();
+
+    QByteArray result = "HTTP/1.1 200 OK\r\n";
+    result += "Content-Type: " + response.m_contentType + "\r\n";
+    result += "Content-Length: " + QByteArray::number( response.m_body.size() ) + "\r\n";
+    result += "X-WebIssues-Version: " + application->protocolVersion().toLatin1() + "\r\n";
+    result += "\r\n";
+    result += response.m_body;
+
+    return result;
+}
+
+StubConnection::StubConnection( StubServer* server, qintptr handle ) : QObject( server ),
+    m_server( server ),
+    m_headersLength( -1 ),
+    m_contentLength( 0 ),
+    m_offset( 0 )
+{
+    m_socket = new QTcpSocket( this );
+    m_socket->setSocketDescriptor( handle );
+
+    m_timer = new QTimer( this );
+    m_timer->setSingleShot( true );
+
+    connect( m_socket, SIGNAL( readyRead() ), this, SLOT( readRequest() ) );
+    connect( m_socket, SIGNAL( disconnected() ), this, SLOT( deleteLater() ) );
+    connect( m_timer, SIGNAL( timeout() ), this, SLOT( writeResponse() ) );
+}
+
+StubConnection::~StubConnection()
+{
+}
+
+void StubConnection::readRequest()
+{
+    m_request += m_socket->readAll();
+
+    // the next request is handled when the current response is sent
+    if ( !m_response.isEmpty() )
+        return;
+
+    if ( m_headersLength < 0 && !parseHeaders() )
+        return;
+
+    if ( m_request.size() < m_headersLength + m_contentLength )
+        return;
+
+    QByteArray body = m_request.mid( m_headersLength, m_contentLength );
+    m_request.remove( 0, m_headersLength + m_contentLength );
+    m_headersLength = -1;
+
+    m_response = m_server->response( m_contentType, body );
+    m_offset = 0;
+
+    m_timer->start( m_server->latency() );
+}
+
+bool StubConnection::parseHeaders()
+{
+    int end = m_request.indexOf( "\r\n\r\n" );
+    if ( end < 0 )
+        return false;
+
+    m_headersLength = end + 4;
+    m_contentLength = 0;
+    m_contentType.clear();
+
+    // the first line contains the method and the path, which are ignored
+    QList<QByteArray> lines = m_request.left( end ).split( '\n' );
+    for ( int i = 1; i < lines.count(); i++ ) {
+        const QByteArray& line = lines.at( i );
+        int pos = line.indexOf( ':' );
+        if ( pos < 0 )
+            continue;
+
+        QByteArray name = line.left( pos ).trimmed().toLower();
+        if ( name == "content-length" )
+            m_contentLength = line.mid( pos + 1 ).trimmed().toInt();
+        else if ( name == "content-type" )
+            m_contentType = line.mid( pos + 1 ).trimmed();
+    }
+
+    return true;
+}
+
+void StubConnection::writeResponse()
+{
+    int length = m_response.size() - m_offset;
+
+    if ( m_server->bandwidth() > 0 )
+        length = qMin( length, (int)qMax( (qint64)m_server->bandwidth() * SendInterval / 1000, (qint64)1 ) );
+
+    m_socket->write( m_response.constData() + m_offset, length );
+    m_offset += length;
+
+    if ( m_offset < m_response.size() ) {
+        m_timer->start( SendInterval );
+        return;
+    }
+
+    m_response.clear();
+    m_offset = 0;
+
+    // the client may have sent another request in the meantime
+    readRequest();
+}
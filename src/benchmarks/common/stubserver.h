@@ -0,0 +1,163 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef STUBSERVER_H
+#define STUBSERVER_H
+
+#include "replysource.h"
+
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+class QTimer;
+
+/**
+* Local HTTP server simulating a WebIssues server.
+*
+* Commands sent by the client are passed to the ReplySource and its
+* responses are sent back over a TCP connection. The latency and the
+* bandwidth of the connection can be limited to simulate a remote
+* server.
+*/
+class StubServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param source The source of responses.
+    * @param parent The parent object.
+    */
+    StubServer( ReplySource* source, QObject* parent = NULL );
+
+    /**
+    * Destructor.
+    */
+    ~StubServer();
+
+public:
+    /**
+    * Start listening on a random port of the local host.
+    * @return @c true if the server was started successfully.
+    */
+    bool start();
+
+    /**
+    * Return the URL of the server.
+    */
+    QUrl url() const;
+
+    /**
+    * Set the delay in milliseconds before each response is sent.
+    */
+    void setLatency( int latency );
+
+    /**
+    * Return the delay in milliseconds before each response is sent.
+    */
+    int latency() const { return m_latency; }
+
+    /**
+    * Set the maximum speed of sending responses in bytes per second.
+    * The default value 0 means that the speed is not limited.
+    */
+    void setBandwidth( int bandwidth );
+
+    /**
+    * Return the maximum speed of sending responses in bytes per second.
+    */
+    int bandwidth() const { return m_bandwidth; }
+
+    /**
+    * Return the number of answered requests.
+    */
+    int requestsCount() const { return m_requestsCount; }
+
+    /**
+    * Return the total size of responses in bytes.
+    */
+    qint64 responsesSize() const { return m_responsesSize; }
+
+protected: // overrides
+    void incomingConnection( qintptr handle );
+
+private:
+    QByteArray response( const QByteArray& contentType, const QByteArray& body );
+
+private:
+    friend class StubConnection;
+
+    ReplySource* m_source;
+
+    int m_latency;
+    int m_bandwidth;
+
+    int m_requestsCount;
+    qint64 m_responsesSize;
+};
+
+/**
+* Connection of a client to the StubServer.
+*/
+class StubConnection : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param server The server which accepted the connection.
+    * @param handle The descriptor of the socket.
+    */
+    StubConnection( StubServer* server, qintptr handle );
+
+    /**
+    * Destructor.
+    */
+    ~StubConnection();
+
+private slots:
+    void readRequest();
+    void writeResponse();
+
+private:
+    bool parseHeaders();
+
+private:
+    /**
+    * The interval of sending parts of a response when the bandwidth is limited.
+    */
+    static const int SendInterval = 10;
+
+private:
+    StubServer* m_server;
+
+    QTcpSocket* m_socket;
+    QTimer* m_timer;
+
+    QByteArray m_request;
+    int m_headersLength;
+    int m_contentLength;
+    QByteArray m_contentType;
+
+    QByteArray m_response;
+    int m_offset;
+};
+
+#endif
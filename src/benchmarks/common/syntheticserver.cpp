@@ -0,0 +1,760 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "syntheticserver.h"
+
+#include "data/datamanager.h"
+#include "utils/errorhelper.h"
+
+#include <QDate>
+#include <QCryptographicHash>
+
+#include <algorithm>
+
+// 2017-01-01 00:00 UTC; each change is one minute later than the previous one
+static const int BaseTime = 1483228800;
+
+SyntheticServer::SyntheticServer() :
+    m_usersCount( 50 ),
+    m_attributesCount( 10 ),
+    m_projectsCount( 1 ),
+    m_foldersCount( 1 ),
+    m_issuesCount( 100 ),
+    m_changesCount( 10 ),
+    m_attachmentSize( 16384 ),
+    m_prepared( false ),
+    m_lastChangeId( 0 )
+{
+}
+
+SyntheticServer::~SyntheticServer()
+{
+}
+
+void SyntheticServer::setUsersCount( int count )
+{
+    m_usersCount = qMax( count, 1 );
+    m_prepared = false;
+}
+
+void SyntheticServer::setAttributesCount( int count )
+{
+    m_attributesCount = qMax( count, 1 );
+    m_prepared = false;
+}
+
+void SyntheticServer::setProjectsCount( int count )
+{
+    m_projectsCount = qMax( count, 1 );
+    m_prepared = false;
+}
+
+void SyntheticServer::setFoldersCount( int count )
+{
+    m_foldersCount = qMax( count, 1 );
+    m_prepared = false;
+}
+
+void SyntheticServer::setIssuesCount( int count )
+{
+    m_issuesCount = qMax( count, 1 );
+    m_prepared = false;
+}
+
+void SyntheticServer::setChangesCount( int count )
+{
+    m_changesCount = qMax( count, 1 );
+    m_prepared = false;
+}
+
+void SyntheticServer::setIssueChangesCount( int issueId, int count )
+{
+    m_issueChangesCount.insert( issueId, qMax( count, 1 ) );
+    m_prepared = false;
+}
+
+void SyntheticServer::setAttachmentSize( int size )
+{
+    m_attachmentSize = qMax( size, 0 );
+}
+
+QList<int> SyntheticServer::projects() const
+{
+    QList<int> result;
+    for ( int i = 1; i <= m_projectsCount; i++ )
+        result.append( i );
+    return result;
+}
+
+QList<int> SyntheticServer::folders() const
+{
+    QList<int> result;
+    for ( int i = 1; i <= m_projectsCount * m_foldersCount; i++ )
+        result.append( i );
+    return result;
+}
+
+QList<int> SyntheticServer::issues( int folderId ) const
+{
+    QList<int> result;
+    for ( int i = 1; i <= m_issuesCount; i++ )
+        result.append( ( folderId - 1 ) * m_issuesCount + i );
+    return result;
+}
+
+int SyntheticServer::issuesCount() const
+{
+    return m_projectsCount * m_foldersCount * m_issuesCount;
+}
+
+QList<int> SyntheticServer::attachments( int issueId )
+{
+    prepare();
+
+    QList<int> result;
+
+    for ( int id = firstChange( issueId ); id <= lastChange( issueId ); id++ ) {
+        Change item = change( issueId, id );
+        if ( item.m_id == id && item.m_type == FileAdded )
+            result.append( id );
+    }
+
+    return result;
+}
+
+int SyntheticServer::addComment( int issueId, const QString& text, int format )
+{
+    prepare();
+
+    Change change;
+    change.m_id = ++m_lastChangeId;
+    change.m_type = CommentAdded;
+    change.m_userId = 1;
+    change.m_text = text;
+    change.m_format = format;
+
+    m_addedChanges[ issueId ].append( change );
+
+    return change.m_id;
+}
+
+int SyntheticServer::addAttachment( int issueId, const QString& name, const QString& description, const QByteArray& data )
+{
+    prepare();
+
+    Change change;
+    change.m_id = ++m_lastChangeId;
+    change.m_type = FileAdded;
+    change.m_userId = 1;
+    change.m_name = name;
+    change.m_description = description;
+    change.m_size = data.size();
+
+    m_addedChanges[ issueId ].append( change );
+    m_addedFiles.insert( change.m_id, data );
+
+    return change.m_id;
+}
+
+int SyntheticServer::addView( const QString& name, const QString& definition )
+{
+    m_viewNames.append( name );
+    m_viewDefinitions.append( definition );
+
+    return m_viewNames.count();
+}
+
+QString SyntheticServer::commentText( int seed )
+{
+    QString text;
+
+    switch ( seed % 6 ) {
+        case 0:
+            text = QString( "The problem still occurs in version 1.%1, see #%2 for details." ).arg( seed % 10 ).arg( seed / 3 + 1 );
+            break;
+        case 1:
+            text = QString( "Steps to reproduce:\n* open the **project settings**\n* change the __folder name__\n* press `Ctrl+S`\n\nExpected result is described on http://www.example.com/issues/%1." ).arg( seed );
+            break;
+        case 2:
+            text = QString( "[code c++]\nint main( int argc, char** argv )\n{\n    for ( int i = 0; i < %1; i++ )\n        process( argv[ i % argc ] );\n    return 0;\n}\n[/code]\nThe loop above crashes." ).arg( seed % 100 );
+            break;
+        case 3:
+            text = QString( "[quote Reporter]\nIt is still not working.\n[quote]\nDid you try the latest build?\n[/quote]\n[/quote]\nYes, build %1 has the same problem. Contact me at user%2@example.com." ).arg( seed ).arg( seed % 50 );
+            break;
+        case 4:
+            text = QString::fromUtf8( "Zażółć gęślą jaźń \xe2\x80\x93 \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e \xd0\xbf\xd1\x80\xd0\xb8\xd0\xbc\xd0\xb5\xd1\x80 %1." ).arg( seed );
+            break;
+        default:
+            text = QString( "Fixed in revision %1." ).arg( seed );
+            break;
+    }
+
+    // every seventh comment is much longer than the others
+    if ( seed % 7 == 0 ) {
+        QString paragraph = text;
+        for ( int i = 0; i < 10; i++ )
+            text += "\n\n" + paragraph;
+    }
+
+    return text;
+}
+
+ServerResponse SyntheticServer::response( const QString& command, const QByteArray& attachment )
+{
+    prepare();
+
+    QString keyword;
+    QVariantList args;
+
+    if ( !ReplySource::parseCommand( command, keyword, args ) )
+        return ServerResponse( error( 400, "Syntax error" ).toUtf8() );
+
+    if ( keyword == QLatin1String( "GET ATTACHMENT" ) && args.count() == 1 ) {
+        int fileId = args.at( 0 ).toInt();
+        QByteArray data = attachmentData( fileId );
+        if ( data.isNull() )
+            return ServerResponse( error( ErrorHelper::UnknownFile, "Unknown file" ).toUtf8() );
+        return ServerResponse( data, "application/octet-stream" );
+    }
+
+    QString reply;
+
+    if ( keyword == QLatin1String( "HELLO" ) )
+        reply = hello();
+    else if ( keyword == QLatin1String( "LOGIN" ) && args.count() == 2 )
+        reply = login( args );
+    else if ( keyword == QLatin1String( "GET SETTINGS" ) )
+        reply = settings();
+    else if ( keyword == QLatin1String( "LIST USERS" ) )
+        reply = users();
+    else if ( keyword == QLatin1String( "LIST TYPES" ) )
+        reply = types();
+    else if ( keyword == QLatin1String( "LIST PROJECTS" ) )
+        reply = projectsList();
+    else if ( keyword == QLatin1String( "LIST STATES" ) && args.count() == 1 )
+        reply = states( args );
+    else if ( keyword == QLatin1String( "GET SUMMARY" ) && args.count() == 2 )
+        reply = summary( args );
+    else if ( keyword == QLatin1String( "LIST ISSUES" ) && args.count() == 2 )
+        reply = issuesList( args );
+    else if ( keyword == QLatin1String( "GET DETAILS" ) && args.count() == 3 )
+        reply = details( args );
+    else if ( keyword == QLatin1String( "ADD COMMENT" ) && args.count() == 3 )
+        reply = addCommentCommand( args );
+    else if ( keyword == QLatin1String( "ADD ATTACHMENT" ) && args.count() == 3 )
+        reply = addAttachmentCommand( args, attachment );
+    else if ( keyword == QLatin1String( "GET ATTACHMENT HASH" ) && args.count() == 1 )
+        reply = attachmentHash( args );
+    else
+        reply = error( 400, "Syntax error" );
+
+    return ServerResponse( reply.toUtf8() );
+}
+
+void SyntheticServer::prepare()
+{
+    if ( m_prepared )
+        return;
+
+    int count = issuesCount();
+
+    m_firstChanges.resize( count );
+
+    int changeId = 1;
+    for ( int i = 0; i < count; i++ ) {
+        m_firstChanges[ i ] = changeId;
+        changeId += m_issueChangesCount.value( i + 1, m_changesCount );
+    }
+
+    m_lastChangeId = changeId - 1;
+
+    m_addedChanges.clear();
+    m_addedFiles.clear();
+
+    m_prepared = true;
+}
+
+int SyntheticServer::folderProject( int folderId ) const
+{
+    return ( folderId - 1 ) / m_foldersCount + 1;
+}
+
+int SyntheticServer::issueFolder( int issueId ) const
+{
+    return ( issueId - 1 ) / m_issuesCount + 1;
+}
+
+int SyntheticServer::firstChange( int issueId ) const
+{
+    return m_firstChanges.at( issueId - 1 );
+}
+
+int SyntheticServer::lastChange( int issueId ) const
+{
+    QHash<int, QList<Change> >::const_iterator it = m_addedChanges.find( issueId );
+    if ( it != m_addedChanges.end() )
+        return it.value().last().m_id;
+
+    return firstChange( issueId ) + m_issueChangesCount.value( issueId, m_changesCount ) - 1;
+}
+
+int SyntheticServer::changeIssue( int changeId ) const
+{
+    QHash<int, QList<Change> >::const_iterator it;
+    for ( it = m_addedChanges.begin(); it != m_addedChanges.end(); ++it ) {
+        foreach ( const Change& change, it.value() ) {
+            if ( change.m_id == changeId )
+                return it.key();
+        }
+    }
+
+    if ( changeId < 1 || changeId > m_lastChangeId )
+        return 0;
+
+    // the first change of the issue is the last one which is not greater than the given change
+    int issueId = std::upper_bound( m_firstChanges.begin(), m_firstChanges.end(), changeId ) - m_firstChanges.begin();
+
+    if ( issueId < 1 || changeId >= firstChange( issueId ) + m_issueChangesCount.value( issueId, m_changesCount ) )
+        return 0;
+
+    return issueId;
+}
+
+int SyntheticServer::folderStamp( int folderId ) const
+{
+    int stampId = 0;
+
+    foreach ( int issueId, issues( folderId ) )
+        stampId = qMax( stampId, lastChange( issueId ) );
+
+    return stampId;
+}
+
+int SyntheticServer::changeTime( int changeId ) const
+{
+    return BaseTime + changeId * 60;
+}
+
+int SyntheticServer::changeUser( int changeId ) const
+{
+    return changeId % m_usersCount + 1;
+}
+
+QString SyntheticServer::userName( int userId ) const
+{
+    if ( userId == 1 )
+        return "Administrator";
+    return QString( "User %1" ).arg( userId );
+}
+
+QString SyntheticServer::issueName( int issueId ) const
+{
+    static const char* const subjects[] = { "Crash when", "Wrong layout after", "Slow response during", "Missing translation in", "Improve" };
+    static const char* const objects[] = { "saving the project settings", "opening a large report", "printing issue details", "importing attachments", "switching the language" };
+
+    return QString( "%1 %2 (%3)" ).arg( subjects[ issueId % 5 ], objects[ ( issueId / 5 ) % 5 ] ).arg( issueId );
+}
+
+QString SyntheticServer::attributeDefinition( int attributeId ) const
+{
+    switch ( ( attributeId - 1 ) % 8 ) {
+        case 0:
+            return "TEXT";
+        case 1:
+            return "ENUM items={\"Low\",\"Medium\",\"High\",\"Critical\"} default=\"Medium\" required=1";
+        case 2:
+            return "NUMERIC decimal=2 min-value=0";
+        case 3:
+            return "DATETIME";
+        case 4:
+            return "USER members=1";
+        case 5:
+            return "TEXT multi-line=1";
+        case 6:
+            return "ENUM editable=1 multi-select=1 items={\"Windows\",\"Linux\",\"Mac OS X\",\"Android\"}";
+        default:
+            return "DATETIME time=1";
+    }
+}
+
+QString SyntheticServer::attributeValue( int issueId, int attributeId ) const
+{
+    // some values are left empty
+    if ( ( issueId + attributeId ) % 7 == 0 )
+        return QString();
+
+    int seed = issueId * 31 + attributeId * 17;
+
+    switch ( ( attributeId - 1 ) % 8 ) {
+        case 0:
+            return QString( "Value %1" ).arg( seed % 1000 );
+        case 1: {
+            static const char* const items[] = { "Low", "Medium", "High", "Critical" };
+            return items[ seed % 4 ];
+        }
+        case 2:
+            return QString::number( ( seed % 100000 ) / 100.0, 'f', 2 );
+        case 3:
+            return QDate( 2017, 1, 1 ).addDays( seed % 1000 ).toString( "yyyy-MM-dd" );
+        case 4:
+            return userName( seed % m_usersCount + 1 );
+        case 5:
+            return QString( "First line %1\nSecond line" ).arg( seed % 100 );
+        case 6: {
+            static const char* const items[] = { "Windows", "Linux", "Mac OS X", "Android" };
+            return QString( "%1, %2" ).arg( items[ seed % 4 ], items[ ( seed + 1 ) % 4 ] );
+        }
+        default:
+            return QDate( 2017, 1, 1 ).addDays( seed % 1000 ).toString( "yyyy-MM-dd" ) + QString( " %1:%2" ).arg( seed % 24, 2, 10, QLatin1Char( '0' ) ).arg( seed % 60, 2, 10, QLatin1Char( '0' ) );
+    }
+}
+
+SyntheticServer::Change SyntheticServer::change( int issueId, int changeId ) const
+{
+    int first = firstChange( issueId );
+    int count = m_issueChangesCount.value( issueId, m_changesCount );
+
+    if ( changeId >= first + count ) {
+        foreach ( const Change& change, m_addedChanges.value( issueId ) ) {
+            if ( change.m_id == changeId )
+                return change;
+        }
+        return Change();
+    }
+
+    if ( changeId < first )
+        return Change();
+
+    int index = changeId - first + 1;
+
+    Change change;
+    change.m_id = changeId;
+    change.m_userId = changeUser( changeId );
+
+    if ( index == 1 ) {
+        change.m_type = IssueCreated;
+        change.m_newValue = issueName( issueId );
+        return change;
+    }
+
+    switch ( index % 4 ) {
+        case 0:
+            change.m_type = FileAdded;
+            change.m_name = QString( "file-%1.txt" ).arg( changeId );
+            change.m_description = QString( "Log file %1" ).arg( index );
+            change.m_size = m_attachmentSize;
+            break;
+        case 1:
+            change.m_type = ValueChanged;
+            change.m_attributeId = ( index / 4 ) % m_attributesCount + 1;
+            change.m_oldValue = attributeValue( issueId + index, change.m_attributeId );
+            change.m_newValue = attributeValue( issueId + index + 1, change.m_attributeId );
+            break;
+        default:
+            change.m_type = CommentAdded;
+            change.m_text = commentText( changeId );
+            change.m_format = TextWithMarkup;
+            break;
+    }
+
+    return change;
+}
+
+QByteArray SyntheticServer::attachmentData( int fileId ) const
+{
+    if ( m_addedFiles.contains( fileId ) )
+        return m_addedFiles.value( fileId );
+
+    int issueId = changeIssue( fileId );
+    if ( issueId == 0 || change( issueId, fileId ).m_type != FileAdded )
+        return QByteArray();
+
+    QByteArray data( m_attachmentSize, 0 );
+    for ( int i = 0; i < m_attachmentSize; i++ )
+        data[ i ] = (char)( 'a' + ( fileId + i ) % 26 );
+
+    return data;
+}
+
+void SyntheticServer::appendLine( QString& reply, const QString& keyword, const QVariantList& args )
+{
+    reply += keyword;
+
+    foreach ( const QVariant& arg, args ) {
+        reply += QLatin1Char( ' ' );
+        if ( arg.type() == QVariant::String )
+            reply += ReplySource::quoteString( arg.toString() );
+        else
+            reply += QString::number( arg.toInt() );
+    }
+
+    reply += QLatin1String( "\r\n" );
+}
+
+void SyntheticServer::appendIssue( QString& reply, int issueId )
+{
+    int first = firstChange( issueId );
+    int last = lastChange( issueId );
+
+    appendLine( reply, "I", QVariantList() << issueId << issueFolder( issueId ) << issueName( issueId ) << last
+        << changeTime( first ) << changeUser( first ) << changeTime( last ) << changeUser( last ) );
+}
+
+void SyntheticServer::appendValues( QString& reply, int issueId )
+{
+    for ( int i = 1; i <= m_attributesCount; i++ ) {
+        QString value = attributeValue( issueId, i );
+        if ( !value.isEmpty() )
+            appendLine( reply, "V", QVariantList() << i << issueId << value );
+    }
+}
+
+void SyntheticServer::appendProject( QString& reply, int projectId )
+{
+    int stampId = 0;
+    for ( int i = 1; i <= m_foldersCount; i++ )
+        stampId = qMax( stampId, folderStamp( ( projectId - 1 ) * m_foldersCount + i ) );
+
+    appendLine( reply, "P", QVariantList() << projectId << QString( "Project %1" ).arg( projectId ) << stampId << 0 );
+}
+
+void SyntheticServer::appendFolder( QString& reply, int folderId )
+{
+    appendLine( reply, "F", QVariantList() << folderId << folderProject( folderId ) << QString( "Folder %1" ).arg( folderId ) << 1 << folderStamp( folderId ) );
+}
+
+QString SyntheticServer::hello()
+{
+    QString reply;
+    appendLine( reply, "S", QVariantList() << QString( "Synthetic Server" ) << QString( "8b1e4c3a-5f2d-4e6b-9a7c-1d2e3f4a5b6c" ) << QString( "1.1.5" ) );
+    return reply;
+}
+
+QString SyntheticServer::login( const QVariantList& args )
+{
+    if ( args.at( 0 ).toString() != QLatin1String( "admin" ) )
+        return error( ErrorHelper::IncorrectLogin, "Incorrect login or password" );
+
+    QString reply;
+    appendLine( reply, "U", QVariantList() << 1 << userName( 1 ) << (int)AdminAccess );
+    return reply;
+}
+
+QString SyntheticServer::settings()
+{
+    QString reply;
+    appendLine( reply, "S", QVariantList() << QString( "comment_max_length" ) << QString( "10000" ) );
+    appendLine( reply, "S", QVariantList() << QString( "file_max_size" ) << QString( "1048576" ) );
+    appendLine( reply, "S", QVariantList() << QString( "file_hash" ) << QString( "sha1" ) );
+    appendLine( reply, "S", QVariantList() << QString( "history_order" ) << QString( "asc" ) );
+    appendLine( reply, "L", QVariantList() << QString( "en_US" ) << QString( "English (US)" ) );
+    appendLine( reply, "Z", QVariantList() << QString( "UTC" ) << 0 );
+    return reply;
+}
+
+QString SyntheticServer::users()
+{
+    QString reply;
+
+    for ( int i = 1; i <= m_usersCount; i++ )
+        appendLine( reply, "U", QVariantList() << i << QString( "user%1" ).arg( i ) << userName( i ) << (int)( i == 1 ? AdminAccess : NormalAccess ) );
+
+    for ( int i = 1; i <= m_usersCount; i++ ) {
+        for ( int j = 1; j <= m_projectsCount; j++ )
+            appendLine( reply, "M", QVariantList() << i << j << (int)( i == 1 ? AdminAccess : NormalAccess ) );
+    }
+
+    return reply;
+}
+
+QString SyntheticServer::types()
+{
+    QString reply;
+
+    appendLine( reply, "T", QVariantList() << 1 << QString( "Bugs" ) );
+
+    for ( int i = 1; i <= m_attributesCount; i++ )
+        appendLine( reply, "A", QVariantList() << i << 1 << QString( "Attribute %1" ).arg( i ) << attributeDefinition( i ) );
+
+    for ( int i = 0; i < m_viewNames.count(); i++ )
+        appendLine( reply, "V", QVariantList() << i + 1 << 1 << m_viewNames.at( i ) << m_viewDefinitions.at( i ) << 1 );
+
+    return reply;
+}
+
+QString SyntheticServer::projectsList()
+{
+    QString reply;
+
+    foreach ( int projectId, projects() )
+        appendProject( reply, projectId );
+
+    foreach ( int folderId, folders() )
+        appendFolder( reply, folderId );
+
+    return reply;
+}
+
+QString SyntheticServer::states( const QVariantList& args )
+{
+    // all states are reported in the initial list and they never change
+    if ( args.at( 0 ).toInt() != 0 )
+        return "NULL";
+
+    QString reply;
+
+    for ( int i = 1; i <= issuesCount(); i++ )
+        appendLine( reply, "S", QVariantList() << i << i << ( i % 2 == 0 ? lastChange( i ) : 0 ) << 0 );
+
+    return reply;
+}
+
+QString SyntheticServer::summary( const QVariantList& args )
+{
+    int projectId = args.at( 0 ).toInt();
+    int lastStampId = args.at( 1 ).toInt();
+
+    if ( projectId < 1 || projectId > m_projectsCount )
+        return error( ErrorHelper::UnknownProject, "Unknown project" );
+
+    QString reply;
+
+    appendProject( reply, projectId );
+
+    if ( lastStampId == 0 )
+        appendLine( reply, "D", QVariantList() << projectId << commentText( projectId ) << (int)TextWithMarkup << BaseTime << 1 );
+
+    return reply;
+}
+
+QString SyntheticServer::issuesList( const QVariantList& args )
+{
+    int folderId = args.at( 0 ).toInt();
+    int lastStampId = args.at( 1 ).toInt();
+
+    if ( folderId < 1 || folderId > m_projectsCount * m_foldersCount )
+        return error( ErrorHelper::UnknownFolder, "Unknown folder" );
+
+    QString reply;
+
+    appendFolder( reply, folderId );
+
+    QList<int> modified;
+    foreach ( int issueId, issues( folderId ) ) {
+        if ( lastChange( issueId ) > lastStampId )
+            modified.append( issueId );
+    }
+
+    foreach ( int issueId, modified )
+        appendIssue( reply, issueId );
+
+    foreach ( int issueId, modified )
+        appendValues( reply, issueId );
+
+    return reply;
+}
+
+QString SyntheticServer::details( const QVariantList& args )
+{
+    int issueId = args.at( 0 ).toInt();
+    int lastStampId = args.at( 1 ).toInt();
+
+    if ( issueId < 1 || issueId > issuesCount() )
+        return error( ErrorHelper::UnknownIssue, "Unknown issue" );
+
+    QString reply;
+
+    appendIssue( reply, issueId );
+    appendValues( reply, issueId );
+
+    if ( lastStampId == 0 )
+        appendLine( reply, "D", QVariantList() << issueId << commentText( issueId + 3 ) << (int)TextWithMarkup << changeTime( firstChange( issueId ) ) << changeUser( firstChange( issueId ) ) );
+
+    QList<Change> changes;
+
+    for ( int id = qMax( firstChange( issueId ), lastStampId + 1 ); id <= lastChange( issueId ); id++ ) {
+        Change item = change( issueId, id );
+        if ( item.m_id == id )
+            changes.append( item );
+    }
+
+    foreach ( const Change& item, changes ) {
+        int time = changeTime( item.m_id );
+        appendLine( reply, "H", QVariantList() << item.m_id << issueId << item.m_type << item.m_id << time << item.m_userId << time << item.m_userId
+            << item.m_attributeId << item.m_oldValue << item.m_newValue << 0 << 0 );
+    }
+
+    foreach ( const Change& item, changes ) {
+        if ( item.m_type == CommentAdded )
+            appendLine( reply, "C", QVariantList() << item.m_id << item.m_text << item.m_format );
+    }
+
+    foreach ( const Change& item, changes ) {
+        if ( item.m_type == FileAdded )
+            appendLine( reply, "A", QVariantList() << item.m_id << item.m_name << item.m_size << item.m_description );
+    }
+
+    return reply;
+}
+
+QString SyntheticServer::addCommentCommand( const QVariantList& args )
+{
+    int issueId = args.at( 0 ).toInt();
+
+    if ( issueId < 1 || issueId > issuesCount() )
+        return error( ErrorHelper::UnknownIssue, "Unknown issue" );
+
+    int commentId = addComment( issueId, args.at( 1 ).toString(), args.at( 2 ).toInt() );
+
+    QString reply;
+    appendLine( reply, "ID", QVariantList() << commentId );
+    return reply;
+}
+
+QString SyntheticServer::addAttachmentCommand( const QVariantList& args, const QByteArray& attachment )
+{
+    int issueId = args.at( 0 ).toInt();
+
+    if ( issueId < 1 || issueId > issuesCount() )
+        return error( ErrorHelper::UnknownIssue, "Unknown issue" );
+
+    int fileId = addAttachment( issueId, args.at( 1 ).toString(), args.at( 2 ).toString(), attachment );
+
+    QString reply;
+    appendLine( reply, "ID", QVariantList() << fileId );
+    return reply;
+}
+
+QString SyntheticServer::attachmentHash( const QVariantList& args )
+{
+    QByteArray data = attachmentData( args.at( 0 ).toInt() );
+    if ( data.isNull() )
+        return error( ErrorHelper::UnknownFile, "Unknown file" );
+
+    QString reply;
+    appendLine( reply, "H", QVariantList() << QString::fromLatin1( QCryptographicHash::hash( data, QCryptographicHash::Sha1 ).toHex() ) );
+    return reply;
+}
+
+QString SyntheticServer::error( int code, const QString& message )
+{
+    QString reply;
+    appendLine( reply, "ERROR", QVariantList() << code << message );
+    return reply;
+}
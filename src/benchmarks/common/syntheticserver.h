@@ -0,0 +1,240 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef SYNTHETICSERVER_H
+#define SYNTHETICSERVER_H
+
+#include "replysource.h"
+
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+/**
+* Simulated WebIssues server with a generated data set.
+*
+* The server has one issue type with the configured number of attributes
+* of all kinds, the configured number of projects and folders, and issues
+* whose history contains comments, attachments and value changes. The data
+* is generated deterministically from the identifiers, so that every run
+* of a benchmark works with the same data.
+*
+* Comments and attachments added using commands are remembered, and the
+* list of issues and issue details return only the items which were
+* modified since the stamp given in the command.
+*
+* The server reports the <tt>file_hash</tt> setting and supports the
+* <tt>GET ATTACHMENT HASH</tt> command, which returns the SHA-1 hash of
+* the content of an attachment, so that the client can skip downloading
+* files which are already cached.
+*/
+class SyntheticServer : public ReplySource
+{
+public:
+    /**
+    * Constructor.
+    */
+    SyntheticServer();
+
+    /**
+    * Destructor.
+    */
+    ~SyntheticServer();
+
+public:
+    /**
+    * Set the number of users.
+    */
+    void setUsersCount( int count );
+
+    /**
+    * Set the number of attributes of the issue type.
+    */
+    void setAttributesCount( int count );
+
+    /**
+    * Set the number of projects.
+    */
+    void setProjectsCount( int count );
+
+    /**
+    * Set the number of folders in each project.
+    */
+    void setFoldersCount( int count );
+
+    /**
+    * Set the number of issues in each folder.
+    */
+    void setIssuesCount( int count );
+
+    /**
+    * Set the number of changes in the history of each issue.
+    */
+    void setChangesCount( int count );
+
+    /**
+    * Set the number of changes in the history of the given issue.
+    */
+    void setIssueChangesCount( int issueId, int count );
+
+    /**
+    * Set the size of generated attachments in bytes.
+    */
+    void setAttachmentSize( int size );
+
+    /**
+    * Return the identifiers of all projects.
+    */
+    QList<int> projects() const;
+
+    /**
+    * Return the identifiers of all folders.
+    */
+    QList<int> folders() const;
+
+    /**
+    * Return the identifiers of issues in the given folder.
+    */
+    QList<int> issues( int folderId ) const;
+
+    /**
+    * Return the total number of issues.
+    */
+    int issuesCount() const;
+
+    /**
+    * Return the identifiers of attachments of the given issue.
+    */
+    QList<int> attachments( int issueId );
+
+    /**
+    * Add a comment to the history of an issue.
+    * @return The identifier of the comment.
+    */
+    int addComment( int issueId, const QString& text, int format );
+
+    /**
+    * Add an attachment to the history of an issue.
+    * @return The identifier of the attachment.
+    */
+    int addAttachment( int issueId, const QString& name, const QString& description, const QByteArray& data );
+
+    /**
+    * Add a public view of the issue type.
+    * @return The identifier of the view.
+    */
+    int addView( const QString& name, const QString& definition );
+
+    /**
+    * Return generated text with markup.
+    * @param seed Number used to select the kind of formatting and the length of the text.
+    */
+    static QString commentText( int seed );
+
+public: // overrides
+    ServerResponse response( const QString& command, const QByteArray& attachment );
+
+private:
+    struct Change
+    {
+        Change() : m_id( 0 ), m_type( 0 ), m_userId( 0 ), m_attributeId( 0 ), m_format( 0 ), m_size( 0 ) { }
+
+        int m_id;
+        int m_type;
+        int m_userId;
+        int m_attributeId;
+        QString m_oldValue;
+        QString m_newValue;
+        QString m_text;
+        int m_format;
+        QString m_name;
+        QString m_description;
+        int m_size;
+    };
+
+private:
+    void prepare();
+
+    int folderProject( int folderId ) const;
+    int issueFolder( int issueId ) const;
+
+    int firstChange( int issueId ) const;
+    int lastChange( int issueId ) const;
+    int changeIssue( int changeId ) const;
+    int folderStamp( int folderId ) const;
+
+    int changeTime( int changeId ) const;
+    int changeUser( int changeId ) const;
+
+    QString userName( int userId ) const;
+    QString issueName( int issueId ) const;
+
+    QString attributeDefinition( int attributeId ) const;
+    QString attributeValue( int issueId, int attributeId ) const;
+
+    Change change( int issueId, int changeId ) const;
+
+    QByteArray attachmentData( int fileId ) const;
+
+    void appendLine( QString& reply, const QString& keyword, const QVariantList& args );
+
+    void appendIssue( QString& reply, int issueId );
+    void appendValues( QString& reply, int issueId );
+    void appendProject( QString& reply, int projectId );
+    void appendFolder( QString& reply, int folderId );
+
+    QString hello();
+    QString login( const QVariantList& args );
+    QString settings();
+    QString users();
+    QString types();
+    QString projectsList();
+    QString states( const QVariantList& args );
+    QString summary( const QVariantList& args );
+    QString issuesList( const QVariantList& args );
+    QString details( const QVariantList& args );
+    QString addCommentCommand( const QVariantList& args );
+    QString addAttachmentCommand( const QVariantList& args, const QByteArray& attachment );
+    QString attachmentHash( const QVariantList& args );
+
+    QString error( int code, const QString& message );
+
+private:
+    int m_usersCount;
+    int m_attributesCount;
+    int m_projectsCount;
+    int m_foldersCount;
+    int m_issuesCount;
+    int m_changesCount;
+    int m_attachmentSize;
+
+    QHash<int, int> m_issueChangesCount;
+
+    bool m_prepared;
+    QVector<int> m_firstChanges;
+    int m_lastChangeId;
+
+    QHash<int, QList<Change> > m_addedChanges;
+    QHash<int, QByteArray> m_addedFiles;
+
+    QStringList m_viewNames;
+    QStringList m_viewDefinitions;
+};
+
+#endif
@@ -0,0 +1,8 @@
+include( ../benchmarks.pri )
+
+TARGET = definitioninfo
+
+HEADERS += legacydefinitioninfo.h
+
+SOURCES += legacydefinitioninfo.cpp \
+           main.cpp
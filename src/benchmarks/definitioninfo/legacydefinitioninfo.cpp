@@ -0,0 +1,118 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "legacydefinitioninfo.h"
+
+#include <QStringList>
+#include <QCache>
+#include <QRegExp>
+
+LegacyDefinitionInfo::LegacyDefinitionInfo()
+{
+}
+
+LegacyDefinitionInfo::~LegacyDefinitionInfo()
+{
+}
+
+void LegacyDefinitionInfo::setMetadata( const QString& key, const QVariant& value )
+{
+    if ( value.isValid() )
+        m_metadata.insert( key, value );
+    else
+        m_metadata.remove( key );
+}
+
+QVariant LegacyDefinitionInfo::metadata( const QString& key ) const
+{
+    return m_metadata.value( key );
+}
+
+LegacyDefinitionInfo LegacyDefinitionInfo::fromString( const QString& text )
+{
+    if ( text.isEmpty() )
+        return LegacyDefinitionInfo();
+
+    static QCache<QString, LegacyDefinitionInfo> definitionsCache;
+
+    LegacyDefinitionInfo* info = definitionsCache.object( text );
+    if ( info )
+        return *info;
+
+    info = new LegacyDefinitionInfo();
+    definitionsCache.insert( text, info );
+
+    QString patternNumber = "-?\\d+";
+    QString patternString = "\"(?:\\\\[\"\\\\nt]|[^\"\\\\])*\"";
+    QString patternArray = QString( "\\{(?:%1(?:,%2)*)?\\}" ).arg( patternString, patternString );
+    QString patternKey = "[a-z0-9]+(?:-[a-z0-9]+)*";
+    QString patternKeyAndValue = QString( "(%1)=(%2|%3|%4)" ).arg( patternKey, patternNumber, patternString, patternArray );
+
+    QRegExp definitionRegExp( QString( "([A-Z]+)(( %1)*)" ).arg( patternKeyAndValue ) );
+
+    if ( !definitionRegExp.exactMatch( text ) )
+        return *info;
+
+    info->setType( definitionRegExp.cap( 1 ) );
+
+    QString attributes = definitionRegExp.cap( 2 );
+
+    QRegExp metadataRegExp( patternKeyAndValue );
+    QRegExp stringRegExp( patternString );
+
+    int i = 0;
+    while ( ( i = metadataRegExp.indexIn( attributes, i ) ) != -1 ) {
+        QString key = metadataRegExp.cap( 1 );
+        QString value = metadataRegExp.cap( 2 );
+        if ( value[ 0 ] == QLatin1Char( '\"' ) ) {
+            info->setMetadata( key, unquoteString( value ) );
+        } else if ( value[ 0 ] == QLatin1Char( '{' ) ) {
+            QStringList list;
+            int j = 0;
+            while ( ( j = stringRegExp.indexIn( value, j ) ) != -1 ) {
+                list.append( unquoteString( stringRegExp.cap( 0 ) ) );
+                j += stringRegExp.matchedLength();
+            }
+            info->setMetadata( key, list );
+        } else {
+            info->setMetadata( key, value.toInt() );
+        }
+        i += metadataRegExp.matchedLength();
+    }
+
+    return *info;
+}
+
+QString LegacyDefinitionInfo::unquoteString( const QString& string )
+{
+    QString result = "";
+    int length = string.length();
+    for ( int i = 1; i < length - 1; i++ ) {
+        QChar ch = string[ i ];
+        if ( ch == QLatin1Char( '\\' ) ) {
+            ch = string[ ++i ];
+            if ( ch == QLatin1Char( 'n' ) )
+                ch = QLatin1Char( '\n' );
+            else if ( ch == QLatin1Char( 't' ) )
+                ch = QLatin1Char( '\t' );
+        }
+        result += ch;
+    }
+    return result;
+}
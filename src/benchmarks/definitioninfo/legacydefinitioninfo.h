@@ -0,0 +1,90 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef LEGACYDEFINITIONINFO_H
+#define LEGACYDEFINITIONINFO_H
+
+#include <QVariant>
+
+/**
+* Copy of the QRegExp-based implementation of DefinitionInfo.
+*
+* It is used as a reference for comparing the results and performance
+* of the current implementation.
+*/
+class LegacyDefinitionInfo
+{
+public:
+    /**
+    * Default constructor.
+    */
+    LegacyDefinitionInfo();
+
+    /**
+    * Destructor.
+    */
+    ~LegacyDefinitionInfo();
+
+public:
+    /**
+    * Check if the definition is empty.
+    * @return @c true if the definition is empty.
+    */
+    bool isEmpty() const { return m_type.isEmpty(); }
+
+    /**
+    * Set the type.
+    */
+    void setType( const QString& type ) { m_type = type; }
+
+    /**
+    * Return the type.
+    */
+    const QString& type() const { return m_type; }
+
+    /**
+    * Set the metadata of the attribute.
+    */
+    void setMetadata( const QString& key, const QVariant& value );
+
+    /**
+    * Return the metadata of the attribute.
+    */
+    QVariant metadata( const QString& key ) const;
+
+    /**
+    * Return all metadata of the attribute.
+    */
+    const QVariantMap& metadata() const { return m_metadata; }
+
+public:
+    /**
+    * Parse the attribute definition string according to the WebIssues protocol.
+    */
+    static LegacyDefinitionInfo fromString( const QString& text );
+
+private:
+    static QString unquoteString( const QString& string );
+
+private:
+    QString m_type;
+    QVariantMap m_metadata;
+};
+
+#endif
@@ -0,0 +1,208 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "legacydefinitioninfo.h"
+#include "benchmarkreport.h"
+
+#include "utils/definitioninfo.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QStringList>
+
+static QStringList createCorpus()
+{
+    QStringList corpus;
+
+    // attribute definitions
+    corpus.append( "TEXT" );
+    corpus.append( "TEXT required=1" );
+    corpus.append( "TEXT max-length=255 min-length=3 required=1" );
+    corpus.append( "TEXT default=\"\" multi-line=1 max-length=4000" );
+    corpus.append( "TEXT default=\"quoted \\\"value\\\" with \\\\ backslash\"" );
+    corpus.append( "TEXT default=\"line\\nbreak and\\ttab\"" );
+    corpus.append( "ENUM items={\"Low\",\"Medium\",\"High\",\"Critical\"} default=\"Medium\" required=1" );
+    corpus.append( "ENUM editable=1 items={\"Windows\",\"Linux\",\"Mac OS X\",\"Android\",\"iOS\"} multi-select=1" );
+    corpus.append( "ENUM items={} editable=1" );
+    corpus.append( "ENUM items={\"a,b\",\"{c}\",\"\\\"d\\\"\"}" );
+    corpus.append( "NUMERIC decimal=2 min-value=-100 max-value=1000 strip=1" );
+    corpus.append( "NUMERIC decimal=0 default=\"0\"" );
+    corpus.append( "DATETIME time=1 local=1 default=\"[Today]\"" );
+    corpus.append( "DATETIME required=0" );
+    corpus.append( "USER members=1 default=\"[Me]\" multi-select=1" );
+    corpus.append( QString::fromUtf8( "TEXT default=\"Zażółć gęślą jaźń\"" ) );
+
+    // formats
+    corpus.append( "NUMBER decimal-separator=\".\" group-separator=\",\"" );
+    corpus.append( "DATE date-order=\"dmy\" date-separator=\".\" pad-day=1 pad-month=1" );
+    corpus.append( "TIME time-mode=24 time-separator=\":\" pad-hour=1" );
+
+    // views and filters
+    corpus.append( "VIEW columns=\"0,1,2,3,1001,1002,1003\" sort-column=1001 sort-desc=1" );
+    corpus.append( "VIEW columns=\"0,1,5,6\" sort-column=2 filters={\"EQ column=1001 value=\\\"Medium\\\"\",\"GTE column=4 value=\\\"[Today]-7\\\"\"}" );
+    corpus.append( "EQ column=1001 value=\"Medium\"" );
+    corpus.append( "CON column=1 value=\"crash\"" );
+    corpus.append( "IN column=1002 value=\"Windows, Linux\"" );
+
+    // invalid definitions which must result in an empty definition
+    corpus.append( "text required=1" );
+    corpus.append( "TEXT  required=1" );
+    corpus.append( "TEXT required=" );
+    corpus.append( "TEXT Required=1" );
+    corpus.append( "TEXT required=1 " );
+    corpus.append( "TEXT default=\"unterminated" );
+    corpus.append( "TEXT default=\"bad \\x escape\"" );
+    corpus.append( "ENUM items={\"a\",}" );
+    corpus.append( "ENUM items={\"a\"" );
+    corpus.append( "NUMERIC min-value=-" );
+    corpus.append( "NUMERIC min-value=1.5" );
+    corpus.append( "TEXT -key=1" );
+    corpus.append( "TEXT key-=1" );
+
+    return corpus;
+}
+
+static bool compareDefinitions( const QString& text, BenchmarkReport& report )
+{
+    DefinitionInfo info = DefinitionInfo::fromString( text );
+    LegacyDefinitionInfo legacy = LegacyDefinitionInfo::fromString( text );
+
+    if ( info.type() != legacy.type() || info.metadata() != legacy.metadata() ) {
+        report.addFailure( QString( "different result for: %1" ).arg( text ) );
+        return false;
+    }
+
+    if ( info.column() != legacy.metadata( "column" ).toInt() || info.value() != legacy.metadata( "value" ).toString()
+        || info.isLocal() != legacy.metadata( "local" ).toBool() ) {
+        report.addFailure( QString( "different accessor value for: %1" ).arg( text ) );
+        return false;
+    }
+
+    return true;
+}
+
+int main( int argc, char** argv )
+{
+    QCoreApplication application( argc, argv );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Compares the DefinitionInfo parser with the QRegExp-based implementation." );
+    parser.addHelpOption();
+
+    QCommandLineOption uniqueOption( "unique", "Number of distinct definitions which are parsed once.", "count", "20000" );
+    parser.addOption( uniqueOption );
+    QCommandLineOption iterationsOption( "iterations", "Number of passes over cached definitions.", "count", "10000" );
+    parser.addOption( iterationsOption );
+
+    parser.process( application );
+
+    int uniqueCount = parser.value( uniqueOption ).toInt();
+    int iterations = parser.value( iterationsOption ).toInt();
+
+    BenchmarkReport report( "DefinitionInfo benchmark" );
+
+    QStringList corpus = createCorpus();
+
+    report.beginSection( "Correctness" );
+
+    int matching = 0;
+    foreach ( const QString& text, corpus ) {
+        if ( compareDefinitions( text, report ) )
+            matching++;
+    }
+
+    report.addValue( "Identical results", QString( "%1 of %2" ).arg( matching ).arg( corpus.count() ) );
+
+    // each definition is parsed once, so every lookup misses the cache
+    QStringList unique;
+    unique.reserve( uniqueCount );
+    for ( int i = 0; i < uniqueCount; i++ ) {
+        const QString& text = corpus.at( i % corpus.count() );
+        unique.append( QString( "%1 sequence=%2" ).arg( text ).arg( i ) );
+    }
+
+    report.beginSection( QString( "Parsing %1 distinct definitions" ).arg( uniqueCount ) );
+
+    QElapsedTimer timer;
+    int checksum = 0;
+
+    timer.start();
+    foreach ( const QString& text, unique )
+        checksum += LegacyDefinitionInfo::fromString( text ).metadata().count();
+    report.addTime( "QRegExp parser", timer.nsecsElapsed() / 1000, uniqueCount );
+
+    timer.start();
+    foreach ( const QString& text, unique )
+        checksum -= DefinitionInfo::fromString( text ).metadata().count();
+    report.addTime( "Single-pass parser", timer.nsecsElapsed() / 1000, uniqueCount );
+
+    if ( checksum != 0 )
+        report.addFailure( "different number of parsed metadata values" );
+
+    report.beginSection( QString( "Looking up %1 cached definitions" ).arg( iterations * corpus.count() ) );
+
+    timer.start();
+    for ( int i = 0; i < iterations; i++ ) {
+        foreach ( const QString& text, corpus )
+            checksum += LegacyDefinitionInfo::fromString( text ).metadata().count();
+    }
+    report.addTime( "QRegExp parser", timer.nsecsElapsed() / 1000, iterations * corpus.count() );
+
+    timer.start();
+    for ( int i = 0; i < iterations; i++ ) {
+        foreach ( const QString& text, corpus )
+            checksum -= DefinitionInfo::fromString( text ).metadata().count();
+    }
+    report.addTime( "Single-pass parser", timer.nsecsElapsed() / 1000, iterations * corpus.count() );
+
+    if ( checksum != 0 )
+        report.addFailure( "different number of cached metadata values" );
+
+    report.beginSection( QString( "Reading column, value and local keys %1 times" ).arg( iterations * corpus.count() ) );
+
+    QList<LegacyDefinitionInfo> legacyDefinitions;
+    QList<DefinitionInfo> definitions;
+    foreach ( const QString& text, corpus ) {
+        legacyDefinitions.append( LegacyDefinitionInfo::fromString( text ) );
+        definitions.append( DefinitionInfo::fromString( text ) );
+    }
+
+    timer.start();
+    for ( int i = 0; i < iterations; i++ ) {
+        foreach ( const LegacyDefinitionInfo& info, legacyDefinitions )
+            checksum += info.metadata( "column" ).toInt() + info.metadata( "value" ).toString().length() + ( info.metadata( "local" ).toBool() ? 1 : 0 );
+    }
+    report.addTime( "Metadata map lookup", timer.nsecsElapsed() / 1000, iterations * corpus.count() );
+
+    timer.start();
+    for ( int i = 0; i < iterations; i++ ) {
+        foreach ( const DefinitionInfo& info, definitions )
+            checksum -= info.column() + info.value().length() + ( info.isLocal() ? 1 : 0 );
+    }
+    report.addTime( "Typed accessors", timer.nsecsElapsed() / 1000, iterations * corpus.count() );
+
+    if ( checksum != 0 )
+        report.addFailure( "different values of typed accessors" );
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    return report.exitCode();
+}
@@ -0,0 +1,5 @@
+include( ../benchmarks.pri )
+
+TARGET = issuedetails
+
+SOURCES += main.cpp
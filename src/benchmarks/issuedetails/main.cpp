@@ -0,0 +1,207 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "benchmarkenvironment.h"
+#include "benchmarkreport.h"
+#include "replaymanager.h"
+#include "syntheticserver.h"
+
+#include "application.h"
+#include "commands/updatebatch.h"
+#include "data/datamanager.h"
+#include "models/issuedetailsgenerator.h"
+#include "utils/htmlwriter.h"
+#include "utils/profiler.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QWebFrame>
+#include <QWebPage>
+
+static const int IssueId = 1;
+
+// the same page size as in IssueView
+static const int HistoryPageSize = 50;
+
+static QString renderDetails( QHash<int, HistoryItem>* cache, int limit, int* itemsCount = NULL )
+{
+    IssueDetailsGenerator generator;
+    generator.setIssue( IssueId, true, IssueDetailsGenerator::AllHistory );
+    generator.setHistoryCache( cache );
+    generator.setSectionIds( true );
+    generator.setHistoryLimit( limit );
+
+    HtmlWriter writer;
+    generator.write( &writer );
+
+    if ( itemsCount )
+        *itemsCount = generator.historyItemsCount();
+
+    return writer.toHtml();
+}
+
+static qint64 loadPage( const QString& html )
+{
+    QWebPage page;
+    QEventLoop loop;
+    QObject::connect( &page, SIGNAL( loadFinished( bool ) ), &loop, SLOT( quit() ) );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    page.mainFrame()->setHtml( html );
+    loop.exec();
+
+    return timer.nsecsElapsed() / 1000;
+}
+
+int main( int argc, char** argv )
+{
+    BenchmarkEnvironment environment( argc, argv );
+
+    Application application( environment.argc(), environment.argv(), true );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Measures redrawing the details of an issue with a long history." );
+    parser.addHelpOption();
+
+    QCommandLineOption changesOption( "changes", "Number of changes in the history of the issue.", "count", "5000" );
+    parser.addOption( changesOption );
+    QCommandLineOption iterationsOption( "iterations", "Number of repeated redraws.", "count", "5" );
+    parser.addOption( iterationsOption );
+    QCommandLineOption profileOption( "profile", "Report the statistics of profiled operations." );
+    parser.addOption( profileOption );
+
+    parser.process( environment.arguments() );
+
+    int changesCount = parser.value( changesOption ).toInt();
+    int iterations = qMax( parser.value( iterationsOption ).toInt(), 1 );
+
+    if ( parser.isSet( profileOption ) )
+        Profiler::setEnabled( true );
+
+    BenchmarkReport report( "Issue details benchmark" );
+
+    SyntheticServer server;
+    server.setIssuesCount( 10 );
+    server.setIssueChangesCount( IssueId, changesCount );
+
+    ReplayManager manager( &server );
+
+    if ( !environment.openConnection( &manager ) || !environment.updateAll() ) {
+        report.addFailure( "cannot download the initial data" );
+        return report.exitCode();
+    }
+
+    // keep the details of the issue in the cache like an open issue view
+    dataManager->lockIssue( IssueId );
+
+    UpdateBatch* batch = new UpdateBatch();
+    batch->updateIssue( IssueId, false );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if ( !environment.executeBatch( batch ) ) {
+        report.addFailure( "cannot download the details of the issue" );
+        return report.exitCode();
+    }
+
+    report.beginSection( QString( "Downloading %1 changes" ).arg( changesCount ) );
+    report.addTime( "GET DETAILS", timer.nsecsElapsed() / 1000 );
+
+    report.beginSection( "Generating HTML" );
+
+    int itemsCount = 0;
+
+    timer.start();
+    QString html = renderDetails( NULL, 0, &itemsCount );
+    report.addTime( "Full history, first time", timer.nsecsElapsed() / 1000 );
+
+    timer.start();
+    for ( int i = 0; i < iterations; i++ )
+        renderDetails( NULL, 0 );
+    report.addTime( "Full history, without cache", timer.nsecsElapsed() / 1000, iterations );
+
+    timer.start();
+    for ( int i = 0; i < iterations; i++ )
+        renderDetails( NULL, HistoryPageSize );
+    report.addTime( "First page of history", timer.nsecsElapsed() / 1000, iterations );
+
+    QHash<int, HistoryItem> cache;
+    renderDetails( &cache, 0 );
+
+    timer.start();
+    for ( int i = 0; i < iterations; i++ )
+        renderDetails( &cache, 0 );
+    report.addTime( "Full history, cached", timer.nsecsElapsed() / 1000, iterations );
+
+    if ( renderDetails( &cache, 0 ) != html )
+        report.addFailure( "cached history differs from generated history" );
+
+    report.addValue( "History items", QString::number( itemsCount ) );
+    report.addValue( "HTML size", QString( "%1 kB" ).arg( html.toUtf8().size() / 1024 ) );
+
+    report.beginSection( "Redrawing after a new comment" );
+
+    server.addComment( IssueId, SyntheticServer::commentText( changesCount ), TextWithMarkup );
+
+    batch = new UpdateBatch();
+    batch->updateIssue( IssueId, false );
+
+    timer.start();
+
+    if ( !environment.executeBatch( batch ) ) {
+        report.addFailure( "cannot download the new comment" );
+        return report.exitCode();
+    }
+
+    report.addTime( "GET DETAILS", timer.nsecsElapsed() / 1000 );
+
+    timer.start();
+    html = renderDetails( &cache, 0 );
+    report.addTime( "Full history, cached", timer.nsecsElapsed() / 1000 );
+
+    timer.start();
+    QString expected = renderDetails( NULL, 0 );
+    report.addTime( "Full history, without cache", timer.nsecsElapsed() / 1000 );
+
+    if ( html != expected )
+        report.addFailure( "cached history is not updated after a new comment" );
+
+    report.beginSection( "Loading the page" );
+
+    report.addTime( "Full history", loadPage( html ) );
+    report.addTime( "First page of history", loadPage( renderDetails( &cache, HistoryPageSize ) ) );
+
+    if ( parser.isSet( profileOption ) ) {
+        report.beginSection( "Profiler" );
+        report.addProfilerStatistics();
+    }
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    dataManager->unlockIssue( IssueId );
+
+    environment.closeConnection();
+
+    return report.exitCode();
+}
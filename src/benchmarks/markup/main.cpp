@@ -0,0 +1,293 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "legacymarkupprocessor.h"
+#include "benchmarkreport.h"
+
+#include "utils/markupprocessor.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QStringList>
+
+static QStringList createCorpus()
+{
+    QStringList corpus;
+
+    // plain text and inline formatting
+    corpus.append( "" );
+    corpus.append( "Simple text without any markup." );
+    corpus.append( "Text with **bold**, __italic__ and **__nested__** formatting." );
+    corpus.append( "Unbalanced **bold and __italic** text__ and ***** stars ____" );
+    corpus.append( "Inline `code with <html> & entities` and `unterminated code" );
+    corpus.append( "Tabs\tare\t\tconverted\tto spaces\nin\tevery line" );
+    corpus.append( "Special characters: < > & \" ' and \\ backslash" );
+    corpus.append( "Windows\r\nline\r\nendings\r\n" );
+
+    // code blocks
+    corpus.append( "[code]\nint main()\n{\n\treturn 0;\n}\n[/code]" );
+    corpus.append( "[code c++]\ntemplate<class T> T max( T a, T b ) { return a > b ? a : b; }\n[/code]\nafter" );
+    corpus.append( "[code C#]\nvar x = list.Where( i => i > 0 );\n[/code]" );
+    corpus.append( "[code unknown]\n**not bold** and http://example.com/not-a-link\n[/code]" );
+    corpus.append( "[code]\nouter\n[code]\nnested [list] [quote] `tick`\n[/code]\nstill code\n[/code]\ntext" );
+    corpus.append( "[code]\nunterminated block\n\twith tab" );
+    corpus.append( "[CODE]upper case tags[/CODE]" );
+
+    // lists
+    corpus.append( "[list]\n* first\n* second\n** nested\n*** deeper\n* back\n[/list]" );
+    corpus.append( "[list]\n*\n* empty item above\n  * indented\n\t* tab indented\n[/list]" );
+    corpus.append( "[list]\n* item with **bold** and [quote]quote[/quote]\n* [code]code[/code]\n[/list]" );
+    corpus.append( "[list]\n****** level six\n******* too deep\n[/list]" );
+    corpus.append( "[/list] unbalanced closing [/quote] tags [/code] [/rtl]" );
+
+    // quotes
+    corpus.append( "[quote]\nsimple quote\n[/quote]" );
+    corpus.append( "[quote John wrote]\nquote with title\n[/quote]" );
+    corpus.append( "[quote See #123:]\ntitle with a link\n[/quote]" );
+    corpus.append( "[quote first]\n[quote second]\n[quote third]\ndeep\n[/quote]\n[/quote]\nback\n[/quote]" );
+    corpus.append( "[quote]\nunterminated [quote] nested\n" );
+    corpus.append( "[rtl]\nright to left [quote]inside[/quote]\n[/rtl]" );
+
+    // explicit links
+    corpus.append( "[http://example.com]" );
+    corpus.append( "[http://example.com Example site] and [www.example.com/path?a=1&b=2 query]" );
+    corpus.append( "[#123] [#456 issue 456] [ftp.example.com files] [\\\\server\\share UNC path]" );
+    corpus.append( "[mailto:john@example.com John] [jane.doe+tag@mail.example.org]" );
+    corpus.append( "[http://example.com/a_(b) parenthesis] [file://C:/path/file.txt]" );
+    corpus.append( "[not a link] [http://] [#abc] [www.]" );
+
+    // automatic links at word boundaries
+    corpus.append( "See http://example.com, https://example.com/path. and ftp://example.com/file!" );
+    corpus.append( "Links: www.example.com/a_(b)_c (http://example.com/in/parens) http://example.com/end?" );
+    corpus.append( "URL at the end of text http://example.com/a/b/c.html" );
+    corpus.append( "http://example.com/start of text" );
+    corpus.append( "Mixed CASE: HTTP://EXAMPLE.COM WWW.Example.Com FTP.example.com" );
+    corpus.append( "prefixhttp://example.com xwww.example.com 1ftp.example.com" );
+    corpus.append( "E-mail john@example.com, mailto:jane@example.co.uk and bad@example.c or @example.com" );
+    corpus.append( "UNC path \\\\server\\share\\file.txt and \\\\\\\\ slashes" );
+    corpus.append( "http://example.com/~user/%20space|pipe$dollar=equals+plus&amp#hash" );
+
+    // item links
+    corpus.append( "#1 #12 #123456 at the start, in the middle #42, and at the end #7" );
+    corpus.append( "Not links: #abc a#1 #1a ##2 #" );
+    corpus.append( "Adjacent #1#2 and (#3) and [#4]" );
+
+    // unicode
+    corpus.append( QString::fromUtf8( "Zażółć **gęślą** jaźń — «цитата» 日本語のテキスト" ) );
+    corpus.append( QString::fromUtf8( "Łódź http://example.com/ścieżka user@przykład.pl #12ż" ) );
+    corpus.append( QString::fromUtf8( "[quote Ελληνικά]\nκείμενο `κώδικας` [http://example.com σύνδεσμος]\n[/quote]" ) );
+    corpus.append( QString::fromUtf8( "[rtl]\nעברית http://example.com العربية\n[/rtl]" ) );
+    corpus.append( QString::fromUtf8( "Emoji 😀 surrogate pairs 𝄞 and combining e\xcc\x81 characters" ) );
+
+    return corpus;
+}
+
+// fragments combined into pseudo-random texts
+static QStringList createFragments()
+{
+    QStringList fragments;
+
+    fragments.append( "text " );
+    fragments.append( "\n" );
+    fragments.append( "\t" );
+    fragments.append( "**" );
+    fragments.append( "__" );
+    fragments.append( "`" );
+    fragments.append( "[code]" );
+    fragments.append( "[/code]" );
+    fragments.append( "[code xml]\n" );
+    fragments.append( "[list]" );
+    fragments.append( "[/list]" );
+    fragments.append( "\n* " );
+    fragments.append( "\n** " );
+    fragments.append( "[quote]" );
+    fragments.append( "[quote title]\n" );
+    fragments.append( "[/quote]" );
+    fragments.append( "[rtl]" );
+    fragments.append( "[/rtl]" );
+    fragments.append( "[" );
+    fragments.append( "]" );
+    fragments.append( "#" );
+    fragments.append( "#12" );
+    fragments.append( "[#34 link]" );
+    fragments.append( "http://example.com" );
+    fragments.append( "www.example.com" );
+    fragments.append( "/path(1)" );
+    fragments.append( "." );
+    fragments.append( "," );
+    fragments.append( "user@example.com" );
+    fragments.append( "mailto:" );
+    fragments.append( "@" );
+    fragments.append( "\\\\" );
+    fragments.append( "<&>" );
+    fragments.append( QString::fromUtf8( "ąę " ) );
+    fragments.append( QString::fromUtf8( "日本" ) );
+
+    return fragments;
+}
+
+static QString createRandomText( const QStringList& fragments, uint& seed )
+{
+    QString text;
+
+    seed = seed * 1103515245 + 12345;
+    int count = 1 + ( seed >> 16 ) % 40;
+
+    for ( int i = 0; i < count; i++ ) {
+        seed = seed * 1103515245 + 12345;
+        text += fragments.at( ( seed >> 16 ) % fragments.count() );
+    }
+
+    return text;
+}
+
+static bool compareMarkup( const QString& text, HtmlText::Flags flags, BenchmarkReport& report )
+{
+    QString html = MarkupProcessor::parse( text, flags ).toString();
+    QString legacy = LegacyMarkupProcessor::parse( text, flags );
+
+    if ( html != legacy ) {
+        report.addFailure( QString( "different markup result for: %1\n  expected: %2\n  actual:   %3" ).arg( text, legacy, html ) );
+        return false;
+    }
+
+    html = HtmlText::parse( text, flags ).toString();
+    legacy = LegacyMarkupProcessor::parseLinks( text, flags );
+
+    if ( html != legacy ) {
+        report.addFailure( QString( "different links result for: %1\n  expected: %2\n  actual:   %3" ).arg( text, legacy, html ) );
+        return false;
+    }
+
+    return true;
+}
+
+int main( int argc, char** argv )
+{
+    QCoreApplication application( argc, argv );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Compares MarkupProcessor and HtmlText with the QRegExp-based implementation." );
+    parser.addHelpOption();
+
+    QCommandLineOption randomOption( "random", "Number of pseudo-random texts which are compared.", "count", "20000" );
+    parser.addOption( randomOption );
+    QCommandLineOption sizeOption( "size", "Size of the converted text in kilobytes.", "kB", "4096" );
+    parser.addOption( sizeOption );
+
+    parser.process( application );
+
+    int randomCount = parser.value( randomOption ).toInt();
+    int size = parser.value( sizeOption ).toInt() * 1024;
+
+    BenchmarkReport report( "Markup benchmark" );
+
+    QStringList corpus = createCorpus();
+
+    report.beginSection( "Correctness" );
+
+    int matching = 0;
+    foreach ( const QString& text, corpus ) {
+        if ( compareMarkup( text, 0, report ) && compareMarkup( text, HtmlText::NoInternalLinks, report ) )
+            matching++;
+    }
+
+    report.addValue( "Identical corpus results", QString( "%1 of %2" ).arg( matching ).arg( corpus.count() ) );
+
+    QStringList fragments = createFragments();
+    uint seed = 1;
+
+    matching = 0;
+    for ( int i = 0; i < randomCount; i++ ) {
+        if ( compareMarkup( createRandomText( fragments, seed ), 0, report ) )
+            matching++;
+    }
+
+    report.addValue( "Identical random results", QString( "%1 of %2" ).arg( matching ).arg( randomCount ) );
+
+    // comments are converted one by one, so the corpus is repeated instead of joined
+    QStringList comments;
+    qint64 bytes = 0;
+    while ( bytes < size ) {
+        foreach ( const QString& text, corpus ) {
+            comments.append( text );
+            bytes += text.toUtf8().size();
+        }
+    }
+
+    report.beginSection( QString( "Converting %1 comments with markup" ).arg( comments.count() ) );
+
+    QElapsedTimer timer;
+    int checksum = 0;
+
+    timer.start();
+    foreach ( const QString& text, comments )
+        checksum += LegacyMarkupProcessor::parse( text ).length();
+    report.addThroughput( "QRegExp parser", timer.nsecsElapsed() / 1000, bytes );
+
+    timer.start();
+    foreach ( const QString& text, comments )
+        checksum -= MarkupProcessor::parse( text ).toString().length();
+    report.addThroughput( "Scanner", timer.nsecsElapsed() / 1000, bytes );
+
+    if ( checksum != 0 )
+        report.addFailure( "different length of converted markup" );
+
+    report.beginSection( QString( "Extracting links from %1 texts" ).arg( comments.count() ) );
+
+    timer.start();
+    foreach ( const QString& text, comments )
+        checksum += LegacyMarkupProcessor::parseLinks( text ).length();
+    report.addThroughput( "QRegExp parser", timer.nsecsElapsed() / 1000, bytes );
+
+    timer.start();
+    foreach ( const QString& text, comments )
+        checksum -= HtmlText::parse( text ).toString().length();
+    report.addThroughput( "Scanner", timer.nsecsElapsed() / 1000, bytes );
+
+    if ( checksum != 0 )
+        report.addFailure( "different length of extracted links" );
+
+    // a single large code block stresses the per-line tokenizing
+    QString code = "[code c++]\n";
+    while ( code.length() < size )
+        code += "    for ( int i = 0; i < count; i++ ) sum += values[ i ] * 2; // http://example.com #12\n";
+    code += "[/code]";
+
+    qint64 codeBytes = code.toUtf8().size();
+
+    report.beginSection( QString( "Converting a %1 kB code block" ).arg( codeBytes / 1024 ) );
+
+    timer.start();
+    QString legacyCode = LegacyMarkupProcessor::parse( code );
+    report.addThroughput( "QRegExp parser", timer.nsecsElapsed() / 1000, codeBytes );
+
+    timer.start();
+    QString html = MarkupProcessor::parse( code ).toString();
+    report.addThroughput( "Scanner", timer.nsecsElapsed() / 1000, codeBytes );
+
+    if ( html != legacyCode )
+        report.addFailure( "different result for the code block" );
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    return report.exitCode();
+}
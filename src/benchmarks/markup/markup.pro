@@ -0,0 +1,8 @@
+include( ../benchmarks.pri )
+
+TARGET = markup
+
+HEADERS += legacymarkupprocessor.h
+
+SOURCES += legacymarkupprocessor.cpp \
+           main.cpp
@@ -0,0 +1,367 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "benchmarkenvironment.h"
+#include "benchmarkreport.h"
+#include "replaymanager.h"
+#include "syntheticserver.h"
+
+#include "application.h"
+#include "commands/updatebatch.h"
+#include "data/datamanager.h"
+#include "data/issuetypecache.h"
+#include "data/query.h"
+#include "data/querythread.h"
+#include "models/foldermodel.h"
+#include "models/querygenerator.h"
+#include "utils/attributehelper.h"
+#include "utils/definitioninfo.h"
+#include "utils/viewsettingshelper.h"
+
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+static const char* const stringOperators[] = { "EQ", "NEQ", "CON", "BEG", "END", "IN" };
+static const char* const numericOperators[] = { "EQ", "NEQ", "GT", "LT", "GTE", "LTE" };
+
+struct QueryCase
+{
+    QueryCase() : m_column( 0 ), m_viewId( 0 ), m_order( Qt::AscendingOrder ) { }
+
+    QString m_name;
+    int m_column;
+    int m_viewId;
+    Qt::SortOrder m_order;
+};
+
+static AttributeType columnType( IssueTypeCache* cache, int column )
+{
+    switch ( column ) {
+        case Column_ID:
+            return NumericAttribute;
+        case Column_CreatedDate:
+        case Column_ModifiedDate:
+            return DateTimeAttribute;
+        case Column_Name:
+        case Column_CreatedBy:
+        case Column_ModifiedBy:
+            return TextAttribute;
+        default:
+            if ( column > Column_UserDefined )
+                return AttributeHelper::toAttributeType( cache->attributeDefinition( column - Column_UserDefined ) );
+            return InvalidAttribute;
+    }
+}
+
+static QString columnTitle( IssueTypeCache* cache, int typeId, int column )
+{
+    QString title = ViewSettingsHelper( typeId ).columnName( column );
+    if ( column > Column_UserDefined )
+        title += QString( " (%1)" ).arg( cache->attributeDefinition( column - Column_UserDefined ).type() );
+    return title;
+}
+
+static QString formatDate( const QVariant& time )
+{
+    return QDateTime::fromTime_t( time.toUInt() ).toUTC().toString( "yyyy-MM-dd" );
+}
+
+static QString sampleValue( int column, int issueId )
+{
+    Query query;
+
+    switch ( column ) {
+        case Column_ID:
+            return QString::number( issueId );
+        case Column_Name:
+            query.execQuery( "SELECT issue_name FROM issues WHERE issue_id = ?", issueId );
+            return query.readScalar().toString();
+        case Column_CreatedDate:
+            query.execQuery( "SELECT created_time FROM issues WHERE issue_id = ?", issueId );
+            return formatDate( query.readScalar() );
+        case Column_ModifiedDate:
+            query.execQuery( "SELECT modified_time FROM issues WHERE issue_id = ?", issueId );
+            return formatDate( query.readScalar() );
+        case Column_CreatedBy:
+            query.execQuery( "SELECT u.user_name FROM issues AS i JOIN users AS u ON u.user_id = i.created_user_id WHERE i.issue_id = ?", issueId );
+            return query.readScalar().toString();
+        case Column_ModifiedBy:
+            query.execQuery( "SELECT u.user_name FROM issues AS i JOIN users AS u ON u.user_id = i.modified_user_id WHERE i.issue_id = ?", issueId );
+            return query.readScalar().toString();
+        default:
+            // some values are empty, so the first non-empty value is used
+            query.execQuery( "SELECT attr_value FROM attr_values WHERE attr_id = ? AND issue_id >= ? ORDER BY issue_id LIMIT 1", column - Column_UserDefined, issueId );
+            return query.readScalar().toString();
+    }
+}
+
+static QString filterValue( AttributeType type, const QString& op, const QString& value, const QString& other )
+{
+    if ( type == DateTimeAttribute )
+        return value.left( 10 );
+
+    if ( type == NumericAttribute )
+        return value;
+
+    int length = value.length();
+
+    if ( op == QLatin1String( "CON" ) )
+        return value.mid( length / 3, qMax( length / 3, 1 ) );
+    if ( op == QLatin1String( "BEG" ) )
+        return value.left( qMax( length / 2, 1 ) );
+    if ( op == QLatin1String( "END" ) )
+        return value.right( qMax( length / 2, 1 ) );
+    if ( op == QLatin1String( "IN" ) && !other.isEmpty() && other != value )
+        return QString( "%1, %2" ).arg( value, other );
+
+    return value;
+}
+
+static QString viewDefinition( int column, const QString& op = QString(), const QString& value = QString() )
+{
+    DefinitionInfo info;
+    info.setType( "VIEW" );
+
+    if ( column != Column_Location )
+        info.setMetadata( "columns", QString::number( column ) );
+
+    if ( !op.isEmpty() ) {
+        DefinitionInfo filter;
+        filter.setType( op );
+        filter.setMetadata( "column", column );
+        filter.setMetadata( "value", value );
+
+        info.setMetadata( "filters", QStringList() << filter.toString() );
+    }
+
+    return info.toString();
+}
+
+static QString orderClause( const QueryGenerator& generator, int column, Qt::SortOrder order )
+{
+    // the same clause is created by the FolderModel
+    int index = generator.columns().indexOf( column );
+
+    QStringList parts;
+    foreach ( const QString& part, generator.sortColumns().value( index ) )
+        parts.append( QString( "%1 %2" ).arg( part, order == Qt::AscendingOrder ? "ASC" : "DESC" ) );
+
+    if ( column != Column_ID && column != Column_CreatedDate )
+        parts.append( "i.issue_id ASC" );
+
+    return parts.join( ", " );
+}
+
+static QStringList explainQuery( const QString& sql, const QList<QVariant>& arguments )
+{
+    QStringList plan;
+
+    QSqlQuery query;
+    if ( !query.prepare( "EXPLAIN QUERY PLAN " + sql ) )
+        return plan;
+
+    foreach ( const QVariant& argument, arguments )
+        query.addBindValue( argument );
+
+    if ( !query.exec() )
+        return plan;
+
+    int column = query.record().count() - 1;
+
+    while ( query.next() )
+        plan.append( query.value( column ).toString() );
+
+    return plan;
+}
+
+static void runQuery( int typeId, const QueryCase& queryCase, int iterations, BenchmarkReport& report )
+{
+    QueryGenerator generator;
+    generator.initializeGlobalList( typeId, queryCase.m_viewId );
+
+    QString sql = generator.query( true );
+    if ( sql.isEmpty() ) {
+        report.addFailure( QString( "cannot generate the query: %1" ).arg( queryCase.m_name ) );
+        return;
+    }
+
+    sql += " ORDER BY " + orderClause( generator, queryCase.m_column, queryCase.m_order );
+
+    QElapsedTimer timer;
+    qint64 total = 0;
+    int rows = 0;
+
+    for ( int i = 0; i < iterations; i++ ) {
+        timer.start();
+        QueryResult result = QueryResult::execute( QSqlDatabase::database(), sql, generator.arguments() );
+        total += timer.nsecsElapsed() / 1000;
+
+        if ( !result.isValid() ) {
+            report.addFailure( QString( "cannot execute the query: %1" ).arg( queryCase.m_name ) );
+            return;
+        }
+
+        rows = result.rowCount();
+    }
+
+    report.addTime( queryCase.m_name, total, iterations );
+    report.addValue( "  rows", QString::number( rows ) );
+
+    foreach ( const QString& step, explainQuery( sql, generator.arguments() ) )
+        report.addValue( "  plan", step );
+}
+
+int main( int argc, char** argv )
+{
+    BenchmarkEnvironment environment( argc, argv );
+
+    Application application( environment.argc(), environment.argv(), true );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Measures the queries generated for filters and sort columns of views." );
+    parser.addHelpOption();
+
+    QCommandLineOption foldersOption( "folders", "Number of generated folders.", "count", "10" );
+    parser.addOption( foldersOption );
+    QCommandLineOption issuesOption( "issues", "Number of generated issues in each folder.", "count", "10000" );
+    parser.addOption( issuesOption );
+    QCommandLineOption attributesOption( "attributes", "Number of generated attributes.", "count", "30" );
+    parser.addOption( attributesOption );
+    QCommandLineOption iterationsOption( "iterations", "Number of times each query is executed.", "count", "3" );
+    parser.addOption( iterationsOption );
+
+    parser.process( environment.arguments() );
+
+    int iterations = qMax( parser.value( iterationsOption ).toInt(), 1 );
+
+    SyntheticServer server;
+    server.setFoldersCount( parser.value( foldersOption ).toInt() );
+    server.setIssuesCount( parser.value( issuesOption ).toInt() );
+    server.setAttributesCount( parser.value( attributesOption ).toInt() );
+    server.setChangesCount( 1 );
+
+    ReplayManager manager( &server );
+
+    BenchmarkReport report( "Queries benchmark" );
+
+    report.beginSection( "Generating cache.db" );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if ( !environment.openConnection( &manager ) || !environment.updateAll() ) {
+        report.addFailure( "cannot generate the cache" );
+        return report.exitCode();
+    }
+
+    report.addTime( "Initial update", timer.nsecsElapsed() / 1000 );
+
+    Query query;
+    query.execQuery( "SELECT COUNT(*) FROM issues" );
+    int issuesCount = query.readScalar().toInt();
+    query.execQuery( "SELECT COUNT(*) FROM attr_values" );
+    report.addValue( "Issues", QString::number( issuesCount ) );
+    report.addValue( "Attribute values", QString::number( query.readScalar().toInt() ) );
+
+    query.execQuery( "SELECT type_id FROM issue_types" );
+    int typeId = query.readScalar().toInt();
+
+    // the sample values are taken from issues in the middle of the list
+    query.execQuery( "SELECT issue_id FROM issues ORDER BY issue_id LIMIT 2 OFFSET ?", issuesCount / 2 );
+    int issueId = query.next() ? query.value( 0 ).toInt() : 0;
+    int otherId = query.next() ? query.value( 0 ).toInt() : issueId;
+
+    IssueTypeCache* cache = dataManager->issueTypeCache( typeId );
+
+    QList<QueryCase> filterCases;
+    QList<QueryCase> sortCases;
+
+    foreach ( int column, cache->availableColumns( true ) ) {
+        QString title = columnTitle( cache, typeId, column );
+
+        QueryCase sortCase;
+        sortCase.m_column = column;
+        sortCase.m_viewId = server.addView( title, viewDefinition( column ) );
+
+        sortCase.m_name = title + " ascending";
+        sortCases.append( sortCase );
+
+        sortCase.m_name = title + " descending";
+        sortCase.m_order = Qt::DescendingOrder;
+        sortCases.append( sortCase );
+
+        // the location cannot be used in filters
+        if ( column == Column_Location )
+            continue;
+
+        AttributeType type = columnType( cache, column );
+
+        QString value = sampleValue( column, issueId );
+        QString other = sampleValue( column, otherId );
+
+        const char* const* operators = ( type == NumericAttribute || type == DateTimeAttribute ) ? numericOperators : stringOperators;
+
+        for ( int i = 0; i < 6; i++ ) {
+            QueryCase filterCase;
+            filterCase.m_column = Column_ID;
+            filterCase.m_name = QString( "%1 %2" ).arg( title, operators[ i ] );
+            filterCase.m_viewId = server.addView( filterCase.m_name, viewDefinition( column, operators[ i ], filterValue( type, operators[ i ], value, other ) ) );
+            filterCases.append( filterCase );
+        }
+
+        // an empty value creates a condition checking for NULL
+        for ( int i = 0; i < 2; i++ ) {
+            QueryCase filterCase;
+            filterCase.m_column = Column_ID;
+            filterCase.m_name = QString( "%1 %2 empty" ).arg( title, numericOperators[ i ] );
+            filterCase.m_viewId = server.addView( filterCase.m_name, viewDefinition( column, numericOperators[ i ], QString() ) );
+            filterCases.append( filterCase );
+        }
+    }
+
+    // the views are added to the cache by updating the types
+    UpdateBatch* batch = new UpdateBatch();
+    batch->updateTypes();
+
+    if ( !environment.executeBatch( batch ) ) {
+        report.addFailure( "cannot update the views" );
+        return report.exitCode();
+    }
+
+    report.beginSection( QString( "Filters (%1 queries)" ).arg( filterCases.count() ) );
+
+    foreach ( const QueryCase& filterCase, filterCases )
+        runQuery( typeId, filterCase, iterations, report );
+
+    report.beginSection( QString( "Sort columns (%1 queries)" ).arg( sortCases.count() ) );
+
+    foreach ( const QueryCase& sortCase, sortCases )
+        runQuery( typeId, sortCase, iterations, report );
+
+    environment.closeConnection();
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    return report.exitCode();
+}
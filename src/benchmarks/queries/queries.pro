@@ -0,0 +1,5 @@
+include( ../benchmarks.pri )
+
+TARGET = queries
+
+SOURCES += main.cpp
@@ -0,0 +1,246 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "benchmarkenvironment.h"
+#include "benchmarkreport.h"
+#include "stubserver.h"
+#include "syntheticserver.h"
+
+#include "application.h"
+#include "commands/issuebatch.h"
+#include "commands/updatebatch.h"
+#include "data/datamanager.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+
+// number of issues modified in each folder before refreshing
+static const int ModifiedIssuesCount = 5;
+
+int main( int argc, char** argv )
+{
+    BenchmarkEnvironment environment( argc, argv );
+
+    Application application( environment.argc(), environment.argv(), true );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Measures the end-to-end time of refreshing data from a local stub server." );
+    parser.addHelpOption();
+
+    QCommandLineOption latencyOption( "latency", "Delay of each response in milliseconds.", "ms", "50" );
+    parser.addOption( latencyOption );
+    QCommandLineOption bandwidthOption( "bandwidth", "Maximum speed of responses in kB/s, 0 means unlimited.", "speed", "0" );
+    parser.addOption( bandwidthOption );
+    QCommandLineOption projectsOption( "projects", "Number of generated projects.", "count", "2" );
+    parser.addOption( projectsOption );
+    QCommandLineOption foldersOption( "folders", "Number of generated folders in each project.", "count", "5" );
+    parser.addOption( foldersOption );
+    QCommandLineOption issuesOption( "issues", "Number of generated issues in each folder.", "count", "1000" );
+    parser.addOption( issuesOption );
+    QCommandLineOption changesOption( "changes", "Number of generated changes of each issue.", "count", "20" );
+    parser.addOption( changesOption );
+    QCommandLineOption attachmentOption( "attachment", "Size of attachments in kB.", "size", "256" );
+    parser.addOption( attachmentOption );
+
+    parser.process( environment.arguments() );
+
+    int attachmentSize = qMax( parser.value( attachmentOption ).toInt(), 1 ) * 1024;
+
+    SyntheticServer server;
+    server.setProjectsCount( parser.value( projectsOption ).toInt() );
+    server.setFoldersCount( parser.value( foldersOption ).toInt() );
+    server.setIssuesCount( parser.value( issuesOption ).toInt() );
+    server.setChangesCount( parser.value( changesOption ).toInt() );
+    server.setAttachmentSize( attachmentSize );
+
+    StubServer stub( &server );
+    stub.setLatency( parser.value( latencyOption ).toInt() );
+    stub.setBandwidth( parser.value( bandwidthOption ).toInt() * 1024 );
+
+    BenchmarkReport report( "Refresh benchmark" );
+
+    if ( !stub.start() ) {
+        report.addFailure( QString( "cannot start the stub server: %1" ).arg( stub.errorString() ) );
+        return report.exitCode();
+    }
+
+    QNetworkAccessManager manager;
+    manager.setProxy( QNetworkProxy::NoProxy );
+
+    report.beginSection( QString( "Stub server at %1" ).arg( stub.url().toString() ) );
+
+    report.addValue( "Latency", QString( "%1 ms" ).arg( stub.latency() ) );
+    report.addValue( "Bandwidth", stub.bandwidth() > 0 ? QString( "%1 kB/s" ).arg( stub.bandwidth() / 1024 ) : QString( "unlimited" ) );
+
+    QElapsedTimer timer;
+
+    timer.start();
+    if ( !environment.openConnection( &manager, stub.url() ) ) {
+        report.addFailure( "cannot log in to the stub server" );
+        return report.exitCode();
+    }
+    report.addTime( "Hello and login", timer.nsecsElapsed() / 1000 );
+
+    QList<int> folders = server.folders();
+    int issueId = server.issues( folders.first() ).first();
+    int fileId = 0;
+
+    timer.start();
+    bool ok = environment.updateAll();
+    qint64 initialTime = timer.nsecsElapsed() / 1000;
+
+    if ( ok ) {
+        report.addThroughput( "Initial update", initialTime, stub.responsesSize() );
+
+        // keep the details of the opened issue like the issue view does
+        dataManager->lockIssue( issueId );
+
+        UpdateBatch* batch = new UpdateBatch();
+        batch->updateIssue( issueId, true );
+
+        timer.start();
+        ok = environment.executeBatch( batch );
+        if ( ok )
+            report.addTime( "Opening an issue", timer.nsecsElapsed() / 1000 );
+        else
+            report.addFailure( "cannot open the issue" );
+    } else {
+        report.addFailure( "cannot update the data" );
+    }
+
+    if ( ok ) {
+        report.beginSection( "Refreshing after changes on the server" );
+
+        foreach ( int folderId, folders ) {
+            QList<int> issues = server.issues( folderId );
+            for ( int i = 0; i < issues.count() && i < ModifiedIssuesCount; i++ )
+                server.addComment( issues.at( i ), SyntheticServer::commentText( i ), TextWithMarkup );
+        }
+        fileId = server.addAttachment( issueId, "refresh.bin", "Attachment added on the server", QByteArray( attachmentSize, 'x' ) );
+
+        UpdateBatch* batch = new UpdateBatch();
+        batch->updateProjects();
+        batch->updateStates();
+        foreach ( int folderId, folders )
+            batch->updateFolder( folderId );
+        batch->updateIssue( issueId, true );
+
+        int requestsCount = stub.requestsCount();
+        qint64 responsesSize = stub.responsesSize();
+
+        timer.start();
+        ok = environment.executeBatch( batch );
+        qint64 refreshTime = timer.nsecsElapsed() / 1000;
+
+        if ( ok ) {
+            report.addThroughput( "Refresh", refreshTime, stub.responsesSize() - responsesSize );
+            report.addValue( "Requests", QString::number( stub.requestsCount() - requestsCount ) );
+        } else {
+            report.addFailure( "cannot refresh the data" );
+        }
+    }
+
+    if ( ok ) {
+        report.beginSection( "Attachments" );
+
+        QString uploadPath = environment.path() + "/upload.bin";
+        QString downloadPath = environment.path() + "/download.bin";
+
+        QFile file( uploadPath );
+        if ( file.open( QIODevice::WriteOnly ) ) {
+            file.write( QByteArray( attachmentSize, 'x' ) );
+            file.close();
+        }
+
+        IssueBatch* batch = new IssueBatch( issueId );
+        batch->addAttachment( "upload.bin", "Uploaded attachment", uploadPath );
+
+        timer.start();
+        if ( environment.executeBatch( batch ) )
+            report.addThroughput( "Adding an attachment", timer.nsecsElapsed() / 1000, attachmentSize );
+        else
+            report.addFailure( "cannot add the attachment" );
+
+        batch = new IssueBatch( issueId );
+        batch->getAttachment( fileId, downloadPath );
+
+        timer.start();
+        if ( environment.executeBatch( batch ) )
+            report.addThroughput( "Getting an attachment", timer.nsecsElapsed() / 1000, attachmentSize );
+        else
+            report.addFailure( "cannot get the attachment" );
+
+        if ( QFile( downloadPath ).size() != attachmentSize )
+            report.addFailure( "the downloaded attachment has a wrong size" );
+    }
+
+    if ( ok ) {
+        report.beginSection( "Cached attachments" );
+
+        // an attachment with the same content is added to another issue
+        int otherIssueId = server.issues( folders.last() ).last();
+        int copyId = server.addAttachment( otherIssueId, "copy.bin", "Copy of the attachment", QByteArray( attachmentSize, 'x' ) );
+
+        timer.start();
+        QString path = environment.downloadAttachment( issueId, fileId, "refresh.bin", attachmentSize );
+        if ( !path.isEmpty() )
+            report.addThroughput( "Caching an attachment", timer.nsecsElapsed() / 1000, attachmentSize );
+        else
+            report.addFailure( "cannot cache the attachment" );
+
+        qint64 responsesSize = stub.responsesSize();
+        bool skipped = false;
+
+        timer.start();
+        QString copyPath = environment.downloadAttachment( otherIssueId, copyId, "copy.bin", attachmentSize, &skipped );
+        if ( !copyPath.isEmpty() ) {
+            report.addTime( "Caching an identical attachment", timer.nsecsElapsed() / 1000 );
+            report.addValue( "Downloaded", QString( "%1 bytes" ).arg( stub.responsesSize() - responsesSize ) );
+        } else {
+            report.addFailure( "cannot cache the identical attachment" );
+        }
+
+        if ( !path.isEmpty() && !copyPath.isEmpty() ) {
+            if ( !skipped )
+                report.addFailure( "the identical attachment was downloaded again" );
+            if ( copyPath != path )
+                report.addFailure( "the identical attachment is not stored in the same file" );
+            if ( QFileInfo( copyPath ).size() != attachmentSize )
+                report.addFailure( "the cached attachment has a wrong size" );
+        }
+    }
+
+    if ( dataManager )
+        dataManager->unlockIssue( issueId );
+
+    environment.closeConnection();
+
+    report.beginSection( "Stub server" );
+    report.addValue( "Requests", QString::number( stub.requestsCount() ) );
+    report.addValue( "Size of responses", QString( "%1 MB" ).arg( QString::number( stub.responsesSize() / ( 1024.0 * 1024.0 ), 'f', 2 ) ) );
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    return report.exitCode();
+}
@@ -0,0 +1,5 @@
+include( ../benchmarks.pri )
+
+TARGET = refresh
+
+SOURCES += main.cpp
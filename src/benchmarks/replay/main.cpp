@@ -0,0 +1,251 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "transcript.h"
+#include "benchmarkenvironment.h"
+#include "benchmarkreport.h"
+#include "replaymanager.h"
+#include "syntheticserver.h"
+
+#include "application.h"
+#include "commands/updatebatch.h"
+#include "data/datamanager.h"
+#include "data/query.h"
+#include "utils/profiler.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+enum Stage
+{
+    LoginStage,
+    GlobalStage,
+    ListsStage,
+    DetailsStage,
+    StagesCount
+};
+
+static const char* const stageNames[ StagesCount ] = {
+    "Hello and login",
+    "Settings, users, types, projects and states",
+    "Summaries and lists of issues",
+    "Issue details"
+};
+
+static bool runUpdates( BenchmarkEnvironment& environment, QNetworkAccessManager* manager, int detailsCount, qint64* times )
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    if ( !environment.openConnection( manager ) )
+        return false;
+    times[ LoginStage ] += timer.nsecsElapsed() / 1000;
+
+    UpdateBatch* batch = new UpdateBatch();
+    batch->updateSettings();
+    batch->updateUsers();
+    batch->updateTypes();
+    batch->updateProjects();
+    batch->updateStates();
+
+    timer.start();
+    if ( !environment.executeBatch( batch ) )
+        return false;
+    times[ GlobalStage ] += timer.nsecsElapsed() / 1000;
+
+    Query query;
+
+    batch = new UpdateBatch();
+
+    if ( !query.execQuery( "SELECT project_id FROM projects ORDER BY project_id" ) )
+        return false;
+    while ( query.next() )
+        batch->updateSummary( query.value( 0 ).toInt() );
+
+    if ( !query.execQuery( "SELECT folder_id FROM folders ORDER BY folder_id" ) )
+        return false;
+    while ( query.next() )
+        batch->updateFolder( query.value( 0 ).toInt() );
+
+    timer.start();
+    if ( !environment.executeBatch( batch ) )
+        return false;
+    times[ ListsStage ] += timer.nsecsElapsed() / 1000;
+
+    batch = new UpdateBatch();
+
+    if ( !query.execQuery( "SELECT issue_id FROM issues ORDER BY issue_id LIMIT ?", detailsCount ) )
+        return false;
+    while ( query.next() )
+        batch->updateIssue( query.value( 0 ).toInt(), false );
+
+    timer.start();
+    if ( !environment.executeBatch( batch ) )
+        return false;
+    times[ DetailsStage ] += timer.nsecsElapsed() / 1000;
+
+    return true;
+}
+
+static int countDetails( const Transcript& transcript )
+{
+    int count = 0;
+    foreach ( const QString& command, transcript.commands() ) {
+        if ( command.startsWith( QLatin1String( "GET DETAILS " ) ) )
+            count++;
+    }
+    return count;
+}
+
+int main( int argc, char** argv )
+{
+    BenchmarkEnvironment environment( argc, argv );
+
+    Application application( environment.argc(), environment.argv(), true );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Replays server responses through the CommandManager and DataManager." );
+    parser.addHelpOption();
+
+    QCommandLineOption transcriptOption( "transcript", "Replay responses recorded in a file instead of generating them.", "file" );
+    parser.addOption( transcriptOption );
+    QCommandLineOption generateOption( "generate", "Save the generated responses to a file.", "file" );
+    parser.addOption( generateOption );
+    QCommandLineOption projectsOption( "projects", "Number of generated projects.", "count", "2" );
+    parser.addOption( projectsOption );
+    QCommandLineOption foldersOption( "folders", "Number of generated folders in each project.", "count", "5" );
+    parser.addOption( foldersOption );
+    QCommandLineOption issuesOption( "issues", "Number of generated issues in each folder.", "count", "1000" );
+    parser.addOption( issuesOption );
+    QCommandLineOption attributesOption( "attributes", "Number of generated attributes.", "count", "10" );
+    parser.addOption( attributesOption );
+    QCommandLineOption changesOption( "changes", "Number of generated changes of each issue.", "count", "20" );
+    parser.addOption( changesOption );
+    QCommandLineOption detailsOption( "details", "Number of issues whose details are generated.", "count", "100" );
+    parser.addOption( detailsOption );
+    QCommandLineOption iterationsOption( "iterations", "Number of times the responses are replayed.", "count", "3" );
+    parser.addOption( iterationsOption );
+    QCommandLineOption queriesOption( "queries", "Report the statistics and plans of executed queries." );
+    parser.addOption( queriesOption );
+
+    parser.process( environment.arguments() );
+
+    int iterations = qMax( parser.value( iterationsOption ).toInt(), 1 );
+
+    BenchmarkReport report( "Replay benchmark" );
+
+    Transcript transcript;
+
+    if ( parser.isSet( transcriptOption ) ) {
+        if ( !transcript.load( parser.value( transcriptOption ) ) ) {
+            report.addFailure( QString( "cannot load transcript: %1" ).arg( parser.value( transcriptOption ) ) );
+            return report.exitCode();
+        }
+    } else {
+        SyntheticServer server;
+        server.setProjectsCount( parser.value( projectsOption ).toInt() );
+        server.setFoldersCount( parser.value( foldersOption ).toInt() );
+        server.setIssuesCount( parser.value( issuesOption ).toInt() );
+        server.setAttributesCount( parser.value( attributesOption ).toInt() );
+        server.setChangesCount( parser.value( changesOption ).toInt() );
+
+        TranscriptRecorder recorder( &server, &transcript );
+        ReplayManager manager( &recorder );
+
+        report.beginSection( "Generating responses" );
+
+        qint64 times[ StagesCount ] = { 0 };
+        bool ok = runUpdates( environment, &manager, parser.value( detailsOption ).toInt(), times );
+
+        environment.closeConnection();
+        environment.clearCache();
+
+        if ( !ok ) {
+            report.addFailure( "cannot generate the responses" );
+            return report.exitCode();
+        }
+
+        for ( int i = 0; i < StagesCount; i++ )
+            report.addTime( stageNames[ i ], times[ i ] );
+
+        if ( parser.isSet( generateOption ) ) {
+            if ( transcript.save( parser.value( generateOption ) ) )
+                report.addValue( "Saved transcript", parser.value( generateOption ) );
+            else
+                report.addFailure( QString( "cannot save transcript: %1" ).arg( parser.value( generateOption ) ) );
+        }
+    }
+
+    // the same issues must be requested as when the transcript was recorded
+    int detailsCount = countDetails( transcript );
+
+    report.beginSection( QString( "Replaying %1 responses %2 times" ).arg( transcript.count() ).arg( iterations ) );
+
+    report.addValue( "Size of responses", QString( "%1 MB" ).arg( QString::number( transcript.size() / ( 1024.0 * 1024.0 ), 'f', 2 ) ) );
+
+    Profiler::setEnabled( true );
+
+    qint64 times[ StagesCount ] = { 0 };
+    int completed = 0;
+
+    for ( int i = 0; i < iterations; i++ ) {
+        transcript.rewind();
+
+        ReplayManager manager( &transcript );
+        bool ok = runUpdates( environment, &manager, detailsCount, times );
+
+        environment.closeConnection();
+        environment.clearCache();
+
+        if ( transcript.missingCount() > 0 )
+            report.addFailure( QString( "%1 commands without a recorded response" ).arg( transcript.missingCount() ) );
+
+        if ( !ok ) {
+            report.addFailure( "cannot replay the responses" );
+            break;
+        }
+
+        completed++;
+    }
+
+    Profiler::setEnabled( false );
+
+    if ( completed > 0 ) {
+        qint64 total = 0;
+        for ( int i = 0; i < StagesCount; i++ ) {
+            report.addTime( stageNames[ i ], times[ i ], completed );
+            total += times[ i ];
+        }
+
+        report.addThroughput( "Total", total, transcript.size() * completed );
+    }
+
+    report.beginSection( "Stages of processing responses" );
+    report.addProfilerStatistics();
+
+    if ( parser.isSet( queriesOption ) ) {
+        report.beginSection( "Queries" );
+        report.addQueryStatistics();
+    }
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    return report.exitCode();
+}
@@ -0,0 +1,8 @@
+include( ../benchmarks.pri )
+
+TARGET = replay
+
+HEADERS += transcript.h
+
+SOURCES += main.cpp \
+           transcript.cpp
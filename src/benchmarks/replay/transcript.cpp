@@ -0,0 +1,147 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "transcript.h"
+
+#include <QDataStream>
+#include <QFile>
+
+static const quint32 TranscriptMagic = 0x57495452;
+static const qint32 TranscriptVersion = 1;
+
+Transcript::Transcript() :
+    m_size( 0 ),
+    m_missingCount( 0 )
+{
+}
+
+Transcript::~Transcript()
+{
+}
+
+void Transcript::append( const QString& command, const ServerResponse& response )
+{
+    m_indexes[ command ].append( m_commands.count() );
+
+    m_commands.append( command );
+    m_responses.append( response );
+
+    m_size += response.m_body.size();
+}
+
+void Transcript::clear()
+{
+    m_commands.clear();
+    m_responses.clear();
+    m_indexes.clear();
+    m_positions.clear();
+
+    m_size = 0;
+    m_missingCount = 0;
+}
+
+void Transcript::rewind()
+{
+    m_positions.clear();
+    m_missingCount = 0;
+}
+
+ServerResponse Transcript::response( const QString& command, const QByteArray& /*attachment*/ )
+{
+    QHash<QString, QList<int> >::const_iterator it = m_indexes.constFind( command );
+
+    int& position = m_positions[ command ];
+
+    if ( it == m_indexes.constEnd() || position >= it.value().count() ) {
+        m_missingCount++;
+        return ServerResponse( "ERROR 400 " + quoteString( "No recorded response" ).toUtf8() + "\r\n" );
+    }
+
+    return m_responses.at( it.value().at( position++ ) );
+}
+
+bool Transcript::load( const QString& path )
+{
+    clear();
+
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_0 );
+
+    quint32 magic;
+    qint32 version;
+    stream >> magic >> version;
+
+    if ( magic != TranscriptMagic || version != TranscriptVersion )
+        return false;
+
+    while ( !stream.atEnd() ) {
+        QString command;
+        ServerResponse response;
+        stream >> command >> response.m_contentType >> response.m_body;
+
+        if ( stream.status() != QDataStream::Ok ) {
+            clear();
+            return false;
+        }
+
+        append( command, response );
+    }
+
+    return true;
+}
+
+bool Transcript::save( const QString& path ) const
+{
+    QFile file( path );
+    if ( !file.open( QIODevice::WriteOnly ) )
+        return false;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_0 );
+
+    stream << TranscriptMagic << TranscriptVersion;
+
+    for ( int i = 0; i < m_commands.count(); i++ )
+        stream << m_commands.at( i ) << m_responses.at( i ).m_contentType << m_responses.at( i ).m_body;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+TranscriptRecorder::TranscriptRecorder( ReplySource* source, Transcript* transcript ) :
+    m_source( source ),
+    m_transcript( transcript )
+{
+}
+
+TranscriptRecorder::~TranscriptRecorder()
+{
+}
+
+ServerResponse TranscriptRecorder::response( const QString& command, const QByteArray& attachment )
+{
+    ServerResponse response = m_source->response( command, attachment );
+
+    m_transcript->append( command, response );
+
+    return response;
+}
@@ -0,0 +1,137 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef TRANSCRIPT_H
+#define TRANSCRIPT_H
+
+#include "replysource.h"
+
+#include <QHash>
+#include <QList>
+
+/**
+* Recorded sequence of commands and responses of a server.
+*
+* The transcript can be saved to a file and loaded again. When it is used
+* as a ReplySource, the recorded responses are returned in the order in
+* which they were recorded for each command.
+*/
+class Transcript : public ReplySource
+{
+public:
+    /**
+    * Constructor.
+    */
+    Transcript();
+
+    /**
+    * Destructor.
+    */
+    ~Transcript();
+
+public:
+    /**
+    * Append a command and its response to the transcript.
+    */
+    void append( const QString& command, const ServerResponse& response );
+
+    /**
+    * Remove all commands from the transcript.
+    */
+    void clear();
+
+    /**
+    * Return the number of recorded commands.
+    */
+    int count() const { return m_commands.count(); }
+
+    /**
+    * Return the recorded commands.
+    */
+    const QList<QString>& commands() const { return m_commands; }
+
+    /**
+    * Return the total size of recorded responses in bytes.
+    */
+    qint64 size() const { return m_size; }
+
+    /**
+    * Start returning responses from the beginning of the transcript.
+    */
+    void rewind();
+
+    /**
+    * Return the number of commands for which no response was recorded
+    * since the last call to rewind().
+    */
+    int missingCount() const { return m_missingCount; }
+
+    /**
+    * Load the transcript from a file.
+    * @return @c true if the file was loaded successfully.
+    */
+    bool load( const QString& path );
+
+    /**
+    * Save the transcript to a file.
+    * @return @c true if the file was saved successfully.
+    */
+    bool save( const QString& path ) const;
+
+public: // overrides
+    ServerResponse response( const QString& command, const QByteArray& attachment );
+
+private:
+    QList<QString> m_commands;
+    QList<ServerResponse> m_responses;
+
+    QHash<QString, QList<int> > m_indexes;
+    QHash<QString, int> m_positions;
+
+    qint64 m_size;
+    int m_missingCount;
+};
+
+/**
+* Source of responses which records them in a transcript.
+*/
+class TranscriptRecorder : public ReplySource
+{
+public:
+    /**
+    * Constructor.
+    * @param source The source of responses.
+    * @param transcript The transcript which records the responses.
+    */
+    TranscriptRecorder( ReplySource* source, Transcript* transcript );
+
+    /**
+    * Destructor.
+    */
+    ~TranscriptRecorder();
+
+public: // overrides
+    ServerResponse response( const QString& command, const QByteArray& attachment );
+
+private:
+    ReplySource* m_source;
+    Transcript* m_transcript;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "benchmarkenvironment.h"
+#include "benchmarkreport.h"
+#include "replaymanager.h"
+#include "syntheticserver.h"
+
+#include "application.h"
+#include "commands/updatebatch.h"
+#include "data/datamanager.h"
+#include "models/reportgenerator.h"
+#include "models/summaryrenderer.h"
+#include "utils/htmlwriter.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QThread>
+
+static qint64 renderSummaries( const QList<int>& issues, int workersCount, IssueDetailsGenerator::History history, QStringList& fragments )
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    SummaryRenderer renderer( false, history, HtmlText::NoInternalLinks );
+    renderer.setWorkersCount( workersCount );
+
+    fragments.clear();
+
+    for ( int i = 0; i < issues.count(); i += renderer.batchSize() ) {
+        QStringList batch;
+        if ( !renderer.render( issues.mid( i, renderer.batchSize() ), batch ) )
+            return -1;
+        fragments += batch;
+    }
+
+    return timer.nsecsElapsed() / 1000;
+}
+
+int main( int argc, char** argv )
+{
+    BenchmarkEnvironment environment( argc, argv );
+
+    Application application( environment.argc(), environment.argv(), true );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Measures scaling of the summary report with the number of threads." );
+    parser.addHelpOption();
+
+    QCommandLineOption issuesOption( "issues", "Number of issues in the report.", "count", "1000" );
+    parser.addOption( issuesOption );
+    QCommandLineOption changesOption( "changes", "Number of changes in the history of each issue.", "count", "20" );
+    parser.addOption( changesOption );
+    QCommandLineOption threadsOption( "threads", "Maximum number of threads.", "count", QString::number( qMax( QThread::idealThreadCount(), 1 ) ) );
+    parser.addOption( threadsOption );
+
+    parser.process( environment.arguments() );
+
+    int issuesCount = parser.value( issuesOption ).toInt();
+    int changesCount = parser.value( changesOption ).toInt();
+    int maxThreads = qMax( parser.value( threadsOption ).toInt(), 1 );
+
+    BenchmarkReport report( "Summary report benchmark" );
+
+    SyntheticServer server;
+    server.setIssuesCount( issuesCount );
+    server.setChangesCount( changesCount );
+
+    ReplayManager manager( &server );
+
+    if ( !environment.openConnection( &manager ) || !environment.updateAll() ) {
+        report.addFailure( "cannot download the initial data" );
+        return report.exitCode();
+    }
+
+    int folderId = server.folders().first();
+    QList<int> issues = server.issues( folderId );
+
+    // details of all issues must remain in the cache
+    UpdateBatch* batch = new UpdateBatch();
+    foreach ( int issueId, issues ) {
+        dataManager->lockIssue( issueId );
+        batch->updateIssue( issueId, false );
+    }
+
+    if ( !environment.executeBatch( batch ) ) {
+        report.addFailure( "cannot download the details of issues" );
+        return report.exitCode();
+    }
+
+    const IssueDetailsGenerator::History histories[] = { IssueDetailsGenerator::NoHistory, IssueDetailsGenerator::AllHistory };
+    const char* const names[] = { "without history", "with full history" };
+
+    for ( int i = 0; i < 2; i++ ) {
+        report.beginSection( QString( "Rendering %1 issues %2" ).arg( issues.count() ).arg( names[ i ] ) );
+
+        QStringList expected;
+        qint64 sequential = renderSummaries( issues, 1, histories[ i ], expected );
+
+        if ( sequential < 0 ) {
+            report.addFailure( "cannot connect to the database" );
+            continue;
+        }
+
+        report.addTime( "1 thread", sequential, issues.count() );
+
+        for ( int threads = 2; threads <= maxThreads; threads++ ) {
+            QStringList fragments;
+            qint64 time = renderSummaries( issues, threads, histories[ i ], fragments );
+
+            if ( time < 0 ) {
+                report.addFailure( "cannot connect to the database" );
+                break;
+            }
+
+            report.addTime( QString( "%1 threads" ).arg( threads ), time, issues.count() );
+            report.addValue( QString( "%1 threads speedup" ).arg( threads ), QString::number( (double)sequential / qMax( time, (qint64)1 ), 'f', 2 ) );
+
+            if ( fragments != expected )
+                report.addFailure( QString( "different summaries rendered using %1 threads" ).arg( threads ) );
+        }
+    }
+
+    report.beginSection( "Writing the full report" );
+
+    ReportGenerator generator;
+    generator.setFolderSource( folderId, issues );
+    generator.setSummaryMode( false, IssueDetailsGenerator::AllHistory );
+
+    HtmlWriter writer;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if ( !generator.write( &writer ) )
+        report.addFailure( "cannot write the report" );
+
+    report.addTime( "ReportGenerator", timer.nsecsElapsed() / 1000, issues.count() );
+    report.addValue( "HTML size", QString( "%1 kB" ).arg( writer.toHtml().toUtf8().size() / 1024 ) );
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    foreach ( int issueId, issues )
+        dataManager->unlockIssue( issueId );
+
+    environment.closeConnection();
+
+    return report.exitCode();
+}
@@ -0,0 +1,5 @@
+include( ../benchmarks.pri )
+
+TARGET = summaryreport
+
+SOURCES += main.cpp
@@ -0,0 +1,165 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "benchmarkenvironment.h"
+#include "benchmarkreport.h"
+#include "replaymanager.h"
+#include "syntheticserver.h"
+
+#include "application.h"
+#include "data/datamanager.h"
+#include "data/issuetypecache.h"
+#include "models/reportgenerator.h"
+#include "utils/csvwriter.h"
+#include "utils/htmlwriter.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+
+int main( int argc, char** argv )
+{
+    BenchmarkEnvironment environment( argc, argv );
+
+    Application application( environment.argc(), environment.argv(), true );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Measures generating table reports of a large list of issues." );
+    parser.addHelpOption();
+
+    QCommandLineOption issuesOption( "issues", "Number of rows in the report.", "count", "10000" );
+    parser.addOption( issuesOption );
+    QCommandLineOption attributesOption( "attributes", "Number of attributes of the issue type.", "count", "10" );
+    parser.addOption( attributesOption );
+
+    parser.process( environment.arguments() );
+
+    int issuesCount = parser.value( issuesOption ).toInt();
+    int attributesCount = parser.value( attributesOption ).toInt();
+
+    BenchmarkReport report( "Table report benchmark" );
+
+    SyntheticServer server;
+    server.setIssuesCount( issuesCount );
+    server.setAttributesCount( attributesCount );
+
+    ReplayManager manager( &server );
+
+    if ( !environment.openConnection( &manager ) || !environment.updateAll() ) {
+        report.addFailure( "cannot download the initial data" );
+        return report.exitCode();
+    }
+
+    int folderId = server.folders().first();
+    QList<int> issues = server.issues( folderId );
+
+    IssueTypeCache* cache = dataManager->issueTypeCache( 1 );
+    QList<int> columns = cache->availableColumns( false );
+
+    report.beginSection( QString( "Writing a table of %1 issues with %2 columns as HTML" ).arg( issues.count() ).arg( columns.count() ) );
+
+    QElapsedTimer timer;
+
+    QByteArray html;
+    {
+        ReportGenerator generator;
+        generator.setFolderSource( folderId, issues );
+        generator.setTableMode( columns );
+
+        HtmlWriter writer;
+        writer.setTitle( generator.title() );
+
+        timer.start();
+        if ( !generator.write( &writer ) )
+            report.addFailure( "cannot write the HTML report" );
+        report.addTime( "ReportGenerator", timer.nsecsElapsed() / 1000 );
+
+        timer.start();
+        html = writer.toUtf8();
+        report.addThroughput( "HtmlWriter::toUtf8()", timer.nsecsElapsed() / 1000, html.size() );
+
+        // the document used to be converted to a single string first
+        timer.start();
+        QByteArray converted = writer.toHtml().toUtf8();
+        report.addThroughput( "HtmlWriter::toHtml()", timer.nsecsElapsed() / 1000, converted.size() );
+
+        if ( converted != html )
+            report.addFailure( "different result of toUtf8() and toHtml()" );
+
+        report.addValue( "HTML size", QString( "%1 kB" ).arg( html.size() / 1024 ) );
+    }
+
+    report.beginSection( "Writing the HTML report to a file" );
+
+    {
+        QFile file( environment.path() + "/report.html" );
+        if ( !file.open( QIODevice::WriteOnly ) ) {
+            report.addFailure( "cannot create the HTML file" );
+            return report.exitCode();
+        }
+
+        ReportGenerator generator;
+        generator.setFolderSource( folderId, issues );
+        generator.setTableMode( columns );
+
+        HtmlWriter writer;
+        writer.setTitle( generator.title() );
+        writer.setDevice( &file );
+
+        timer.start();
+        if ( !generator.write( &writer ) )
+            report.addFailure( "cannot write the HTML file" );
+        writer.endDocument();
+        file.close();
+        report.addThroughput( "ReportGenerator", timer.nsecsElapsed() / 1000, file.size() );
+
+        if ( !file.open( QIODevice::ReadOnly ) || file.readAll() != html )
+            report.addFailure( "different contents of the HTML file" );
+    }
+
+    report.beginSection( "Writing the CSV report to a file" );
+
+    {
+        QFile file( environment.path() + "/report.csv" );
+        if ( !file.open( QIODevice::WriteOnly ) ) {
+            report.addFailure( "cannot create the CSV file" );
+            return report.exitCode();
+        }
+
+        ReportGenerator generator;
+        generator.setFolderSource( folderId, issues );
+        generator.setTableMode( columns );
+
+        CsvWriter writer;
+        writer.setDevice( &file );
+
+        timer.start();
+        if ( !generator.write( &writer ) )
+            report.addFailure( "cannot write the CSV file" );
+        file.close();
+        report.addThroughput( "ReportGenerator", timer.nsecsElapsed() / 1000, file.size() );
+    }
+
+    report.beginSection( "Memory" );
+    report.addPeakMemory();
+
+    environment.closeConnection();
+
+    return report.exitCode();
+}
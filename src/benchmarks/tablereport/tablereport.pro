@@ -0,0 +1,5 @@
+include( ../benchmarks.pri )
+
+TARGET = tablereport
+
+SOURCES += main.cpp
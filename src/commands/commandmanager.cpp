@@ -29,6 +29,7 @@
 #include "dialogs/logindialog.h"
 #include "dialogs/ssldialogs.h"
 #include "utils/errorhelper.h"
+#include "utils/profiler.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
@@ -47,6 +48,7 @@ CommandManager::CommandManager( QNetworkAccessManager* manager ) :
     m_currentMessage( NULL ),
     m_currentReply( NULL ),
     m_statusCode( 0 ),
+    m_requestStart( -1 ),
     m_error( NoError ),
     m_errorCode( 0 )
 {
@@ -109,6 +111,9 @@ void CommandManager::execute( AbstractBatch* batch )
     }
     m_batches.insert( pos, batch );
 
+    if ( Profiler::isEnabled() )
+        m_batchStarts.insert( batch, Profiler::timestamp() );
+
     checkPendingCommand();
 }
 
@@ -117,10 +122,11 @@ void CommandManager::abort( AbstractBatch* batch )
     if ( batch == m_currentBatch ) {
         m_currentReply->abort();
     } else {
-        setError( Aborted );
+        // do not fail the command which is currently executed
+        if ( !m_currentBatch )
+            setError( Aborted );
         m_batches.removeAt( m_batches.indexOf( batch ) );
-        QMetaObject::invokeMethod( batch, "completed", Q_ARG( bool, false ) );
-        delete batch;
+        completeBatch( batch, false );
     }
 }
 
@@ -133,8 +139,7 @@ void CommandManager::abortAll()
 
     while ( !m_batches.isEmpty() ) {
         AbstractBatch* batch = m_batches.takeFirst();
-        QMetaObject::invokeMethod( batch, "completed", Q_ARG( bool, false ) );
-        delete batch;
+        completeBatch( batch, false );
     }
 }
 
@@ -281,14 +286,29 @@ void CommandManager::checkPendingCommand()
         }
 
         m_batches.removeFirst();
-        QMetaObject::invokeMethod( batch, "completed", Q_ARG( bool, true ) );
-        delete batch;
+        completeBatch( batch, true );
 
         if ( m_currentBatch )
             break;
     }
 }
 
+void CommandManager::completeBatch( AbstractBatch* batch, bool successful )
+{
+    QMetaObject::invokeMethod( batch, "completed", Q_ARG( bool, successful ) );
+
+    // the batch is measured from queuing until all its commands are completed
+    if ( !m_batchStarts.isEmpty() ) {
+        QHash<AbstractBatch*, qint64>::iterator it = m_batchStarts.find( batch );
+        if ( it != m_batchStarts.end() ) {
+            Profiler::addEvent( batch->metaObject()->className(), it.value(), Profiler::timestamp() - it.value() );
+            m_batchStarts.erase( it );
+        }
+    }
+
+    delete batch;
+}
+
 static QString userAgent()
 {
     QString agent = "Mozilla/5.0 (";
@@ -349,6 +369,8 @@ void CommandManager::sendCommandRequest( Command* command )
     m_statusCode = 0;
     setError( NoError );
 
+    m_requestStart = Profiler::isEnabled() ? Profiler::timestamp() : -1;
+
     m_currentReply = m_manager->post( request, m_currentMessage );
 
     connect( m_currentReply, SIGNAL( downloadProgress( qint64, qint64 ) ), command, SIGNAL( downloadProgress( qint64, qint64 ) ) );
@@ -414,6 +436,12 @@ void CommandManager::finished( QNetworkReply* reply )
 
     m_currentReply = NULL;
 
+    // the request is measured from sending the command until the whole response is received
+    if ( m_requestStart >= 0 ) {
+        Profiler::addEvent( "CommandManager::request", m_requestStart, Profiler::timestamp() - m_requestStart );
+        m_requestStart = -1;
+    }
+
     if ( reply->error() != QNetworkReply::NoError ) {
         if ( reply->error() == QNetworkReply::OperationCanceledError )
             setError( Aborted );
@@ -434,6 +462,7 @@ void CommandManager::finished( QNetworkReply* reply )
 
     if ( m_error == NoError && m_contentType == "text/plain" ) {
         QByteArray body = reply->readAll();
+        Profiler::addCounter( "CommandManager::replySize", body.size() );
         Reply reply;
         if ( parseReply( QString::fromUtf8( body.data(), body.size() ), reply ) )
             handleCommandReply( reply );
@@ -443,8 +472,7 @@ void CommandManager::finished( QNetworkReply* reply )
 
     if ( m_error != NoError ) {
         m_batches.removeAt( m_batches.indexOf( m_currentBatch ) );
-        QMetaObject::invokeMethod( m_currentBatch, "completed", Q_ARG( bool, false ) );
-        delete m_currentBatch;
+        completeBatch( m_currentBatch, false );
     }
 
     m_currentCommand->deleteLater();
@@ -489,6 +517,8 @@ void CommandManager::handleCommandReply( const Reply& reply )
 
 bool CommandManager::parseReply( const QString& string, Reply& reply )
 {
+    ProfilerScope scope( "CommandManager::parseReply" );
+
     QStringList lines = string.split( "\r\n", QString::SkipEmptyParts );
 
     QString patternNumber = "-?\\d+";
@@ -523,6 +553,8 @@ bool CommandManager::parseReply( const QString& string, Reply& reply )
 
 bool CommandManager::validateReply( const Reply& reply )
 {
+    ProfilerScope scope( "CommandManager::validateReply" );
+
     int line = 0;
     int rule = 0;
 
@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QUrl>
 #include <QList>
+#include <QHash>
 #include <QSslConfiguration>
 
 class AbstractBatch;
@@ -113,6 +114,11 @@ public:
     */
     void abortAll();
 
+    /**
+    * Return @c true if a command of the batch is currently being executed.
+    */
+    bool isExecuting( AbstractBatch* batch ) const { return batch == m_currentBatch; }
+
     /**
     * Return @c true if any pending batch has the prevent close flag set.
     */
@@ -146,6 +152,8 @@ private:
 
     void handleCommandReply( const Reply& reply );
 
+    void completeBatch( AbstractBatch* batch, bool successful );
+
     bool parseReply( const QString& string, Reply& reply );
     bool validateReply( const Reply& reply );
 
@@ -186,6 +194,7 @@ private:
 #endif
 
     QList<AbstractBatch*> m_batches;
+    QHash<AbstractBatch*, qint64> m_batchStarts;
 
     QUrl m_url;
 
@@ -198,6 +207,8 @@ private:
     QUrl m_redirectionTarget;
     QByteArray m_contentType;
 
+    qint64 m_requestStart;
+
     QString m_protocolVersion;
 
     Error m_error;
@@ -31,7 +31,8 @@ IssueBatch::IssueBatch( int issueId ) : AbstractBatch( 0 ),
     m_update( false ),
     m_updateFolder( false ),
     m_file( NULL ),
-    m_fileError( QFile::NoError )
+    m_fileError( QFile::NoError ),
+    m_downloadSkipped( false )
 {
 }
 
@@ -41,7 +42,8 @@ IssueBatch::IssueBatch( int folderId, const QString& name ) : AbstractBatch( 0 )
     m_update( false ),
     m_updateFolder( false ),
     m_file( NULL ),
-    m_fileError( QFile::NoError )
+    m_fileError( QFile::NoError ),
+    m_downloadSkipped( false )
 {
     Job job( &IssueBatch::addIssueJob );
     job.addArg( folderId );
@@ -121,6 +123,12 @@ void IssueBatch::addAttachment( const QString& name, const QString& description,
 
 void IssueBatch::getAttachment( int fileId, const QString& path )
 {
+    if ( dataManager->setting( "file_hash" ) == QLatin1String( "sha1" ) ) {
+        Job job( &IssueBatch::getAttachmentHashJob );
+        job.addArg( fileId );
+        m_queue.addJob( job );
+    }
+
     Job job( &IssueBatch::getAttachmentJob );
     job.addArg( fileId );
     job.addArg( path );
@@ -185,8 +193,12 @@ Command* IssueBatch::fetchNext()
     delete m_file;
     m_file = NULL;
 
-    if ( m_queue.moreJobs() )
-        return m_queue.callJob( this );
+    // a job which is skipped returns no command without an error
+    while ( m_queue.moreJobs() ) {
+        Command* command = m_queue.callJob( this );
+        if ( command != NULL || m_fileError != QFile::NoError )
+            return command;
+    }
 
     if ( m_updateFolder ) {
         m_updateFolder = false;
@@ -352,8 +364,27 @@ Command* IssueBatch::addAttachmentJob( const Job& job )
     return command;
 }
 
+Command* IssueBatch::getAttachmentHashJob( const Job& job )
+{
+    Command* command = new Command();
+
+    command->setKeyword( "GET ATTACHMENT HASH" );
+    command->setArgs( job.args() );
+
+    command->addRule( "H s", ReplyRule::One );
+
+    connect( command, SIGNAL( commandReply( const Reply& ) ), this, SLOT( attachmentHashReply( const Reply& ) ) );
+
+    return command;
+}
+
 Command* IssueBatch::getAttachmentJob( const Job& job )
 {
+    if ( !m_fileHash.isEmpty() && !dataManager->findFileByHash( m_fileHash ).isEmpty() ) {
+        m_downloadSkipped = true;
+        return NULL;
+    }
+
     QString path = job.argString( 1 );
 
     m_file = new QFile( path );
@@ -459,6 +490,12 @@ void IssueBatch::addIssueReply( const Reply& reply )
     m_updateFolder = true;
 }
 
+void IssueBatch::attachmentHashReply( const Reply& reply )
+{
+    ReplyLine line = reply.lines().at( 0 );
+    m_fileHash = line.argString( 0 ).toLatin1().toLower();
+}
+
 void IssueBatch::uploadProgress( qint64 /*done*/, qint64 /*total*/ )
 {
     emit uploadProgress( (int)m_file->pos() );
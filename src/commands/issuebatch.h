@@ -115,6 +115,9 @@ public:
 
     /**
     * Add the <tt>GET ATTACHMENT</tt> command to the batch.
+    * If the server reports hashes of files, the <tt>GET ATTACHMENT HASH</tt>
+    * command is executed first and the download is skipped when a file with
+    * identical content is already cached.
     * @param fileId Identifier of the file to download.
     * @param path Path of the downloaded file.
     */
@@ -179,6 +182,18 @@ public:
     */
     int fileError() const { return m_fileError; }
 
+    /**
+    * Return the hash of the downloaded file reported by the server.
+    * The hash is empty if the server doesn't support the <tt>GET ATTACHMENT HASH</tt> command.
+    */
+    const QByteArray& fileHash() const { return m_fileHash; }
+
+    /**
+    * Return @c true if the download was skipped because the file is already cached.
+    * In that case the file is not created.
+    */
+    bool isDownloadSkipped() const { return m_downloadSkipped; }
+
 signals:
     /**
     * Emitted while uploading an attachment.
@@ -211,6 +226,7 @@ private:
     Command* deleteCommentJob( const Job& job );
 
     Command* addAttachmentJob( const Job& job );
+    Command* getAttachmentHashJob( const Job& job );
     Command* getAttachmentJob( const Job& job );
     Command* editAttachmentJob( const Job& job );
     Command* deleteAttachmentJob( const Job& job );
@@ -221,6 +237,7 @@ private:
 
 private slots:
     void addIssueReply( const Reply& reply );
+    void attachmentHashReply( const Reply& reply );
 
     void uploadProgress( qint64 done, qint64 total );
     void downloadProgress( qint64 done, qint64 total );
@@ -238,6 +255,9 @@ private:
 
     QFile* m_file;
     int m_fileError;
+
+    QByteArray m_fileHash;
+    bool m_downloadSkipped;
 };
 
 #endif
@@ -6,10 +6,14 @@ HEADERS += data/bookmark.h \
            data/entities.h \
            data/entities_p.h \
            data/filecache.h \
+           data/issuebatch.h \
            data/issuetypecache.h \
            data/localsettings.h \
            data/query.h \
-           data/updateevent.h
+           data/querythread.h \
+           data/threadconnection.h \
+           data/updateevent.h \
+           data/viewplan.h
 
 SOURCES += data/bookmark.cpp \
            data/bookmarksstore.cpp \
@@ -18,10 +22,14 @@ SOURCES += data/bookmark.cpp \
            data/datamanager.cpp \
            data/entities.cpp \
            data/filecache.cpp \
+           data/issuebatch.cpp \
            data/issuetypecache.cpp \
            data/localsettings.cpp \
            data/query.cpp \
-           data/updateevent.cpp
+           data/querythread.cpp \
+           data/threadconnection.cpp \
+           data/updateevent.cpp \
+           data/viewplan.cpp
 
 contains( QT_CONFIG, openssl ) | contains( QT_CONFIG, openssl-linked ) | contains( QT_CONFIG, ssl ) {
     HEADERS += data/certificatesstore.h
@@ -28,10 +28,14 @@
 #include "data/query.h"
 #include "models/querygenerator.h"
 #include "sqlite/sqlitedriver.h"
+#include "utils/profiler.h"
 
 #include <QSqlDatabase>
 #include <QFile>
+#include <QLockFile>
 #include <QStringList>
+#include <QSet>
+#include <QTimer>
 
 DataManager* dataManager = NULL;
 
@@ -40,16 +44,21 @@ DataManager::DataManager() :
     m_currentUserId( 0 ),
     m_currentUserAccess( NoAccess ),
     m_connectionSettings( NULL ),
-    m_fileCache( NULL )
+    m_fileCache( NULL ),
+    m_lockFile( NULL ),
+    m_flushScheduled( false )
 {
 }
 
 DataManager::~DataManager()
 {
     if ( m_valid ) {
+        flushCommentsHtml();
         clearIssueLocks();
         closeDatabase();
     }
+
+    qDeleteAll( m_pendingEvents );
 }
 
 static int parseVersion( const QString& version )
@@ -124,28 +133,85 @@ void DataManager::addObserver( QObject* observer )
 void DataManager::removeObserver( QObject* observer )
 {
     m_observers.removeAt( m_observers.indexOf( observer ) );
+    m_subscriptions.remove( observer );
+
+    delete m_pendingEvents.take( observer );
+}
+
+void DataManager::subscribe( QObject* observer, UpdateEvent::Unit unit, int id )
+{
+    if ( !m_subscriptions[ observer ].contains( unit, id ) )
+        m_subscriptions[ observer ].insert( unit, id );
+}
+
+void DataManager::clearSubscriptions( QObject* observer )
+{
+    m_subscriptions.remove( observer );
 }
 
 void DataManager::notifyObservers( UpdateEvent::Unit unit, int id )
 {
     for ( int i = 0; i < m_observers.count(); i++ ) {
-        UpdateEvent* updateEvent = new UpdateEvent( unit, id );
-        QApplication::postEvent( m_observers.at( i ), updateEvent );
+        QObject* observer = m_observers.at( i );
+
+        QHash<QObject*, QMultiMap<UpdateEvent::Unit, int> >::const_iterator it = m_subscriptions.find( observer );
+        if ( it != m_subscriptions.constEnd() && !it.value().contains( unit, 0 ) && !it.value().contains( unit, id ) )
+            continue;
+
+        UpdateEvent*& updateEvent = m_pendingEvents[ observer ];
+        if ( !updateEvent )
+            updateEvent = new UpdateEvent( unit, id );
+        else
+            updateEvent->add( unit, id );
+
+        // all notifications sent while processing the current event are delivered in a single event
+        if ( !m_flushScheduled ) {
+            QTimer::singleShot( 0, this, SLOT( flushObservers() ) );
+            m_flushScheduled = true;
+        }
+    }
+}
+
+void DataManager::flushObservers()
+{
+    m_flushScheduled = false;
+
+    Profiler::addCounter( "DataManager::notifiedObservers", m_pendingEvents.count() );
+
+    // post events in the order in which observers were added
+    for ( int i = 0; i < m_observers.count() && !m_pendingEvents.isEmpty(); i++ ) {
+        QObject* observer = m_observers.at( i );
+        UpdateEvent* updateEvent = m_pendingEvents.take( observer );
+        if ( updateEvent )
+            QApplication::postEvent( observer, updateEvent );
     }
 }
 
 bool DataManager::openDatabase()
 {
+    QString path = locateCacheFile( "cache.db" );
+
+    if ( !lockDatabase( path ) )
+        return false;
+
     QSqlDatabase database = QSqlDatabase::addDatabase( new SQLiteDriver() );
 
-    database.setDatabaseName( locateCacheFile( "cache.db" ) );
+    database.setDatabaseName( path );
 
-    if ( !database.open() )
+    if ( !database.open() ) {
+        unlockDatabase();
         return false;
+    }
 
-    if ( !lockDatabase( database ) ) {
-        database.close();
-        return false;
+    // background threads read the database through their own connections
+    // and see the last committed snapshot while replies are being written
+    {
+        Query query( database );
+        if ( !query.execQuery( "PRAGMA journal_mode = WAL" ) ) {
+            database.close();
+            unlockDatabase();
+            return false;
+        }
     }
 
     database.transaction();
@@ -157,28 +223,37 @@ bool DataManager::openDatabase()
     if ( !ok ) {
         database.rollback();
         database.close();
+        unlockDatabase();
     }
 
     return ok;
 }
 
-bool DataManager::lockDatabase( const QSqlDatabase& database )
+bool DataManager::lockDatabase( const QString& path )
 {
-    Query query( database );
+    // the database itself cannot be locked exclusively because it is also
+    // read by background threads; a lock file prevents other instances from using it
+    m_lockFile = new QLockFile( path + ".lock" );
+    m_lockFile->setStaleLockTime( 0 );
 
-    if ( !query.execQuery( "PRAGMA locking_mode = EXCLUSIVE" ) )
-        return false;
-    if ( !query.execQuery( "BEGIN EXCLUSIVE" ) )
-        return false;
-    if ( !query.execQuery( "COMMIT" ) )
+    if ( !m_lockFile->tryLock() ) {
+        delete m_lockFile;
+        m_lockFile = NULL;
         return false;
+    }
 
     return true;
 }
 
+void DataManager::unlockDatabase()
+{
+    delete m_lockFile;
+    m_lockFile = NULL;
+}
+
 bool DataManager::installSchema( QSqlDatabase& database )
 {
-    const int schemaVersion = 6;
+    const int schemaVersion = 8;
     const int minSchemaVersion = 3;
 
     Query query( database );
@@ -216,9 +291,11 @@ bool DataManager::installSchema( QSqlDatabase& database )
                 "modified_time integer, modified_user_id integer, attr_id integer, old_value text, new_value text, from_folder_id integer, to_folder_id integer )",
             "CREATE INDEX changes_issue_idx ON changes ( issue_id )",
             "CREATE TABLE comments ( comment_id integer UNIQUE, comment_text text, comment_format integer )",
+            "CREATE TABLE comments_cache ( comment_id integer UNIQUE, stamp_id integer, comment_html text )",
             "CREATE TABLE files ( file_id integer UNIQUE, file_name text, file_size integer, file_descr text )",
             "CREATE TABLE folders ( folder_id integer UNIQUE, project_id integer, folder_name text, type_id integer, stamp_id integer )",
             "CREATE TABLE folders_cache ( folder_id integer UNIQUE, list_id integer )",
+            "CREATE INDEX folders_cache_list_idx ON folders_cache ( folder_id, list_id )",
             "CREATE TABLE issue_descriptions ( issue_id integer UNIQUE, descr_text text, descr_format integer, modified_time integer, modified_user_id integer )",
             "CREATE TABLE issue_locks ( issue_id integer UNIQUE, lock_count integer, last_access integer )",
             "CREATE TABLE issue_states ( user_id integer, issue_id integer, read_id integer, subscription_id integer, UNIQUE ( user_id, issue_id ) )",
@@ -227,6 +304,7 @@ bool DataManager::installSchema( QSqlDatabase& database )
                 "modified_time integer, modified_user_id integer )",
             "CREATE INDEX issues_folder_idx ON issues ( folder_id )",
             "CREATE TABLE issues_cache ( issue_id integer UNIQUE, details_id integer )",
+            "CREATE INDEX issues_cache_details_idx ON issues_cache ( issue_id, details_id )",
             "CREATE TABLE languages ( lang_code text, lang_name text )",
             "CREATE TABLE preferences ( user_id integer, pref_key text, pref_value text, UNIQUE ( user_id, pref_key ) )",
             "CREATE TABLE project_descriptions ( project_id integer UNIQUE, descr_text text, descr_format integer, modified_time integer, modified_user_id integer )",
@@ -283,6 +361,18 @@ bool DataManager::installSchema( QSqlDatabase& database )
             return false;
     }
 
+    if ( currentVersion < 7 ) {
+        if ( !query.execQuery( "CREATE TABLE comments_cache ( comment_id integer UNIQUE, stamp_id integer, comment_html text )" ) )
+            return false;
+    }
+
+    if ( currentVersion < 8 ) {
+        if ( !query.execQuery( "CREATE INDEX folders_cache_list_idx ON folders_cache ( folder_id, list_id )" ) )
+            return false;
+        if ( !query.execQuery( "CREATE INDEX issues_cache_details_idx ON issues_cache ( issue_id, details_id )" ) )
+            return false;
+    }
+
     QString sql = QString( "PRAGMA user_version = %1" ).arg( schemaVersion );
 
     if ( !query.execQuery( sql ) )
@@ -293,8 +383,12 @@ bool DataManager::installSchema( QSqlDatabase& database )
 
 void DataManager::closeDatabase()
 {
-    QSqlDatabase database = QSqlDatabase::database();
-    database.close();
+    {
+        QSqlDatabase database = QSqlDatabase::database();
+        database.close();
+    }
+
+    unlockDatabase();
 }
 
 bool DataManager::summaryUpdateNeeded( int projectId ) const
@@ -302,23 +396,18 @@ bool DataManager::summaryUpdateNeeded( int projectId ) const
     QSqlDatabase database = QSqlDatabase::database();
     Query query( database );
 
-    if ( !query.execQuery( "SELECT stamp_id FROM projects WHERE project_id = ?", projectId ) )
+    if ( !query.execQuery( "SELECT p.stamp_id, pc.summary_id FROM projects AS p"
+        " LEFT OUTER JOIN projects_cache AS pc ON pc.project_id = p.project_id"
+        " WHERE p.project_id = ?", projectId ) )
         return false;
 
-    int stampId = query.readScalar().toInt();
-
-    if ( stampId == 0 )
-        return false;
-
-    if ( !query.execQuery( "SELECT summary_id FROM projects_cache WHERE project_id = ?", projectId ) )
+    if ( !query.next() )
         return false;
 
-    int lastStampId = query.readScalar().toInt();
+    int stampId = query.value( 0 ).toInt();
+    int lastStampId = query.value( 1 ).toInt();
 
-    if ( stampId > lastStampId )
-        return true;
-
-    return false;
+    return stampId > 0 && stampId > lastStampId;
 }
 
 bool DataManager::folderUpdateNeeded( int folderId ) const
@@ -326,47 +415,93 @@ bool DataManager::folderUpdateNeeded( int folderId ) const
     QSqlDatabase database = QSqlDatabase::database();
     Query query( database );
 
-    if ( !query.execQuery( "SELECT stamp_id FROM folders WHERE folder_id = ?", folderId ) )
+    if ( !query.execQuery( "SELECT f.stamp_id, fc.list_id FROM folders AS f"
+        " LEFT OUTER JOIN folders_cache AS fc ON fc.folder_id = f.folder_id"
+        " WHERE f.folder_id = ?", folderId ) )
         return false;
 
-    int stampId = query.readScalar().toInt();
-
-    if ( stampId == 0 )
+    if ( !query.next() )
         return false;
 
-    if ( !query.execQuery( "SELECT list_id FROM folders_cache WHERE folder_id = ?", folderId ) )
-        return false;
+    int stampId = query.value( 0 ).toInt();
+    int lastStampId = query.value( 1 ).toInt();
 
-    int lastStampId = query.readScalar().toInt();
+    return stampId > 0 && stampId > lastStampId;
+}
+
+bool DataManager::issueUpdateNeeded( int issueId ) const
+{
+    QSqlDatabase database = QSqlDatabase::database();
+    Query query( database );
+
+    if ( !query.execQuery( "SELECT i.stamp_id, ic.details_id FROM issues AS i"
+        " LEFT OUTER JOIN issues_cache AS ic ON ic.issue_id = i.issue_id"
+        " WHERE i.issue_id = ?", issueId ) )
+        return false;
 
-    if ( stampId > lastStampId )
+    // an issue which is not in the database yet needs updating
+    if ( !query.next() )
         return true;
 
-    return false;
+    int stampId = query.value( 0 ).toInt();
+    int lastStampId = query.value( 1 ).toInt();
+
+    return stampId == 0 || stampId > lastStampId;
 }
 
-bool DataManager::issueUpdateNeeded( int issueId ) const
+QList<int> DataManager::staleFolders() const
 {
     QSqlDatabase database = QSqlDatabase::database();
     Query query( database );
 
-    if ( !query.execQuery( "SELECT stamp_id FROM issues WHERE issue_id = ?", issueId ) )
-        return false;
+    QList<int> result;
 
-    int stampId = query.readScalar().toInt();
+    if ( !query.execQuery( "SELECT f.folder_id FROM folders AS f"
+        " LEFT OUTER JOIN folders_cache AS fc ON fc.folder_id = f.folder_id"
+        " WHERE f.stamp_id > 0 AND f.stamp_id > COALESCE( fc.list_id, 0 )" ) )
+        return result;
 
-    if ( stampId == 0 )
-        return true;
+    while ( query.next() )
+        result.append( query.value( 0 ).toInt() );
 
-    if ( !query.execQuery( "SELECT details_id FROM issues_cache WHERE issue_id = ?", issueId ) )
-        return false;
+    return result;
+}
 
-    int lastStampId = query.readScalar().toInt();
+QList<int> DataManager::staleIssues( const QList<int>& issues ) const
+{
+    QList<int> result;
 
-    if ( stampId > lastStampId )
-        return true;
+    if ( issues.isEmpty() )
+        return result;
+
+    QStringList ids;
+    foreach ( int issueId, issues )
+        ids.append( QString::number( issueId ) );
+
+    QSqlDatabase database = QSqlDatabase::database();
+    Query query( database );
+
+    if ( !query.execQuery( QString( "SELECT i.issue_id, i.stamp_id, ic.details_id FROM issues AS i"
+        " LEFT OUTER JOIN issues_cache AS ic ON ic.issue_id = i.issue_id"
+        " WHERE i.issue_id IN ( %1 )" ).arg( ids.join( "," ) ) ) )
+        return result;
+
+    QSet<int> freshIssues;
+
+    while ( query.next() ) {
+        int stampId = query.value( 1 ).toInt();
+        int lastStampId = query.value( 2 ).toInt();
+        if ( stampId > 0 && stampId <= lastStampId )
+            freshIssues.insert( query.value( 0 ).toInt() );
+    }
+
+    // issues which are not in the database yet also need updating
+    foreach ( int issueId, issues ) {
+        if ( !freshIssues.contains( issueId ) )
+            result.append( issueId );
+    }
 
-    return false;
+    return result;
 }
 
 Command* DataManager::hello()
@@ -384,6 +519,8 @@ Command* DataManager::hello()
 
 void DataManager::helloReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::helloReply" );
+
     m_serverName = reply.at( 0 ).argString( 0 );
     m_serverUuid = reply.at( 0 ).argString( 1 );
     m_serverVersion = reply.at( 0 ).argString( 2 );
@@ -439,6 +576,8 @@ Command* DataManager::loginNew( const QString& login, const QString& password, c
 
 void DataManager::loginReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::loginReply" );
+
     m_currentUserId = reply.at( 0 ).argInt( 0 );
     m_currentUserName = reply.at( 0 ).argString( 1 );
     m_currentUserAccess = (Access)reply.at( 0 ).argInt( 2 );
@@ -464,6 +603,8 @@ Command* DataManager::updateSettings()
 
 void DataManager::updateSettingsReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateSettingsReply" );
+
     QSqlDatabase database = QSqlDatabase::database();
     database.transaction();
 
@@ -538,6 +679,8 @@ Command* DataManager::updateUsers()
 
 void DataManager::updateUsersReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateUsersReply" );
+
     QSqlDatabase database = QSqlDatabase::database();
     database.transaction();
 
@@ -614,6 +757,8 @@ Command* DataManager::updateTypes()
 
 void DataManager::updateTypesReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateTypesReply" );
+
     QSqlDatabase database = QSqlDatabase::database();
     database.transaction();
 
@@ -702,6 +847,8 @@ Command* DataManager::updateProjects()
 
 void DataManager::updateProjectsReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateProjectsReply" );
+
     QSqlDatabase database = QSqlDatabase::database();
     database.transaction();
 
@@ -783,6 +930,8 @@ Command* DataManager::updateStates()
 
 void DataManager::updateStatesReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateStatesReply" );
+
     Command* command = static_cast<Command*>( sender() );
     int lastStateId = command->argInt( 0 );
 
@@ -804,12 +953,19 @@ bool DataManager::updateStatesReply( const Reply& reply, int lastStateId, const
 {
     Query query( database );
 
+    // the initial list contains all states, so it's faster to recalculate all alerts
+    bool initial = lastStateId == 0;
+
     query.setQuery( "INSERT OR REPLACE INTO issue_states VALUES ( ?, ?, ?, ? )" );
 
+    QList<int> issues;
+
     for ( int i = 0; i < reply.count(); i++ ) {
         if ( !query.exec( m_currentUserId, reply.at( i ).arg( 1 ), reply.at( i ).arg( 2 ), reply.at( i ).arg( 3 ) ) )
             return false;
 
+        issues.append( reply.at( i ).argInt( 1 ) );
+
         int stateId = reply.at( i ).argInt( 0 );
         if ( stateId > lastStateId )
             lastStateId = stateId;
@@ -818,8 +974,14 @@ bool DataManager::updateStatesReply( const Reply& reply, int lastStateId, const
     if ( !query.execQuery( "INSERT OR REPLACE INTO users_cache VALUES ( ?, ? )", m_currentUserId, lastStateId ) )
         return false;
 
-    if ( !recalculateAllAlerts( database ) )
-        return false;
+    if ( initial ) {
+        if ( !recalculateAllAlerts( database ) )
+            return false;
+    } else if ( !issues.isEmpty() ) {
+        // only alerts of folders and global lists containing issues whose states changed are affected
+        if ( !recalculateIssueAlerts( issues, database ) )
+            return false;
+    }
 
     return true;
 }
@@ -852,6 +1014,8 @@ Command* DataManager::updateSummary( int projectId )
 
 void DataManager::updateSummaryReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateSummaryReply" );
+
     int projectId;
 
     QSqlDatabase database = QSqlDatabase::database();
@@ -928,6 +1092,8 @@ Command* DataManager::updateFolder( int folderId )
 
 void DataManager::updateFolderReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateFolderReply" );
+
     QList<int> updatedFolders;
 
     QSqlDatabase database = QSqlDatabase::database();
@@ -1083,6 +1249,8 @@ Command* DataManager::updateIssue( int issueId, bool markAsRead )
 
 void DataManager::updateIssueReply( const Reply& reply )
 {
+    ProfilerScope scope( "DataManager::updateIssueReply" );
+
     QList<int> updatedFolders;
     int issueId;
 
@@ -1183,9 +1351,13 @@ bool DataManager::updateIssueReply( const Reply& reply, const QSqlDatabase& data
 
     query.setQuery( "INSERT OR REPLACE INTO comments VALUES ( ?, ?, ? )" );
 
+    Query deleteCommentHtmlQuery( "DELETE FROM comments_cache WHERE comment_id = ?", database );
+
     for ( ; i < reply.count() && reply.at( i ).keyword() == QLatin1String( "C" ); i++ ) {
         if ( !query.exec( reply.at( i ).args() ) )
             return false;
+        if ( !deleteCommentHtmlQuery.exec( reply.at( i ).argInt( 0 ) ) )
+            return false;
     }
 
     query.setQuery( "INSERT OR REPLACE INTO files VALUES ( ?, ?, ?, ? )" );
@@ -1212,6 +1384,8 @@ bool DataManager::updateIssueReply( const Reply& reply, const QSqlDatabase& data
             if ( changeType == CommentAdded ) {
                 if ( !deleteCommentQuery.exec( changeId ) )
                     return false;
+                if ( !deleteCommentHtmlQuery.exec( changeId ) )
+                    return false;
             } else if ( changeType == FileAdded ) {
                 if ( !deleteFileQuery.exec( changeId ) )
                     return false;
@@ -1222,6 +1396,14 @@ bool DataManager::updateIssueReply( const Reply& reply, const QSqlDatabase& data
         }
     }
 
+    // details of issues which are not opened, for example prefetched ones, are also limited by flushIssueDetails()
+    if ( !query.execQuery( "INSERT OR IGNORE INTO issue_locks VALUES ( ?, 0, strftime( '%s', 'now' ) )", issueId ) )
+        return false;
+
+    // refreshed details are the most recently used ones and are flushed last
+    if ( !query.execQuery( "UPDATE issue_locks SET last_access = strftime( '%s', 'now' ) WHERE issue_id = ? AND lock_count = 0", issueId ) )
+        return false;
+
     if ( !flushIssueDetails( database ) )
         return false;
 
@@ -1369,6 +1551,13 @@ bool DataManager::removeIssueDetails( const QList<int>& issues, const QSqlDataba
             return false;
     }
 
+    query.setQuery( "DELETE FROM comments_cache WHERE comment_id IN ( SELECT change_id FROM changes WHERE issue_id = ? )" );
+
+    foreach ( int issueId, issues ) {
+        if ( !query.exec( issueId ) )
+            return false;
+    }
+
     query.setQuery( "DELETE FROM files WHERE file_id IN ( SELECT change_id FROM changes WHERE issue_id = ? )" );
 
     foreach ( int issueId, issues ) {
@@ -1415,9 +1604,53 @@ void DataManager::allocFileSpace( int size )
     m_fileCache->allocFileSpace( size );
 }
 
-void DataManager::commitFile( int fileId, const QString& path, int size )
+QString DataManager::findFileByHash( const QByteArray& hash ) const
 {
-    m_fileCache->commitFile( fileId, path, size );
+    return m_fileCache->findFileByHash( hash );
+}
+
+QString DataManager::commitFile( int fileId, const QString& path, int size, const QByteArray& hash )
+{
+    return m_fileCache->commitFile( fileId, path, size, hash );
+}
+
+void DataManager::cacheCommentHtml( int commentId, int stampId, const QString& html )
+{
+    // write all comments converted while processing the current event in a single transaction
+    if ( m_pendingCommentsHtml.isEmpty() )
+        QTimer::singleShot( 0, this, SLOT( flushCommentsHtml() ) );
+
+    m_pendingCommentsHtml.append( QVariantList() << commentId << stampId << html );
+}
+
+void DataManager::flushCommentsHtml()
+{
+    if ( m_pendingCommentsHtml.isEmpty() )
+        return;
+
+    QSqlDatabase database = QSqlDatabase::database();
+    database.transaction();
+
+    bool ok = flushCommentsHtml( database );
+    if ( ok )
+        ok = database.commit();
+
+    if ( !ok )
+        database.rollback();
+
+    m_pendingCommentsHtml.clear();
+}
+
+bool DataManager::flushCommentsHtml( const QSqlDatabase& database )
+{
+    Query query( "INSERT OR REPLACE INTO comments_cache VALUES ( ?, ?, ? )", database );
+
+    foreach ( const QVariantList& row, m_pendingCommentsHtml ) {
+        if ( !query.exec( row ) )
+            return false;
+    }
+
+    return true;
 }
 
 bool DataManager::recalculateAllAlerts( const QSqlDatabase& database )
@@ -1446,6 +1679,44 @@ bool DataManager::recalculateAllAlerts( const QSqlDatabase& database )
     return true;
 }
 
+bool DataManager::recalculateIssueAlerts( const QList<int>& issues, const QSqlDatabase& database )
+{
+    const int chunkSize = 500;
+
+    QSet<int> folders;
+    QSet<int> types;
+
+    Query query( database );
+
+    for ( int i = 0; i < issues.count(); i += chunkSize ) {
+        QStringList ids;
+        foreach ( int issueId, issues.mid( i, chunkSize ) )
+            ids.append( QString::number( issueId ) );
+
+        if ( !query.execQuery( QString( "SELECT DISTINCT f.folder_id, f.type_id FROM issues AS i"
+            " JOIN folders AS f ON f.folder_id = i.folder_id"
+            " WHERE i.issue_id IN ( %1 )" ).arg( ids.join( "," ) ) ) )
+            return false;
+
+        while ( query.next() ) {
+            folders.insert( query.value( 0 ).toInt() );
+            types.insert( query.value( 1 ).toInt() );
+        }
+    }
+
+    foreach ( int folderId, folders ) {
+        if ( !recalculateAlerts( folderId, database ) )
+            return false;
+    }
+
+    foreach ( int typeId, types ) {
+        if ( !recalculateGlobalAlerts( typeId, database ) )
+            return false;
+    }
+
+    return true;
+}
+
 bool DataManager::recalculateAlerts( int folderId, const QSqlDatabase& database )
 {
     Query query( database );
@@ -25,6 +25,7 @@
 
 #include <QObject>
 #include <QHash>
+#include <QVariant>
 
 class Command;
 class Reply;
@@ -33,6 +34,7 @@ class IssueTypeCache;
 class FileCache;
 
 class QSqlDatabase;
+class QLockFile;
 
 /**
 * Access level for user or member.
@@ -288,6 +290,7 @@ public:
     /**
     * Add a data observer.
     * The observer receives UpdateEvent events when a unit of data is updated.
+    * Updates made while processing a single event are merged into one UpdateEvent.
     */
     void addObserver( QObject* observer );
 
@@ -296,6 +299,22 @@ public:
     */
     void removeObserver( QObject* observer );
 
+    /**
+    * Subscribe the observer to updates of the given unit of data.
+    * An observer which has no subscriptions receives all updates.
+    * @param observer The data observer.
+    * @param unit The unit of data to receive.
+    * @param id Identifier of the folder, issue or project to receive
+    * or 0 to receive updates for all identifiers.
+    */
+    void subscribe( QObject* observer, UpdateEvent::Unit unit, int id = 0 );
+
+    /**
+    * Remove all subscriptions of the observer.
+    * The observer receives all updates again.
+    */
+    void clearSubscriptions( QObject* observer );
+
     /**
     * Check if the project summary needs updating.
     * @param projectId Identifier of the project.
@@ -321,6 +340,21 @@ public:
     */
     bool issueUpdateNeeded( int issueId ) const;
 
+    /**
+    * Return the folders which need updating.
+    * This method compares the stamps of folders with the stamps of the last
+    * updates of their issues using a single query.
+    * @return Identifiers of the folders.
+    */
+    QList<int> staleFolders() const;
+
+    /**
+    * Return the issues which need updating.
+    * @param issues Identifiers of the issues to check.
+    * @return Identifiers of the issues which need updating, in the same order.
+    */
+    QList<int> staleIssues( const QList<int>& issues ) const;
+
     /**
     * Create a HELLO command.
     */
@@ -414,13 +448,33 @@ public:
     */
     void allocFileSpace( int size );
 
+    /**
+    * Locate a cached file with the given content.
+    * @param hash The SHA-1 hash of the content in hexadecimal format.
+    * @return Path of the file or empty string if it is not cached.
+    */
+    QString findFileByHash( const QByteArray& hash ) const;
+
     /**
     * Add the file to the cache.
     * @param fileId Identifier of the file.
     * @parm path Path of the file in the cache.
     * @param size Size of the file in bytes.
+    * @param hash The hash of the content reported by the server, if any.
+    * @return Path of the cached file, which may be different if a file
+    * with identical content was already cached, or an empty string if
+    * the file doesn't exist.
+    */
+    QString commitFile( int fileId, const QString& path, int size, const QByteArray& hash = QByteArray() );
+
+    /**
+    * Store HTML converted from a comment with markup in the cache.
+    * The HTML is written to the database in batches.
+    * @param commentId Identifier of the comment.
+    * @param stampId Stamp of the comment which was converted.
+    * @param html The converted HTML.
     */
-    void commitFile( int fileId, const QString& path, int size );
+    void cacheCommentHtml( int commentId, int stampId, const QString& html );
 
 private slots:
     void helloReply( const Reply& reply );
@@ -434,13 +488,19 @@ private slots:
     void updateFolderReply( const Reply& reply );
     void updateIssueReply( const Reply& reply );
 
+    void flushCommentsHtml();
+
+    void flushObservers();
+
 private:
     void notifyObservers( UpdateEvent::Unit unit, int id = 0 );
 
     bool openDatabase();
     void closeDatabase();
 
-    bool lockDatabase( const QSqlDatabase& database );
+    bool lockDatabase( const QString& path );
+    void unlockDatabase();
+
     bool installSchema( QSqlDatabase& database );
 
     bool updateSettingsReply( const Reply& reply, const QSqlDatabase& database );
@@ -462,7 +522,10 @@ private:
     bool flushIssueDetails( const QSqlDatabase& database );
     bool removeIssueDetails( const QList<int>& issues, const QSqlDatabase& database );
 
+    bool flushCommentsHtml( const QSqlDatabase& database );
+
     bool recalculateAllAlerts( const QSqlDatabase& database );
+    bool recalculateIssueAlerts( const QList<int>& issues, const QSqlDatabase& database );
     bool recalculateAlerts( int folderId, const QSqlDatabase& database );
     bool recalculateGlobalAlerts( int typeId, const QSqlDatabase& database );
     bool recalculateAlert( int alertId, int folderId, int typeId, int viewId, const QSqlDatabase& database );
@@ -492,11 +555,18 @@ private:
 
     FileCache* m_fileCache;
 
+    QLockFile* m_lockFile;
+
     DefinitionInfo m_numberFormat;
     DefinitionInfo m_dateFormat;
     DefinitionInfo m_timeFormat;
 
+    QList<QVariantList> m_pendingCommentsHtml;
+
     QList<QObject*> m_observers;
+    QHash<QObject*, QMultiMap<UpdateEvent::Unit, int> > m_subscriptions;
+    QHash<QObject*, UpdateEvent*> m_pendingEvents;
+    bool m_flushScheduled;
 };
 
 /**
@@ -1647,6 +1647,11 @@ TextFormat CommentEntity::format() const
     return d->m_format;
 }
 
+const QString& CommentEntity::html() const
+{
+    return d->m_html;
+}
+
 void CommentEntityData::read( const Query& query )
 {
     m_id = query.value( 0 ).toInt();
@@ -1868,6 +1873,7 @@ CommentEntity ChangeEntity::comment() const
         entity.d->m_id = d->m_id;
         entity.d->m_text = d->m_commentText;
         entity.d->m_format = d->m_commentFormat;
+        entity.d->m_html = d->m_commentHtml;
     }
 
     return entity;
@@ -1907,7 +1913,7 @@ QList<ChangeEntity> IssueEntityData::changes( bool all, Qt::SortOrder order ) co
             " ch.modified_time, um.user_name AS modified_user, ch.modified_user_id,"
             " a.attr_id, ch.old_value, ch.new_value, fp.project_name AS from_project, ff.folder_name AS from_folder,"
             " tp.project_name AS to_project, tf.folder_name AS to_folder,"
-            " c.comment_text, c.comment_format, f.file_name, f.file_size, f.file_descr"
+            " c.comment_text, c.comment_format, f.file_name, f.file_size, f.file_descr, cc.comment_html"
             " FROM changes AS ch"
             " LEFT OUTER JOIN users AS uc ON uc.user_id = ch.created_user_id"
             " LEFT OUTER JOIN users AS um ON um.user_id = ch.modified_user_id"
@@ -1918,6 +1924,7 @@ QList<ChangeEntity> IssueEntityData::changes( bool all, Qt::SortOrder order ) co
             " LEFT OUTER JOIN projects AS tp ON tp.project_id = tf.project_id"
             " LEFT OUTER JOIN comments AS c ON c.comment_id = ch.change_id AND ch.change_type = ?"
             " LEFT OUTER JOIN files AS f ON f.file_id = ch.change_id AND ch.change_type = ?"
+            " LEFT OUTER JOIN comments_cache AS cc ON cc.comment_id = c.comment_id AND cc.stamp_id = ch.stamp_id"
             " WHERE ch.issue_id = ?";
         if ( !all )
             sql += " AND ( c.comment_id IS NOT NULL OR f.file_id IS NOT NULL )";
@@ -1965,6 +1972,7 @@ void ChangeEntityData::read( const Query& query )
     if ( m_type == CommentAdded ) {
         m_commentText = query.value( 17 ).toString();
         m_commentFormat = (TextFormat)query.value( 18 ).toInt();
+        m_commentHtml = query.value( 22 ).toString();
     }
     if ( m_type == FileAdded ) {
         m_fileName = query.value( 19 ).toString();
@@ -1981,11 +1989,12 @@ ChangeEntity ChangeEntity::findComment( int id )
         Query query( "SELECT ch.change_id, ch.issue_id, ch.stamp_id,"
             " ch.created_time, uc.user_name AS created_user, ch.created_user_id,"
             " ch.modified_time, um.user_name AS modified_user,"
-            " c.comment_text, c.comment_format"
+            " c.comment_text, c.comment_format, cc.comment_html"
             " FROM changes AS ch"
             " LEFT OUTER JOIN users AS uc ON uc.user_id = ch.created_user_id"
             " LEFT OUTER JOIN users AS um ON um.user_id = ch.modified_user_id"
             " JOIN comments AS c ON c.comment_id = ch.change_id AND ch.change_type = ?"
+            " LEFT OUTER JOIN comments_cache AS cc ON cc.comment_id = c.comment_id AND cc.stamp_id = ch.stamp_id"
             " WHERE ch.change_id = ?" );
         query.exec( CommentAdded, id );
 
@@ -2004,11 +2013,12 @@ QList<ChangeEntity> IssueEntity::comments( Qt::SortOrder order ) const
         QString sql = "SELECT ch.change_id, ch.issue_id, ch.stamp_id,"
             " ch.created_time, uc.user_name AS created_user, ch.created_user_id,"
             " ch.modified_time, um.user_name AS modified_user,"
-            " c.comment_text, c.comment_format"
+            " c.comment_text, c.comment_format, cc.comment_html"
             " FROM changes AS ch"
             " LEFT OUTER JOIN users AS uc ON uc.user_id = ch.created_user_id"
             " LEFT OUTER JOIN users AS um ON um.user_id = ch.modified_user_id"
             " JOIN comments AS c ON c.comment_id = ch.change_id AND ch.change_type = ?"
+            " LEFT OUTER JOIN comments_cache AS cc ON cc.comment_id = c.comment_id AND cc.stamp_id = ch.stamp_id"
             " WHERE ch.issue_id = ?"
             " ORDER BY ch.change_id";
         sql += ( order == Qt::DescendingOrder ) ? " DESC" : " ASC";
@@ -2039,6 +2049,7 @@ void ChangeEntityData::readComment( const Query& query )
     m_modifiedUser = query.value( 7 ).toString();
     m_commentText = query.value( 8 ).toString();
     m_commentFormat = (TextFormat)query.value( 9 ).toInt();
+    m_commentHtml = query.value( 10 ).toString();
 }
 
 ChangeEntity ChangeEntity::findFile( int id )
@@ -382,6 +382,7 @@ private:
     QExplicitlySharedDataPointer<IssueEntityData> d;
 
     friend class FolderEntity;
+    friend class IssueBatch;
 };
 
 class ValueEntity
@@ -410,6 +411,7 @@ private:
 
     friend class IssueEntity;
     friend class AttributeEntity;
+    friend class IssueBatch;
 };
 
 class DescriptionEntity
@@ -437,6 +439,7 @@ private:
 
     friend class ProjectEntity;
     friend class IssueEntity;
+    friend class IssueBatch;
 };
 
 class CommentEntity
@@ -455,6 +458,13 @@ public:
     const QString& text() const;
     TextFormat format() const;
 
+    /**
+    * Return the cached HTML converted from the comment's markup.
+    * The string is empty if the comment was not converted yet
+    * or it was modified since the conversion.
+    */
+    const QString& html() const;
+
 private:
     QExplicitlySharedDataPointer<CommentEntityData> d;
 
@@ -534,6 +544,7 @@ private:
 
     friend class IssueEntity;
     friend class IssueEntityData;
+    friend class IssueBatch;
 };
 
 class PreferenceEntity
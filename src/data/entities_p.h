@@ -227,6 +227,7 @@ public:
     int m_id;
     QString m_text;
     TextFormat m_format;
+    QString m_html;
 };
 
 class FileEntityData : public QSharedData
@@ -284,6 +285,7 @@ public:
 
     QString m_commentText;
     TextFormat m_commentFormat;
+    QString m_commentHtml;
 
     QString m_fileName;
     int m_fileSize;
@@ -21,15 +21,144 @@
 
 #include "application.h"
 #include "data/query.h"
+#include "data/localsettings.h"
 #include "sqlite/sqlitedriver.h"
 
 #include <QFileInfo>
 #include <QFile>
 #include <QStringList>
+#include <QDateTime>
+#include <QTimer>
+#include <QMultiMap>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QCryptographicHash>
+
+// cached files are read-only because they can be shared by multiple attachments
+static const QFile::Permissions WritePermissions = QFile::WriteOwner | QFile::WriteUser | QFile::WriteGroup | QFile::WriteOther;
+
+static bool removeFile( const QString& path )
+{
+    // read-only files cannot be removed on Windows
+    QFile::setPermissions( path, QFile::permissions( path ) | QFile::WriteOwner | QFile::WriteUser );
+
+    return QFile::remove( path );
+}
+
+class FileRemover : public QRunnable
+{
+public:
+    FileRemover( const QStringList& paths ) :
+        m_paths( paths )
+    {
+    }
+
+public: // overrides
+    void run()
+    {
+        foreach ( const QString& path, m_paths )
+            removeFile( path );
+    }
+
+private:
+    QStringList m_paths;
+};
+
+static qint64 currentTime()
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000;
+}
+
+// number of bytes compared before the content of files is hashed
+static const qint64 PrefixSize = 65536;
+
+static QByteArray readPrefix( const QString& path )
+{
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return QByteArray();
+
+    return file.read( PrefixSize );
+}
+
+static QByteArray hashFile( const QString& path )
+{
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return QByteArray();
+
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    if ( !hash.addData( &file ) )
+        return QByteArray();
+
+    return hash.result().toHex();
+}
+
+class FileHasher : public QRunnable
+{
+public:
+    FileHasher( FileCache* cache, const QString& path, const QByteArray& hash, const QStringList& candidates ) :
+        m_cache( cache ),
+        m_path( path ),
+        m_hash( hash ),
+        m_candidates( candidates )
+    {
+    }
+
+public: // overrides
+    void run()
+    {
+        if ( m_hash.isEmpty() ) {
+            m_hash = hashFile( m_path );
+            if ( m_hash.isEmpty() )
+                return;
+            QMetaObject::invokeMethod( m_cache, "hashCompleted", Qt::QueuedConnection, Q_ARG( QString, m_path ), Q_ARG( QByteArray, m_hash ) );
+        }
+
+        if ( m_candidates.isEmpty() )
+            return;
+
+        QByteArray prefix = readPrefix( m_path );
+
+        foreach ( const QString& candidate, m_candidates ) {
+            // files which differ at the beginning are rejected without reading them entirely
+            if ( readPrefix( candidate ) != prefix )
+                continue;
+
+            // hashes of existing files are calculated when they are needed for the first time
+            QByteArray hash = hashFile( candidate );
+            if ( hash.isEmpty() )
+                continue;
+            QMetaObject::invokeMethod( m_cache, "hashCompleted", Qt::QueuedConnection, Q_ARG( QString, candidate ), Q_ARG( QByteArray, hash ) );
+
+            if ( hash == m_hash ) {
+                QMetaObject::invokeMethod( m_cache, "duplicateFound", Qt::QueuedConnection, Q_ARG( QString, m_path ), Q_ARG( QString, candidate ) );
+                return;
+            }
+        }
+    }
+
+private:
+    FileCache* m_cache;
+    QString m_path;
+    QByteArray m_hash;
+    QStringList m_candidates;
+};
 
 FileCache::FileCache( const QString& uuid, const QString& path, QObject* parent ) : QObject( parent ),
-    m_uuid( uuid )
+    m_uuid( uuid ),
+    m_valid( false ),
+    m_totalSize( 0 ),
+    m_maxSize( 0 )
 {
+    m_pool.setMaxThreadCount( 1 );
+
+    m_accessTimer = new QTimer( this );
+    m_accessTimer->setSingleShot( true );
+    m_accessTimer->setInterval( 5000 );
+
+    connect( m_accessTimer, SIGNAL( timeout() ), this, SLOT( flushAccess() ) );
+
     QSqlDatabase database = QSqlDatabase::addDatabase( new SQLiteDriver(), "FileCache" );
 
     database.setDatabaseName( path );
@@ -40,6 +169,8 @@ FileCache::FileCache( const QString& uuid, const QString& path, QObject* parent
     database.transaction();
 
     bool ok = installSchema( database );
+    if ( ok )
+        ok = loadEntries( database );
     if ( ok )
         ok = database.commit();
 
@@ -49,12 +180,20 @@ FileCache::FileCache( const QString& uuid, const QString& path, QObject* parent
         return;
     }
 
-    allocFileSpace( 0 );
+    m_valid = true;
+
+    LocalSettings* settings = application->applicationSettings();
+    connect( settings, SIGNAL( settingsChanged() ), this, SLOT( settingsChanged() ) );
+
+    settingsChanged();
 }
 
 FileCache::~FileCache()
 {
-    allocFileSpace( 0 );
+    // results of hashing are queued for this object, so the workers must be finished
+    m_pool.waitForDone();
+
+    flushAccess();
 
     QSqlDatabase database = QSqlDatabase::database( "FileCache" );
     database.close();
@@ -62,7 +201,7 @@ FileCache::~FileCache()
 
 bool FileCache::installSchema( const QSqlDatabase& database )
 {
-    const int schemaVersion = 1;
+    const int schemaVersion = 2;
 
     Query query( database );
 
@@ -74,8 +213,24 @@ bool FileCache::installSchema( const QSqlDatabase& database )
     if ( currentVersion >= schemaVersion )
         return true;
 
-    if ( !query.execQuery( "CREATE TABLE files_cache ( server_uuid text, file_id integer, file_path text UNIQUE, file_size integer, last_access integer, UNIQUE ( server_uuid, file_id ) )" ) )
+    if ( currentVersion == 1 ) {
+        if ( !query.execQuery( "ALTER TABLE files_cache RENAME TO files_cache_old" ) )
+            return false;
+    }
+
+    // multiple entries can refer to the same file if its content is identical
+    if ( !query.execQuery( "CREATE TABLE files_cache ( server_uuid text, file_id integer, file_path text, file_size integer, last_access integer, content_hash text, UNIQUE ( server_uuid, file_id ) )" ) )
         return false;
+    if ( !query.execQuery( "CREATE INDEX files_cache_path_idx ON files_cache ( file_path )" ) )
+        return false;
+
+    if ( currentVersion == 1 ) {
+        if ( !query.execQuery( "INSERT INTO files_cache ( server_uuid, file_id, file_path, file_size, last_access )"
+            " SELECT server_uuid, file_id, file_path, file_size, last_access FROM files_cache_old" ) )
+            return false;
+        if ( !query.execQuery( "DROP TABLE files_cache_old" ) )
+            return false;
+    }
 
     QString sql = QString( "PRAGMA user_version = %1" ).arg( schemaVersion );
 
@@ -85,27 +240,63 @@ bool FileCache::installSchema( const QSqlDatabase& database )
     return true;
 }
 
-QString FileCache::findFilePath( int fileId )
+bool FileCache::loadEntries( const QSqlDatabase& database )
 {
-    QSqlDatabase database = QSqlDatabase::database( "FileCache" );
-
     Query query( database );
 
-    if ( !query.execQuery( "SELECT file_path FROM files_cache WHERE server_uuid = ? AND file_id = ?", m_uuid, fileId ) )
-        return QString();
+    if ( !query.execQuery( "SELECT server_uuid, file_id, file_path, file_size, last_access, content_hash FROM files_cache" ) )
+        return false;
+
+    while ( query.next() ) {
+        QString path = query.value( 2 ).toString();
+
+        if ( query.value( 0 ).toString() == m_uuid )
+            m_paths.insert( query.value( 1 ).toInt(), path );
+
+        QHash<QString, CachedFile>::iterator it = m_files.find( path );
+
+        if ( it == m_files.end() ) {
+            CachedFile file;
+            file.m_size = query.value( 3 ).toLongLong();
+            file.m_lastAccess = query.value( 4 ).toLongLong();
+            file.m_hash = query.value( 5 ).toByteArray();
+            m_files.insert( path, file );
 
-    QString path = query.readScalar().toString();
+            m_totalSize += file.m_size;
+        } else {
+            it->m_lastAccess = qMax( it->m_lastAccess, query.value( 4 ).toLongLong() );
+        }
+    }
+
+    return true;
+}
+
+void FileCache::settingsChanged()
+{
+    LocalSettings* settings = application->applicationSettings();
+    m_maxSize = settings->value( "AttachmentsCacheSize" ).toLongLong() * 1024 * 1024;
+
+    allocFileSpace( 0 );
+}
+
+QString FileCache::findFilePath( int fileId )
+{
+    QString path = m_paths.value( fileId );
 
     if ( path.isEmpty() )
         return QString();
 
+    // only the requested file is checked, in case it was deleted by the user
     if ( !QFile::exists( path ) ) {
-        query.execQuery( "DELETE FROM files_cache WHERE file_path = ?", path );
-
+        removeEntries( QStringList() << path );
         return QString();
     }
 
-    query.execQuery( "UPDATE files_cache SET last_access = strftime( '%s', 'now' ) WHERE file_path = ?", path );
+    m_files[ path ].m_lastAccess = currentTime();
+
+    m_pendingAccess.insert( path );
+    if ( !m_accessTimer->isActive() )
+        m_accessTimer->start();
 
     return path;
 }
@@ -134,67 +325,303 @@ QString FileCache::generateFilePath( const QString& name ) const
 
 void FileCache::allocFileSpace( int size )
 {
+    if ( !m_valid )
+        return;
+
     QSqlDatabase database = QSqlDatabase::database( "FileCache" );
     database.transaction();
 
-    bool ok = allocFileSpace( size, database );
+    QStringList paths;
+
+    bool ok = allocFileSpace( size, paths, database );
     if ( ok )
         ok = database.commit();
 
-    if ( !ok )
+    if ( !ok ) {
         database.rollback();
+        return;
+    }
+
+    forgetEntries( paths );
+
+    // deleting files can take a long time so it's done in the background
+    if ( !paths.isEmpty() )
+        QThreadPool::globalInstance()->start( new FileRemover( paths ) );
 }
 
-bool FileCache::allocFileSpace( int allocated, const QSqlDatabase& database )
+bool FileCache::allocFileSpace( qint64 size, QStringList& paths, const QSqlDatabase& database )
 {
-    const int maxCount = 100;
-    const int maxSize = 50 * 1024 * 1024;
-
     Query query( database );
 
-    int count = 0;
-    int size = 0;
+    // other instances of the application can add and evict files, so the total size is read from the database
+    if ( !query.execQuery( "SELECT SUM( file_size ) FROM ( SELECT MAX( file_size ) AS file_size FROM files_cache GROUP BY file_path )" ) )
+        return false;
+
+    m_totalSize = query.readScalar().toLongLong();
+
+    if ( m_totalSize + size <= m_maxSize )
+        return true;
+
+    // store the access times of this instance and load entries of all instances
+    if ( !flushAccess( database ) )
+        return false;
+
+    m_files.clear();
+    m_paths.clear();
+    m_totalSize = 0;
 
-    if ( !query.execQuery( "SELECT COUNT(*), SUM( file_size ) FROM files_cache" ) )
+    if ( !loadEntries( database ) )
         return false;
 
-    if ( query.next() ) {
-        count = query.value( 0 ).toInt();
-        size = query.value( 1 ).toInt();
+    QMultiMap<qint64, QString> lastAccess;
+    for ( QHash<QString, CachedFile>::const_iterator it = m_files.constBegin(); it != m_files.constEnd(); ++it )
+        lastAccess.insert( it.value().m_lastAccess, it.key() );
+
+    qint64 remaining = m_totalSize + size;
+
+    for ( QMultiMap<qint64, QString>::const_iterator it = lastAccess.constBegin(); it != lastAccess.constEnd() && remaining > m_maxSize; ++it ) {
+        paths.append( it.value() );
+        remaining -= m_files.value( it.value() ).m_size;
     }
 
-    if ( allocated > 0 ) {
-        count++;
-        size += allocated;
+    return removeEntries( paths, database );
+}
+
+void FileCache::removeEntries( const QStringList& paths )
+{
+    if ( paths.isEmpty() )
+        return;
+
+    forgetEntries( paths );
+
+    QSqlDatabase database = QSqlDatabase::database( "FileCache" );
+    database.transaction();
+
+    bool ok = removeEntries( paths, database );
+    if ( ok )
+        ok = database.commit();
+
+    if ( !ok )
+        database.rollback();
+}
+
+bool FileCache::removeEntries( const QStringList& paths, const QSqlDatabase& database )
+{
+    Query query( "DELETE FROM files_cache WHERE file_path = ?", database );
+
+    foreach ( const QString& path, paths ) {
+        if ( !query.exec( path ) )
+            return false;
     }
 
-    QStringList paths;
+    return true;
+}
 
-    if ( !query.execQuery( "SELECT file_path, file_size FROM files_cache ORDER BY last_access" ) )
-        return false;
+void FileCache::forgetEntries( const QStringList& paths )
+{
+    QSet<QString> removed;
 
-    while ( query.next() ) {
-        QString path = query.value( 0 ).toString();
-        if ( !QFile::exists( path ) || ( ( count > maxCount || size > maxSize ) && QFile::remove( path ) ) ) {
-            paths.append( path );
-            count--;
-            size -= query.value( 1 ).toInt();
-        }
+    foreach ( const QString& path, paths ) {
+        QHash<QString, CachedFile>::iterator it = m_files.find( path );
+        if ( it == m_files.end() )
+            continue;
+
+        m_totalSize -= it.value().m_size;
+        m_pendingAccess.remove( path );
+
+        m_files.erase( it );
+
+        removed.insert( path );
     }
 
-    query.setQuery( "DELETE FROM files_cache WHERE file_path = ?" );
+    // all entries of this server which share the removed files are forgotten
+    for ( QHash<int, QString>::iterator it = m_paths.begin(); it != m_paths.end(); ) {
+        if ( removed.contains( it.value() ) )
+            it = m_paths.erase( it );
+        else
+            ++it;
+    }
+}
 
-    foreach ( const QString& path, paths )
-        query.exec( path );
+void FileCache::flushAccess()
+{
+    m_accessTimer->stop();
+
+    if ( m_pendingAccess.isEmpty() )
+        return;
+
+    QSqlDatabase database = QSqlDatabase::database( "FileCache" );
+    database.transaction();
+
+    bool ok = flushAccess( database );
+    if ( ok )
+        ok = database.commit();
+
+    if ( !ok )
+        database.rollback();
+
+    m_pendingAccess.clear();
+}
+
+bool FileCache::flushAccess( const QSqlDatabase& database )
+{
+    Query query( "UPDATE files_cache SET last_access = ? WHERE file_path = ?", database );
+
+    foreach ( const QString& path, m_pendingAccess ) {
+        if ( !query.exec( m_files.value( path ).m_lastAccess, path ) )
+            return false;
+    }
 
     return true;
 }
 
-void FileCache::commitFile( int fileId, const QString& path, int size )
+QString FileCache::findFileByHash( const QByteArray& hash ) const
+{
+    if ( !m_valid || hash.isEmpty() )
+        return QString();
+
+    for ( QHash<QString, CachedFile>::const_iterator it = m_files.constBegin(); it != m_files.constEnd(); ++it ) {
+        if ( it.value().m_hash == hash && QFile::exists( it.key() ) )
+            return it.key();
+    }
+
+    return QString();
+}
+
+QString FileCache::commitFile( int fileId, const QString& path, int size, const QByteArray& hash )
+{
+    if ( !m_valid )
+        return path;
+
+    QString filePath = path;
+
+    // the download is skipped when a file with identical content is already cached
+    QString existing = findFileByHash( hash );
+
+    if ( !existing.isEmpty() && existing != path ) {
+        if ( QFileInfo( existing ).suffix().compare( QFileInfo( path ).suffix(), Qt::CaseInsensitive ) == 0 ) {
+            if ( !QFile::exists( path ) || removeFile( path ) )
+                filePath = existing;
+        } else if ( !QFile::exists( path ) ) {
+            // a copy with the appropriate extension is created so that the file can be opened using the right application
+            if ( !QFile::copy( existing, path ) )
+                return QString();
+        }
+    }
+
+    if ( !QFile::exists( filePath ) )
+        return QString();
+
+    QSqlDatabase database = QSqlDatabase::database( "FileCache" );
+
+    Query query( database );
+
+    qint64 lastAccess = currentTime();
+
+    if ( !query.execQuery( "INSERT INTO files_cache ( server_uuid, file_id, file_path, file_size, last_access, content_hash ) VALUES ( ?, ?, ?, ?, ?, ? )",
+        QVariantList() << m_uuid << fileId << filePath << size << lastAccess << ( hash.isEmpty() ? QVariant( QVariant::String ) : QVariant( QString::fromLatin1( hash ) ) ) ) )
+        return filePath;
+
+    QFile::setPermissions( filePath, QFile::permissions( filePath ) & ~WritePermissions );
+
+    m_paths.insert( fileId, filePath );
+
+    QHash<QString, CachedFile>::iterator it = m_files.find( filePath );
+
+    if ( it != m_files.end() ) {
+        it->m_lastAccess = lastAccess;
+        return filePath;
+    }
+
+    CachedFile file;
+    file.m_size = size;
+    file.m_lastAccess = lastAccess;
+    file.m_hash = hash;
+    m_files.insert( filePath, file );
+
+    m_totalSize += size;
+
+    QString suffix = QFileInfo( filePath ).suffix();
+
+    QStringList candidates;
+
+    // only files with the same size and extension are compared, so that the file can still be opened
+    // using the appropriate application; files with a known hash were already compared
+    for ( QHash<QString, CachedFile>::const_iterator it = m_files.constBegin(); it != m_files.constEnd(); ++it ) {
+        if ( it.value().m_size == size && it.value().m_hash.isEmpty() && it.key() != filePath && QFileInfo( it.key() ).suffix().compare( suffix, Qt::CaseInsensitive ) == 0 )
+            candidates.append( it.key() );
+    }
+
+    // hashing large files takes a long time so it's done in the background
+    if ( hash.isEmpty() || !candidates.isEmpty() )
+        m_pool.start( new FileHasher( this, filePath, hash, candidates ) );
+
+    return filePath;
+}
+
+void FileCache::hashCompleted( const QString& path, const QByteArray& hash )
 {
+    QHash<QString, CachedFile>::iterator it = m_files.find( path );
+    if ( it == m_files.end() || !it->m_hash.isEmpty() )
+        return;
+
+    it->m_hash = hash;
+
     QSqlDatabase database = QSqlDatabase::database( "FileCache" );
 
     Query query( database );
+    query.execQuery( "UPDATE files_cache SET content_hash = ? WHERE file_path = ?", QString::fromLatin1( hash ), path );
 
-    query.execQuery( "INSERT INTO files_cache ( server_uuid, file_id, file_path, file_size, last_access ) VALUES ( ?, ?, ?, ?, strftime( '%s', 'now' ) )", m_uuid, fileId, path, size );
+    QString suffix = QFileInfo( path ).suffix();
+
+    // another file with identical content may have been committed in the meantime
+    for ( QHash<QString, CachedFile>::const_iterator other = m_files.constBegin(); other != m_files.constEnd(); ++other ) {
+        if ( other.value().m_hash == hash && other.key() != path && QFileInfo( other.key() ).suffix().compare( suffix, Qt::CaseInsensitive ) == 0 ) {
+            duplicateFound( path, other.key() );
+            break;
+        }
+    }
+}
+
+void FileCache::duplicateFound( const QString& path, const QString& duplicate )
+{
+    QHash<QString, CachedFile>::iterator it = m_files.find( path );
+    QHash<QString, CachedFile>::iterator target = m_files.find( duplicate );
+
+    if ( it == m_files.end() || target == m_files.end() || !QFile::exists( duplicate ) )
+        return;
+
+    // the file may be open in another application
+    if ( !removeFile( path ) )
+        return;
+
+    QSqlDatabase database = QSqlDatabase::database( "FileCache" );
+    database.transaction();
+
+    Query query( database );
+
+    bool ok = query.execQuery( "UPDATE files_cache SET file_path = ? WHERE file_path = ?", duplicate, path );
+    if ( ok )
+        ok = database.commit();
+
+    if ( !ok ) {
+        database.rollback();
+        removeEntries( QStringList() << path );
+        return;
+    }
+
+    QFile::setPermissions( duplicate, QFile::permissions( duplicate ) & ~WritePermissions );
+
+    target->m_lastAccess = qMax( target->m_lastAccess, it->m_lastAccess );
+
+    m_totalSize -= it->m_size;
+    m_files.erase( it );
+
+    if ( m_pendingAccess.remove( path ) )
+        m_pendingAccess.insert( duplicate );
+
+    for ( QHash<int, QString>::iterator entry = m_paths.begin(); entry != m_paths.end(); ++entry ) {
+        if ( entry.value() == path )
+            entry.value() = duplicate;
+    }
 }
@@ -22,11 +22,31 @@
 
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
 
 class QSqlDatabase;
+class QTimer;
 
 /**
 * Class for caching downloaded attachments.
+*
+* Information about cached files is loaded into memory when the cache is
+* created. The cache is shared by all instances of the application, so the
+* total size is read from the database before allocating space and the
+* entries are loaded again before evicting files. Files are evicted in least
+* recently used order when the total size exceeds the limit configured in
+* application settings. Evicted files are deleted in a background thread and
+* updates of last access time are written in batches.
+*
+* Attachments with identical content, downloaded from the same or different
+* servers, share a single file. Committed files are hashed in a background
+* thread and files with identical content and extension are merged when the
+* hash is known. Cached files are made read-only, so that modifying a shared
+* file does not affect other attachments. A file is deleted when it is
+* evicted, together with all entries which refer to it.
 */
 class FileCache : public QObject
 {
@@ -64,21 +84,71 @@ public:
     */
     void allocFileSpace( int size );
 
+    /**
+    * Locate a cached file with the given content.
+    * @param hash The SHA-1 hash of the content in hexadecimal format.
+    * @return Path of the file or empty string if it is not cached.
+    */
+    QString findFileByHash( const QByteArray& hash ) const;
+
     /**
     * Add the file to the cache.
+    * If a file with the given hash is already cached, the given file,
+    * which may not exist if downloading it was skipped, is replaced with
+    * the existing file. Otherwise the file is hashed in the background.
     * @param fileId Identifier of the file.
     * @parm path Path of the file in the cache.
     * @param size Size of the file in bytes.
+    * @param hash The SHA-1 hash of the content reported by the server.
+    * @return Path of the cached file or empty string if it doesn't exist.
     */
-    void commitFile( int fileId, const QString& path, int size );
+    QString commitFile( int fileId, const QString& path, int size, const QByteArray& hash = QByteArray() );
+
+private slots:
+    void settingsChanged();
+
+    void flushAccess();
+
+    void hashCompleted( const QString& path, const QByteArray& hash );
+    void duplicateFound( const QString& path, const QString& duplicate );
+
+private:
+    struct CachedFile
+    {
+        qint64 m_size;
+        qint64 m_lastAccess;
+        QByteArray m_hash;
+    };
 
 private:
     bool installSchema( const QSqlDatabase& database );
 
-    bool allocFileSpace( int allocated, const QSqlDatabase& database );
+    bool loadEntries( const QSqlDatabase& database );
+
+    bool allocFileSpace( qint64 size, QStringList& paths, const QSqlDatabase& database );
+
+    void removeEntries( const QStringList& paths );
+    bool removeEntries( const QStringList& paths, const QSqlDatabase& database );
+
+    void forgetEntries( const QStringList& paths );
+
+    bool flushAccess( const QSqlDatabase& database );
 
 private:
     QString m_uuid;
+
+    bool m_valid;
+
+    QHash<QString, CachedFile> m_files;
+    QHash<int, QString> m_paths;
+
+    qint64 m_totalSize;
+    qint64 m_maxSize;
+
+    QSet<QString> m_pendingAccess;
+    QTimer* m_accessTimer;
+
+    QThreadPool m_pool;
 };
 
 #endif
@@ -0,0 +1,339 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "issuebatch.h"
+#include "entities_p.h"
+
+#include "data/issuetypecache.h"
+#include "data/query.h"
+
+#include <QStringList>
+
+// maximum number of identifiers passed to a single query
+static const int ChunkSize = 500;
+
+IssueBatch::IssueBatch()
+{
+}
+
+IssueBatch::~IssueBatch()
+{
+}
+
+void IssueBatch::load( const QList<int>& issues, bool description, bool history )
+{
+    clear();
+
+    QList<int> sorted = issues;
+    qSort( sorted );
+
+    QStringList chunks;
+    for ( int i = 0; i < sorted.count(); i += ChunkSize ) {
+        QStringList ids;
+        for ( int j = i; j < sorted.count() && j < i + ChunkSize; j++ )
+            ids.append( QString::number( sorted.at( j ) ) );
+        chunks.append( ids.join( ", " ) );
+    }
+
+    // issues are stored in order of identifiers and so are the rows of other queries
+    foreach ( const QString& ids, chunks )
+        loadIssues( ids );
+
+    int count = m_issues.count();
+
+    m_admin.fill( dataManager->currentUserAccess() == AdminAccess, count );
+    m_valuesOffsets.fill( 0, count + 1 );
+    m_changesOffsets.fill( 0, count + 1 );
+
+    if ( description )
+        m_descriptions.resize( count );
+
+    foreach ( const QString& ids, chunks ) {
+        loadValues( ids );
+        if ( description )
+            loadDescriptions( ids );
+        if ( history )
+            loadChanges( ids );
+        if ( dataManager->currentUserAccess() != AdminAccess )
+            loadRights( ids );
+    }
+
+    // convert the numbers of rows to offsets of the first row of each issue
+    for ( int i = 0; i < count; i++ ) {
+        m_valuesOffsets[ i + 1 ] += m_valuesOffsets[ i ];
+        m_changesOffsets[ i + 1 ] += m_changesOffsets[ i ];
+    }
+
+    sortValues();
+}
+
+void IssueBatch::clear()
+{
+    m_index.clear();
+    m_issues.clear();
+    m_admin.clear();
+    m_descriptions.clear();
+    m_values.clear();
+    m_valuesSet.clear();
+    m_valuesOffsets.clear();
+    m_changes.clear();
+    m_changesOffsets.clear();
+}
+
+void IssueBatch::loadIssues( const QString& ids )
+{
+    Query query( QString( "SELECT i.issue_id, i.stamp_id, s.read_id, s.subscription_id, i.folder_id, f.type_id, i.issue_name,"
+        " i.created_time, uc.user_name AS created_user, i.created_user_id, i.modified_time, um.user_name AS modified_user"
+        " FROM issues AS i"
+        " JOIN folders AS f ON f.folder_id = i.folder_id"
+        " LEFT OUTER JOIN issue_states AS s ON s.issue_id = i.issue_id AND s.user_id = ?"
+        " LEFT OUTER JOIN users AS uc ON uc.user_id = i.created_user_id"
+        " LEFT OUTER JOIN users AS um ON um.user_id = i.modified_user_id"
+        " WHERE i.issue_id IN ( %1 )"
+        " ORDER BY i.issue_id" ).arg( ids ) );
+    query.exec( dataManager->currentUserId() );
+
+    while ( query.next() ) {
+        IssueEntity entity;
+        entity.d->read( query );
+        m_index.insert( entity.id(), m_issues.count() );
+        m_issues.append( entity );
+    }
+}
+
+void IssueBatch::loadValues( const QString& ids )
+{
+    Query query( QString( "SELECT a.attr_id, v.attr_value, i.issue_id, a.type_id, v.attr_id IS NOT NULL"
+        " FROM issues AS i"
+        " JOIN folders AS f ON f.folder_id = i.folder_id"
+        " JOIN attr_types AS a ON a.type_id = f.type_id"
+        " LEFT OUTER JOIN attr_values AS v ON v.attr_id = a.attr_id AND v.issue_id = i.issue_id"
+        " WHERE i.issue_id IN ( %1 )"
+        " ORDER BY i.issue_id" ).arg( ids ) );
+    query.exec();
+
+    while ( query.next() ) {
+        int index = m_index.value( query.value( 2 ).toInt(), -1 );
+        if ( index < 0 )
+            continue;
+
+        ValueEntity entity;
+        entity.d->read( query );
+        entity.d->m_typeId = query.value( 3 ).toInt();
+        m_values.append( entity );
+        m_valuesSet.append( query.value( 4 ).toBool() );
+
+        m_valuesOffsets[ index + 1 ]++;
+    }
+}
+
+void IssueBatch::loadDescriptions( const QString& ids )
+{
+    Query query( QString( "SELECT id.issue_id, id.descr_text, id.descr_format, id.modified_time, um.user_name AS modified_user, id.modified_user_id"
+        " FROM issue_descriptions AS id"
+        " LEFT OUTER JOIN users AS um ON um.user_id = id.modified_user_id"
+        " WHERE id.issue_id IN ( %1 )" ).arg( ids ) );
+    query.exec();
+
+    while ( query.next() ) {
+        int index = m_index.value( query.value( 0 ).toInt(), -1 );
+        if ( index < 0 )
+            continue;
+
+        DescriptionEntity entity;
+        entity.d->read( query );
+        m_descriptions[ index ] = entity;
+    }
+}
+
+void IssueBatch::loadChanges( const QString& ids )
+{
+    Query query( QString( "SELECT ch.change_id, ch.issue_id, ch.stamp_id, ch.change_type,"
+        " ch.created_time, uc.user_name AS created_user, ch.created_user_id,"
+        " ch.modified_time, um.user_name AS modified_user, ch.modified_user_id,"
+        " a.attr_id, ch.old_value, ch.new_value, fp.project_name AS from_project, ff.folder_name AS from_folder,"
+        " tp.project_name AS to_project, tf.folder_name AS to_folder,"
+        " c.comment_text, c.comment_format, f.file_name, f.file_size, f.file_descr, cc.comment_html"
+        " FROM changes AS ch"
+        " LEFT OUTER JOIN users AS uc ON uc.user_id = ch.created_user_id"
+        " LEFT OUTER JOIN users AS um ON um.user_id = ch.modified_user_id"
+        " LEFT OUTER JOIN attr_types AS a ON a.attr_id = ch.attr_id"
+        " LEFT OUTER JOIN folders AS ff ON ff.folder_id = ch.from_folder_id"
+        " LEFT OUTER JOIN projects AS fp ON fp.project_id = ff.project_id"
+        " LEFT OUTER JOIN folders AS tf ON tf.folder_id = ch.to_folder_id"
+        " LEFT OUTER JOIN projects AS tp ON tp.project_id = tf.project_id"
+        " LEFT OUTER JOIN comments AS c ON c.comment_id = ch.change_id AND ch.change_type = ?"
+        " LEFT OUTER JOIN files AS f ON f.file_id = ch.change_id AND ch.change_type = ?"
+        " LEFT OUTER JOIN comments_cache AS cc ON cc.comment_id = c.comment_id AND cc.stamp_id = ch.stamp_id"
+        " WHERE ch.issue_id IN ( %1 )"
+        " ORDER BY ch.issue_id, ch.change_id" ).arg( ids ) );
+    query.exec( CommentAdded, FileAdded );
+
+    while ( query.next() ) {
+        int index = m_index.value( query.value( 1 ).toInt(), -1 );
+        if ( index < 0 )
+            continue;
+
+        ChangeEntity entity;
+        entity.d->read( query );
+        entity.d->m_typeId = m_issues.at( index ).d->m_typeId;
+        m_changes.append( entity );
+
+        m_changesOffsets[ index + 1 ]++;
+    }
+}
+
+void IssueBatch::loadRights( const QString& ids )
+{
+    Query query( QString( "SELECT i.issue_id"
+        " FROM issues AS i"
+        " JOIN folders AS f ON f.folder_id = i.folder_id"
+        " JOIN rights AS r ON r.project_id = f.project_id AND r.user_id = ?"
+        " WHERE i.issue_id IN ( %1 ) AND r.project_access = ?" ).arg( ids ) );
+    query.exec( dataManager->currentUserId(), AdminAccess );
+
+    while ( query.next() ) {
+        int index = m_index.value( query.value( 0 ).toInt(), -1 );
+        if ( index >= 0 )
+            m_admin[ index ] = true;
+    }
+}
+
+class ValuePositionLessThan
+{
+public:
+    ValuePositionLessThan( const QHash<int, int>& positions ) :
+        m_positions( positions )
+    {
+    }
+
+public:
+    bool operator ()( const QPair<ValueEntity, bool>& v1, const QPair<ValueEntity, bool>& v2 )
+    {
+        return m_positions.value( v1.first.id(), -1 ) < m_positions.value( v2.first.id(), -1 );
+    }
+
+private:
+    const QHash<int, int>& m_positions;
+};
+
+void IssueBatch::sortValues()
+{
+    QHash<int, QHash<int, int> > positions;
+
+    for ( int i = 0; i < m_issues.count(); i++ ) {
+        int first = m_valuesOffsets.at( i );
+        int last = m_valuesOffsets.at( i + 1 );
+        if ( last - first < 2 )
+            continue;
+
+        // values are ordered the same way as attributes of the issue type
+        int typeId = m_issues.at( i ).d->m_typeId;
+        bool cached = positions.contains( typeId );
+        QHash<int, int>& typePositions = positions[ typeId ];
+        if ( !cached ) {
+            QList<int> attributes = dataManager->issueTypeCache( typeId )->attributes();
+            for ( int j = 0; j < attributes.count(); j++ )
+                typePositions.insert( attributes.at( j ), j );
+        }
+
+        QList< QPair<ValueEntity, bool> > values;
+        for ( int j = first; j < last; j++ )
+            values.append( qMakePair( m_values.at( j ), m_valuesSet.at( j ) ) );
+
+        qStableSort( values.begin(), values.end(), ValuePositionLessThan( typePositions ) );
+
+        for ( int j = first; j < last; j++ ) {
+            m_values[ j ] = values.at( j - first ).first;
+            m_valuesSet[ j ] = values.at( j - first ).second;
+        }
+    }
+}
+
+IssueEntity IssueBatch::issue( int issueId ) const
+{
+    int index = m_index.value( issueId, -1 );
+    if ( index < 0 )
+        return IssueEntity();
+
+    return m_issues.at( index );
+}
+
+bool IssueBatch::isOwner( int issueId ) const
+{
+    return issue( issueId ).createdUserId() == dataManager->currentUserId();
+}
+
+bool IssueBatch::isAdmin( int issueId ) const
+{
+    int index = m_index.value( issueId, -1 );
+    if ( index < 0 )
+        return false;
+
+    return m_admin.at( index );
+}
+
+QList<ValueEntity> IssueBatch::values( int issueId, bool nonEmpty ) const
+{
+    QList<ValueEntity> result;
+
+    int index = m_index.value( issueId, -1 );
+    if ( index < 0 )
+        return result;
+
+    for ( int i = m_valuesOffsets.at( index ); i < m_valuesOffsets.at( index + 1 ); i++ ) {
+        if ( !nonEmpty || m_valuesSet.at( i ) )
+            result.append( m_values.at( i ) );
+    }
+
+    return result;
+}
+
+DescriptionEntity IssueBatch::description( int issueId ) const
+{
+    int index = m_index.value( issueId, -1 );
+    if ( index < 0 || index >= m_descriptions.count() )
+        return DescriptionEntity();
+
+    return m_descriptions.at( index );
+}
+
+QList<ChangeEntity> IssueBatch::changes( int issueId, Qt::SortOrder order ) const
+{
+    QList<ChangeEntity> result;
+
+    int index = m_index.value( issueId, -1 );
+    if ( index < 0 )
+        return result;
+
+    int first = m_changesOffsets.at( index );
+    int last = m_changesOffsets.at( index + 1 );
+
+    result.reserve( last - first );
+
+    if ( order == Qt::AscendingOrder ) {
+        for ( int i = first; i < last; i++ )
+            result.append( m_changes.at( i ) );
+    } else {
+        for ( int i = last - 1; i >= first; i-- )
+            result.append( m_changes.at( i ) );
+    }
+
+    return result;
+}
@@ -0,0 +1,127 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef ISSUEBATCH_H
+#define ISSUEBATCH_H
+
+#include "data/entities.h"
+
+#include <QVector>
+#include <QHash>
+
+/**
+* Details of multiple issues loaded from the cache in bulk.
+*
+* The issues, attribute values, descriptions and changes of all issues are
+* retrieved using a few queries and stored in contiguous arrays, so that
+* details of many issues can be generated without querying the database
+* for each of them separately.
+*/
+class IssueBatch
+{
+public:
+    /**
+    * Default constructor.
+    */
+    IssueBatch();
+
+    /**
+    * Destructor.
+    */
+    ~IssueBatch();
+
+public:
+    /**
+    * Load details of the given issues.
+    * Issues which do not exist in the cache are ignored.
+    * @param issues Identifiers of issues to load.
+    * @param description @c true if descriptions should be loaded.
+    * @param history @c true if changes should be loaded.
+    */
+    void load( const QList<int>& issues, bool description, bool history );
+
+    /**
+    * Remove all loaded details.
+    */
+    void clear();
+
+    /**
+    * Return @c true if details of the given issue are loaded.
+    */
+    bool contains( int issueId ) const { return m_index.contains( issueId ); }
+
+    /**
+    * Return the issue with given identifier.
+    */
+    IssueEntity issue( int issueId ) const;
+
+    /**
+    * Return @c true if the current user is the owner of the issue.
+    */
+    bool isOwner( int issueId ) const;
+
+    /**
+    * Return @c true if the current user is a project administrator of the issue.
+    */
+    bool isAdmin( int issueId ) const;
+
+    /**
+    * Return the attribute values of the issue.
+    * @param issueId Identifier of the issue.
+    * @param nonEmpty If @c true, only values which are set are returned.
+    */
+    QList<ValueEntity> values( int issueId, bool nonEmpty ) const;
+
+    /**
+    * Return the description of the issue.
+    */
+    DescriptionEntity description( int issueId ) const;
+
+    /**
+    * Return the changes of the issue.
+    * @param issueId Identifier of the issue.
+    * @param order Order of changes.
+    */
+    QList<ChangeEntity> changes( int issueId, Qt::SortOrder order ) const;
+
+private:
+    void loadIssues( const QString& ids );
+    void loadValues( const QString& ids );
+    void loadDescriptions( const QString& ids );
+    void loadChanges( const QString& ids );
+    void loadRights( const QString& ids );
+
+    void sortValues();
+
+private:
+    QHash<int, int> m_index;
+
+    QVector<IssueEntity> m_issues;
+    QVector<bool> m_admin;
+    QVector<DescriptionEntity> m_descriptions;
+
+    QVector<ValueEntity> m_values;
+    QVector<bool> m_valuesSet;
+    QVector<int> m_valuesOffsets;
+
+    QVector<ChangeEntity> m_changes;
+    QVector<int> m_changesOffsets;
+};
+
+#endif
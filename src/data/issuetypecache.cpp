@@ -26,6 +26,7 @@
 #include <QSqlQuery>
 
 IssueTypeCache::IssueTypeCache( int typeId, QObject* parent ) : QObject( parent ),
+    m_typeId( typeId ),
     m_initialViewId( 0 )
 {
     QString query = "SELECT attr_id, attr_name, attr_def"
@@ -91,6 +92,7 @@ IssueTypeCache::IssueTypeCache( int typeId, QObject* parent ) : QObject( parent
 
 IssueTypeCache::~IssueTypeCache()
 {
+    qDeleteAll( m_viewPlans );
 }
 
 QList<int> IssueTypeCache::availableColumns( bool withLocation ) const
@@ -180,7 +182,7 @@ QList<DefinitionInfo> IssueTypeCache::viewFilters( const DefinitionInfo& info )
 
         for ( int i = 0; i < definitions.count(); i++ ) {
             DefinitionInfo filter = DefinitionInfo::fromString( definitions.at( i ) );
-            int column = filter.metadata( "column" ).toInt();
+            int column = filter.column();
             if ( columns.contains( column ) )
                 result.append( filter );
         }
@@ -189,6 +191,67 @@ QList<DefinitionInfo> IssueTypeCache::viewFilters( const DefinitionInfo& info )
     return result;
 }
 
+const ViewPlan* IssueTypeCache::viewPlan( int viewId, bool withLocation ) const
+{
+    int key = 2 * viewId + ( withLocation ? 1 : 0 );
+
+    ViewPlan* plan = m_viewPlans.value( key );
+    if ( !plan ) {
+        plan = compileViewPlan( viewId, withLocation );
+        m_viewPlans.insert( key, plan );
+    }
+
+    return plan;
+}
+
+ViewPlan* IssueTypeCache::compileViewPlan( int viewId, bool withLocation ) const
+{
+    ViewPlan* plan = new ViewPlan();
+
+    DefinitionInfo info;
+
+    if ( viewId != 0 ) {
+        QSqlQuery sqlQuery;
+        sqlQuery.prepare( "SELECT v.view_def"
+            " FROM views AS v"
+            " WHERE v.view_id = ? AND v.type_id = ?" );
+        sqlQuery.addBindValue( viewId );
+        sqlQuery.addBindValue( m_typeId );
+        sqlQuery.exec();
+
+        if ( !sqlQuery.next() )
+            return plan;
+
+        info = DefinitionInfo::fromString( sqlQuery.value( 0 ).toString() );
+    } else {
+        info = m_defaultView;
+    }
+
+    plan->m_valid = true;
+    plan->m_columns = viewColumns( info, withLocation );
+
+    foreach ( const DefinitionInfo& filterInfo, viewFilters( info ) ) {
+        ViewFilter filter;
+        filter.m_column = filterInfo.column();
+        filter.m_operator = filterInfo.type();
+        filter.m_value = filterInfo.value();
+
+        if ( filter.m_column > Column_UserDefined ) {
+            DefinitionInfo attributeInfo = attributeDefinition( filter.m_column - Column_UserDefined );
+            filter.m_attributeType = AttributeHelper::toAttributeType( attributeInfo );
+            filter.m_local = attributeInfo.isLocal();
+        }
+
+        plan->m_filters.append( filter );
+    }
+
+    QPair<int, Qt::SortOrder> order = viewSortOrder( info );
+    plan->m_sortColumn = order.first;
+    plan->m_sortOrder = order.second;
+
+    return plan;
+}
+
 DefinitionInfo IssueTypeCache::filterValueInfo( int column ) const
 {
     DefinitionInfo result;
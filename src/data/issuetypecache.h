@@ -20,6 +20,7 @@
 #ifndef ISSUETYPECACHE_H
 #define ISSUETYPECACHE_H
 
+#include "data/viewplan.h"
 #include "utils/definitioninfo.h"
 
 #include <QObject>
@@ -85,6 +86,13 @@ public:
     */
     QList<DefinitionInfo> viewFilters( const DefinitionInfo& info ) const;
 
+    /**
+    * Return the precompiled plan for the given view.
+    * @param viewId Identifier of the view or 0 for the default view.
+    * @param withLocation If @c true, the location column is included.
+    */
+    const ViewPlan* viewPlan( int viewId, bool withLocation = false ) const;
+
     /**
     * Return the definition of a filter value for given column.
     */
@@ -106,6 +114,11 @@ public:
     int initialViewId() const { return m_initialViewId; }
 
 private:
+    ViewPlan* compileViewPlan( int viewId, bool withLocation ) const;
+
+private:
+    int m_typeId;
+
     QList<int> m_attributes;
 
     QHash<int, QString> m_attributeNames;
@@ -114,6 +127,8 @@ private:
     DefinitionInfo m_defaultView;
 
     int m_initialViewId;
+
+    mutable QHash<int, ViewPlan*> m_viewPlans;
 };
 
 #endif
@@ -19,10 +19,13 @@
 
 #include "query.h"
 
+#include "threadconnection.h"
+#include "utils/profiler.h"
+
 Query::Query( const QSqlDatabase& database ) :
     m_prepared( false ),
     m_valid( false ),
-    m_query( database )
+    m_query( ThreadConnection::database( database ) )
 {
     m_query.setForwardOnly( true );
 }
@@ -31,7 +34,7 @@ Query::Query( const QString& query, const QSqlDatabase& database ) :
     m_queryText( query ),
     m_prepared( false ),
     m_valid( false ),
-    m_query( database )
+    m_query( ThreadConnection::database( database ) )
 {
     m_query.setForwardOnly( true );
 }
@@ -52,7 +55,7 @@ bool Query::exec()
     if ( !ensurePrepared() )
         return false;
 
-    return m_query.exec();
+    return execPrepared();
 }
 
 bool Query::exec( const QVariant& p1 )
@@ -62,7 +65,7 @@ bool Query::exec( const QVariant& p1 )
 
     m_query.addBindValue( p1 );
 
-    return m_query.exec();
+    return execPrepared();
 }
 
 bool Query::exec( const QVariant& p1, const QVariant& p2 )
@@ -73,7 +76,7 @@ bool Query::exec( const QVariant& p1, const QVariant& p2 )
     m_query.addBindValue( p1 );
     m_query.addBindValue( p2 );
 
-    return m_query.exec();
+    return execPrepared();
 }
 
 bool Query::exec( const QVariant& p1, const QVariant& p2, const QVariant& p3 )
@@ -85,7 +88,7 @@ bool Query::exec( const QVariant& p1, const QVariant& p2, const QVariant& p3 )
     m_query.addBindValue( p2 );
     m_query.addBindValue( p3 );
 
-    return m_query.exec();
+    return execPrepared();
 }
 
 bool Query::exec( const QVariant& p1, const QVariant& p2, const QVariant& p3, const QVariant& p4 )
@@ -98,7 +101,7 @@ bool Query::exec( const QVariant& p1, const QVariant& p2, const QVariant& p3, co
     m_query.addBindValue( p3 );
     m_query.addBindValue( p4 );
 
-    return m_query.exec();
+    return execPrepared();
 }
 
 bool Query::exec( const QVariantList& params )
@@ -109,7 +112,7 @@ bool Query::exec( const QVariantList& params )
     foreach ( const QVariant& param, params )
         m_query.addBindValue( param );
 
-    return m_query.exec();
+    return execPrepared();
 }
 
 bool Query::execQuery( const QString& query )
@@ -164,6 +167,13 @@ bool Query::ensurePrepared()
     return m_valid;
 }
 
+bool Query::execPrepared()
+{
+    ProfilerScope scope( "Query::exec" );
+
+    return m_query.exec();
+}
+
 bool Query::next()
 {
     return m_valid && m_query.next();
@@ -132,6 +132,7 @@ public:
 
 private:
     bool ensurePrepared();
+    bool execPrepared();
 
 private:
     QString m_queryText;
@@ -0,0 +1,254 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "querythread.h"
+
+#include "sqlite/sqlitedriver.h"
+#include "utils/profiler.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+
+#if defined HAVE_SYSTEM_SQLITE
+# include <sqlite3.h>
+#else
+# include "sqlite/sqlite3.h"
+#endif
+
+QueryResult::QueryResult() :
+    m_valid( false ),
+    m_columns( 0 )
+{
+}
+
+QueryResult::~QueryResult()
+{
+}
+
+QVariant QueryResult::value( int row, int column ) const
+{
+    if ( row < 0 || column < 0 || column >= m_columns )
+        return QVariant();
+
+    return m_values.value( row * m_columns + column );
+}
+
+QueryResult QueryResult::filtered( const QVector<int>& rows ) const
+{
+    QueryResult result;
+    result.m_valid = m_valid;
+    result.m_columns = m_columns;
+
+    result.m_values.reserve( rows.count() * m_columns );
+
+    foreach ( int row, rows ) {
+        for ( int i = 0; i < m_columns; i++ )
+            result.m_values.append( m_values.at( row * m_columns + i ) );
+    }
+
+    return result;
+}
+
+static QStringList explainQuery( const QSqlDatabase& database, const QString& sql, const QList<QVariant>& arguments )
+{
+    QStringList plan;
+
+    QSqlQuery query( database );
+    query.setForwardOnly( true );
+
+    if ( !query.prepare( "EXPLAIN QUERY PLAN " + sql ) )
+        return plan;
+
+    foreach ( const QVariant& argument, arguments )
+        query.addBindValue( argument );
+
+    if ( !query.exec() )
+        return plan;
+
+    // the last column contains the description of each step
+    int column = query.record().count() - 1;
+
+    while ( query.next() )
+        plan.append( query.value( column ).toString() );
+
+    return plan;
+}
+
+QueryResult QueryResult::execute( const QSqlDatabase& database, const QString& sql, const QList<QVariant>& arguments )
+{
+    QueryResult result;
+
+    qint64 start = Profiler::isEnabled() ? Profiler::timestamp() : -1;
+
+    QSqlQuery query( database );
+    query.setForwardOnly( true );
+
+    if ( !query.prepare( sql ) )
+        return result;
+
+    foreach ( const QVariant& argument, arguments )
+        query.addBindValue( argument );
+
+    if ( !query.exec() )
+        return result;
+
+    result.m_columns = query.record().count();
+
+    while ( query.next() ) {
+        for ( int i = 0; i < result.m_columns; i++ )
+            result.m_values.append( query.value( i ) );
+    }
+
+    // an interrupted query stops returning rows and reports an error
+    result.m_valid = !query.lastError().isValid();
+
+    if ( start >= 0 && result.m_valid ) {
+        qint64 duration = Profiler::timestamp() - start;
+        Profiler::addEvent( "QueryResult::execute", start, duration );
+
+        // the plan is retrieved only once for each distinct query
+        QStringList plan;
+        if ( !Profiler::hasQueryPlan( sql ) )
+            plan = explainQuery( database, sql, arguments );
+
+        Profiler::addQuery( sql, plan, duration, result.rowCount() );
+    }
+
+    return result;
+}
+
+QueryThread::QueryThread( QObject* parent ) : QThread( parent ),
+    m_stop( false ),
+    m_serial( 0 ),
+    m_pendingSerial( 0 ),
+    m_handle( NULL ),
+    m_running( false )
+{
+    qRegisterMetaType<QueryResult>( "QueryResult" );
+
+    m_databaseName = QSqlDatabase::database().databaseName();
+
+    start( QThread::LowPriority );
+}
+
+QueryThread::~QueryThread()
+{
+    m_mutex.lock();
+    m_stop = true;
+    interrupt();
+    m_condition.wakeOne();
+    m_mutex.unlock();
+
+    wait();
+}
+
+int QueryThread::execute( const QString& sql, const QList<QVariant>& arguments )
+{
+    QMutexLocker locker( &m_mutex );
+
+    m_serial++;
+
+    m_pendingSerial = m_serial;
+    m_sql = sql;
+    m_arguments = arguments;
+
+    interrupt();
+    m_condition.wakeOne();
+
+    return m_serial;
+}
+
+void QueryThread::cancel()
+{
+    QMutexLocker locker( &m_mutex );
+
+    // the result of the current query will be discarded
+    m_serial++;
+    m_pendingSerial = 0;
+
+    interrupt();
+}
+
+void QueryThread::interrupt()
+{
+    if ( m_running && m_handle )
+        sqlite3_interrupt( m_handle );
+}
+
+void QueryThread::run()
+{
+    QString connectionName = QString( "QueryThread-%1" ).arg( (quintptr)this );
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase( new SQLiteDriver(), connectionName );
+        database.setDatabaseName( m_databaseName );
+
+        if ( database.open() ) {
+            // the database is in WAL mode, so each query reads the last committed
+            // snapshot and is not affected by a reply transaction in progress
+            QSqlQuery query( database );
+            query.exec( "PRAGMA query_only = 1" );
+
+            QVariant handle = database.driver()->handle();
+
+            m_mutex.lock();
+
+            if ( qstrcmp( handle.typeName(), "sqlite3*" ) == 0 )
+                m_handle = *static_cast<sqlite3**>( handle.data() );
+
+            for ( ;; ) {
+                while ( !m_stop && m_pendingSerial == 0 )
+                    m_condition.wait( &m_mutex );
+
+                if ( m_stop )
+                    break;
+
+                int serial = m_pendingSerial;
+                QString sql = m_sql;
+                QList<QVariant> arguments = m_arguments;
+
+                m_pendingSerial = 0;
+                m_running = true;
+
+                m_mutex.unlock();
+
+                QueryResult result = QueryResult::execute( database, sql, arguments );
+
+                m_mutex.lock();
+
+                m_running = false;
+
+                // do not report results which were cancelled or replaced by a newer request;
+                // a failed query is reported as an empty result
+                if ( !m_stop && serial == m_serial )
+                    emit queryFinished( serial, result );
+            }
+
+            m_handle = NULL;
+
+            m_mutex.unlock();
+        }
+
+        database.close();
+    }
+
+    QSqlDatabase::removeDatabase( connectionName );
+}
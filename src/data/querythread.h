@@ -0,0 +1,161 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef QUERYTHREAD_H
+#define QUERYTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QVariant>
+#include <QMetaType>
+
+class QSqlDatabase;
+
+struct sqlite3;
+
+/**
+* Rows retrieved by a query, stored row by row.
+*/
+class QueryResult
+{
+public:
+    /**
+    * Default constructor.
+    */
+    QueryResult();
+
+    /**
+    * Destructor.
+    */
+    ~QueryResult();
+
+public:
+    /**
+    * Return @c true if the query was executed successfully.
+    */
+    bool isValid() const { return m_valid; }
+
+    /**
+    * Return the number of rows.
+    */
+    int rowCount() const { return m_columns > 0 ? m_values.count() / m_columns : 0; }
+
+    /**
+    * Return the number of columns.
+    */
+    int columnCount() const { return m_columns; }
+
+    /**
+    * Return the value of the given cell.
+    */
+    QVariant value( int row, int column ) const;
+
+    /**
+    * Return a result containing only the given rows.
+    * @param rows Indexes of rows to copy, in ascending order.
+    */
+    QueryResult filtered( const QVector<int>& rows ) const;
+
+public:
+    /**
+    * Execute the query and retrieve all rows.
+    * @param database The database connection to use.
+    * @param sql The SQL query to execute.
+    * @param arguments The bind arguments of the query.
+    */
+    static QueryResult execute( const QSqlDatabase& database, const QString& sql, const QList<QVariant>& arguments );
+
+private:
+    bool m_valid;
+    int m_columns;
+    QVector<QVariant> m_values;
+};
+
+Q_DECLARE_METATYPE( QueryResult )
+
+/**
+* Thread executing queries using a separate database connection.
+*
+* Only one query is executed at a time. Requesting a new query interrupts
+* the query which is currently executed and its results are discarded.
+*/
+class QueryThread : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param parent The parent object.
+    */
+    QueryThread( QObject* parent );
+
+    /**
+    * Destructor.
+    */
+    ~QueryThread();
+
+public:
+    /**
+    * Request executing a query, cancelling the previous query.
+    * @param sql The SQL query to execute.
+    * @param arguments The bind arguments of the query.
+    * @return The serial number of the request.
+    */
+    int execute( const QString& sql, const QList<QVariant>& arguments );
+
+    /**
+    * Cancel the query which is currently executed.
+    */
+    void cancel();
+
+signals:
+    /**
+    * Emitted when the most recently requested query is finished.
+    * @param serial The serial number of the request.
+    * @param result The rows retrieved by the query.
+    */
+    void queryFinished( int serial, const QueryResult& result );
+
+protected: // overrides
+    void run();
+
+private:
+    void interrupt();
+
+private:
+    QString m_databaseName;
+
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+
+    bool m_stop;
+
+    int m_serial;
+    int m_pendingSerial;
+
+    QString m_sql;
+    QList<QVariant> m_arguments;
+
+    sqlite3* m_handle;
+    bool m_running;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "threadconnection.h"
+
+#include "sqlite/sqlitedriver.h"
+
+#include <QSqlQuery>
+#include <QThreadStorage>
+#include <QAtomicInt>
+
+static QThreadStorage<QString> connectionNames;
+
+// the thread storage is only checked when at least one connection exists
+static QAtomicInt connectionsCount;
+
+ThreadConnection::ThreadConnection( const QString& databaseName ) :
+    m_open( false )
+{
+    m_name = QString( "ThreadConnection-%1" ).arg( (quintptr)this );
+
+    QSqlDatabase database = QSqlDatabase::addDatabase( new SQLiteDriver(), m_name );
+    database.setDatabaseName( databaseName );
+
+    if ( database.open() ) {
+        // workers only read committed data; in WAL mode they do not block the main connection
+        QSqlQuery query( database );
+        query.exec( "PRAGMA query_only = 1" );
+
+        connectionNames.setLocalData( m_name );
+        connectionsCount.ref();
+
+        m_open = true;
+    }
+}
+
+ThreadConnection::~ThreadConnection()
+{
+    if ( m_open ) {
+        connectionNames.setLocalData( QString() );
+        connectionsCount.deref();
+    }
+
+    {
+        QSqlDatabase database = QSqlDatabase::database( m_name, false );
+        database.close();
+    }
+
+    QSqlDatabase::removeDatabase( m_name );
+}
+
+QSqlDatabase ThreadConnection::database( const QSqlDatabase& database )
+{
+    if ( database.isValid() || connectionsCount.load() == 0 || !connectionNames.hasLocalData() )
+        return database;
+
+    QString name = connectionNames.localData();
+    if ( name.isEmpty() )
+        return database;
+
+    return QSqlDatabase::database( name, false );
+}
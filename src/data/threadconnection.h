@@ -0,0 +1,69 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef THREADCONNECTION_H
+#define THREADCONNECTION_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+/**
+* Read-only database connection used by a worker thread.
+*
+* While the connection is open, queries created in the same thread without
+* an explicit database use this connection instead of the default one,
+* so that entities can be read outside of the main thread. The connection
+* must be created and destroyed in the worker thread.
+*/
+class ThreadConnection
+{
+public:
+    /**
+    * Constructor.
+    * @param databaseName Path of the database file, which must be retrieved
+    * from the default connection in the main thread.
+    */
+    ThreadConnection( const QString& databaseName );
+
+    /**
+    * Destructor.
+    */
+    ~ThreadConnection();
+
+public:
+    /**
+    * Return @c true if the connection was opened successfully.
+    */
+    bool isOpen() const { return m_open; }
+
+public:
+    /**
+    * Return the connection used by queries in the current thread.
+    * @param database The database specified by the query.
+    * @return The given database if it is valid, otherwise the connection
+    * of the current thread or the default connection.
+    */
+    static QSqlDatabase database( const QSqlDatabase& database );
+
+private:
+    QString m_name;
+    bool m_open;
+};
+
+#endif
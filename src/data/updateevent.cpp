@@ -19,12 +19,22 @@
 
 #include "updateevent.h"
 
-UpdateEvent::UpdateEvent( Unit unit, int id ) : QEvent( (QEvent::Type)Type ),
-    m_unit( unit ),
-    m_id( id )
+UpdateEvent::UpdateEvent( Unit unit, int id ) : QEvent( (QEvent::Type)Type )
 {
+    add( unit, id );
 }
 
 UpdateEvent::~UpdateEvent()
 {
 }
+
+void UpdateEvent::add( Unit unit, int id )
+{
+    m_units[ unit ].insert( id );
+}
+
+bool UpdateEvent::contains( Unit unit, int id ) const
+{
+    QMap<Unit, QSet<int> >::const_iterator it = m_units.find( unit );
+    return it != m_units.constEnd() && it.value().contains( id );
+}
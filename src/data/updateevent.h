@@ -21,12 +21,17 @@
 #define UPDATEEVENT_H
 
 #include <QEvent>
+#include <QMap>
+#include <QSet>
 
 /**
 * Event sent to data observers when data is updated.
 *
 * Use DataManager::addObserver() to receive update events and DataManager::removeObserver()
 * to stop receiving them.
+*
+* Notifications posted during a single iteration of the event loop are merged,
+* so a single event may contain multiple units of data and identifiers.
 */
 class UpdateEvent : public QEvent
 {
@@ -80,18 +85,34 @@ public:
 
 public:
     /**
-    * Return the unit of data which was updated.
+    * Add an updated unit of data to the event.
+    * @param unit Unit of data which was updated.
+    * @param id Identifier of the updated folder or issue.
+    */
+    void add( Unit unit, int id );
+
+    /**
+    * Return @c true if the event contains no updates.
+    */
+    bool isEmpty() const { return m_units.isEmpty(); }
+
+    /**
+    * Return @c true if the given unit of data was updated.
+    */
+    bool contains( Unit unit ) const { return m_units.contains( unit ); }
+
+    /**
+    * Return @c true if the given unit of data was updated for the given identifier.
     */
-    Unit unit() const { return m_unit; }
+    bool contains( Unit unit, int id ) const;
 
     /**
-    * Return the identifier of the updated folder or issue.
+    * Return identifiers of updated folders or issues for the given unit of data.
     */
-    int id() const { return m_id; }
+    QList<int> ids( Unit unit ) const { return m_units.value( unit ).toList(); }
 
 private:
-    Unit m_unit;
-    int m_id;
+    QMap<Unit, QSet<int> > m_units;
 };
 
 #endif
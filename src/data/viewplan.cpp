@@ -0,0 +1,68 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "viewplan.h"
+
+#include "models/foldermodel.h"
+
+QueryArgument::QueryArgument( Source source, const QVariant& value, Conversion conversion ) :
+    m_source( source ),
+    m_value( value ),
+    m_conversion( conversion ),
+    m_userValue( false ),
+    m_local( false )
+{
+}
+
+QueryArgument::~QueryArgument()
+{
+}
+
+QueryTemplate::QueryTemplate() :
+    m_valid( false ),
+    m_cacheable( true ),
+    m_projectColumn( -1 )
+{
+}
+
+QueryTemplate::~QueryTemplate()
+{
+}
+
+ViewFilter::ViewFilter() :
+    m_column( 0 ),
+    m_attributeType( InvalidAttribute ),
+    m_local( false )
+{
+}
+
+ViewFilter::~ViewFilter()
+{
+}
+
+ViewPlan::ViewPlan() :
+    m_valid( false ),
+    m_sortColumn( Column_ID ),
+    m_sortOrder( Qt::AscendingOrder )
+{
+}
+
+ViewPlan::~ViewPlan()
+{
+}
@@ -0,0 +1,174 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef VIEWPLAN_H
+#define VIEWPLAN_H
+
+#include "utils/attributehelper.h"
+
+#include <QStringList>
+#include <QVariant>
+#include <QHash>
+
+/**
+* Argument of a query template which is evaluated when the query is bound.
+*/
+class QueryArgument
+{
+public:
+    /**
+    * Source of the value of the argument.
+    */
+    enum Source
+    {
+        /** A constant value. */
+        Constant,
+        /** Identifier of the current user. */
+        CurrentUserId,
+        /** Identifier of the folder. */
+        FolderId,
+        /** Identifier of the issue type. */
+        TypeId,
+        /** Identifier of the project. */
+        ProjectId,
+        /** The quick search text. */
+        SearchText,
+        /** The first second of the given date. */
+        DateLower,
+        /** The last second of the given date. */
+        DateUpper
+    };
+
+    /**
+    * Conversion applied to the value of the argument.
+    */
+    enum Conversion
+    {
+        NoConversion,
+        ToInteger,
+        ToDouble,
+        ContainsPattern,
+        BeginsPattern,
+        EndsPattern
+    };
+
+public:
+    /**
+    * Constructor.
+    */
+    QueryArgument( Source source = Constant, const QVariant& value = QVariant(), Conversion conversion = NoConversion );
+
+    /**
+    * Destructor.
+    */
+    ~QueryArgument();
+
+public:
+    Source m_source;
+    QVariant m_value;
+    Conversion m_conversion;
+    bool m_userValue;
+    bool m_local;
+};
+
+/**
+* Generated SQL query with placeholders for the arguments.
+*/
+class QueryTemplate
+{
+public:
+    /**
+    * Constructor.
+    */
+    QueryTemplate();
+
+    /**
+    * Destructor.
+    */
+    ~QueryTemplate();
+
+public:
+    bool m_valid;
+    bool m_cacheable;
+
+    QString m_sql;
+    QList<QueryArgument> m_arguments;
+
+    QList<QStringList> m_sortColumns;
+
+    int m_projectColumn;
+};
+
+/**
+* Filter condition of a view with the value type resolved.
+*/
+class ViewFilter
+{
+public:
+    /**
+    * Constructor.
+    */
+    ViewFilter();
+
+    /**
+    * Destructor.
+    */
+    ~ViewFilter();
+
+public:
+    int m_column;
+    QString m_operator;
+    QString m_value;
+
+    AttributeType m_attributeType;
+    bool m_local;
+};
+
+/**
+* Precompiled information about a view of an issue type.
+*
+* The plan contains the columns, filters and sort order of the view and
+* the query templates generated for it by the QueryGenerator.
+*/
+class ViewPlan
+{
+public:
+    /**
+    * Constructor.
+    */
+    ViewPlan();
+
+    /**
+    * Destructor.
+    */
+    ~ViewPlan();
+
+public:
+    bool m_valid;
+
+    QList<int> m_columns;
+    QList<ViewFilter> m_filters;
+
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+
+    mutable QHash<int, QueryTemplate> m_templates;
+};
+
+#endif
@@ -13,6 +13,7 @@ HEADERS += dialogs/aboutbox.h \
            dialogs/messagebox.h \
            dialogs/metadatadialog.h \
            dialogs/preferencesdialog.h \
+           dialogs/profilerdialog.h \
            dialogs/projectdialogs.h \
            dialogs/reportdialog.h \
            dialogs/settingsdialog.h \
@@ -38,6 +39,7 @@ SOURCES += dialogs/aboutbox.cpp \
            dialogs/messagebox.cpp \
            dialogs/metadatadialog.cpp \
            dialogs/preferencesdialog.cpp \
+           dialogs/profilerdialog.cpp \
            dialogs/projectdialogs.cpp \
            dialogs/reportdialog.cpp \
            dialogs/settingsdialog.cpp \
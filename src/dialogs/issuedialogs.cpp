@@ -977,6 +977,8 @@ bool GetAttachmentDialog::batchSuccessful( AbstractBatch* batch )
         return false;
     }
 
+    m_fileHash = ( (IssueBatch*)batch )->fileHash();
+
     return true;
 }
 
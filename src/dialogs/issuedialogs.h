@@ -462,6 +462,11 @@ public:
     */
     void download();
 
+    /**
+    * Return the hash of the file reported by the server, if any.
+    */
+    const QByteArray& fileHash() const { return m_fileHash; }
+
 public: // overrides
     void accept();
 
@@ -476,6 +481,8 @@ private:
 
     QString m_path;
     int m_size;
+
+    QByteArray m_fileHash;
 };
 
 /**
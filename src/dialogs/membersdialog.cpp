@@ -167,7 +167,7 @@ void MembersDialog::customEvent( QEvent* e )
 {
     if ( e->type() == UpdateEvent::Type ) {
         UpdateEvent* updateEvent = (UpdateEvent*)e;
-        if ( updateEvent->unit() == UpdateEvent::Projects )
+        if ( updateEvent->contains( UpdateEvent::Projects ) )
             updateGlobalAccess();
     }
 }
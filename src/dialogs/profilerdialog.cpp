@@ -0,0 +1,202 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+#include "profilerdialog.h"
+
+#include "application.h"
+#include "data/localsettings.h"
+#include "dialogs/messagebox.h"
+#include "utils/iconloader.h"
+#include "utils/profiler.h"
+
+#include <QLayout>
+#include <QLabel>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QTabWidget>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+
+ProfilerDialog::ProfilerDialog( QWidget* parent ) : InformationDialog( parent )
+{
+    setWindowTitle( tr( "Performance Profiler" ) );
+    setPromptPixmap( IconLoader::pixmap( "status-info", 22 ) );
+    setPrompt( tr( "Time spent in instrumented operations since profiling was enabled:" ) );
+
+    QVBoxLayout* layout = new QVBoxLayout();
+
+    m_enableCheckBox = new QCheckBox( tr( "&Enable profiling" ), this );
+    m_enableCheckBox->setChecked( Profiler::isEnabled() );
+    layout->addWidget( m_enableCheckBox );
+
+    connect( m_enableCheckBox, SIGNAL( toggled( bool ) ), this, SLOT( enableToggled( bool ) ) );
+
+    QTabWidget* tabWidget = new QTabWidget( this );
+    layout->addWidget( tabWidget );
+
+    m_list = new QTreeWidget( tabWidget );
+    m_list->setRootIsDecorated( false );
+    m_list->setSortingEnabled( true );
+    m_list->setHeaderLabels( QStringList() << tr( "Name" ) << tr( "Calls" ) << tr( "Total (ms)" ) << tr( "Average (ms)" ) << tr( "Maximum (ms)" ) );
+    tabWidget->addTab( m_list, tr( "Operations" ) );
+
+    // each query can be expanded to show its plan
+    m_queriesList = new QTreeWidget( tabWidget );
+    m_queriesList->setSortingEnabled( true );
+    m_queriesList->setHeaderLabels( QStringList() << tr( "Query" ) << tr( "Calls" ) << tr( "Total (ms)" ) << tr( "Average (ms)" ) << tr( "Maximum (ms)" ) << tr( "Rows" ) );
+    tabWidget->addTab( m_queriesList, tr( "List Queries" ) );
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+
+    m_memoryLabel = new QLabel( this );
+    buttonLayout->addWidget( m_memoryLabel );
+
+    buttonLayout->addStretch();
+
+    QPushButton* refreshButton = new QPushButton( tr( "&Refresh" ), this );
+    refreshButton->setIcon( IconLoader::icon( "file-reload" ) );
+    refreshButton->setIconSize( QSize( 16, 16 ) );
+    buttonLayout->addWidget( refreshButton );
+
+    QPushButton* clearButton = new QPushButton( tr( "&Clear" ), this );
+    clearButton->setIcon( IconLoader::icon( "edit-delete" ) );
+    clearButton->setIconSize( QSize( 16, 16 ) );
+    buttonLayout->addWidget( clearButton );
+
+    QPushButton* exportButton = new QPushButton( tr( "E&xport Trace..." ), this );
+    exportButton->setIcon( IconLoader::icon( "file-save-as" ) );
+    exportButton->setIconSize( QSize( 16, 16 ) );
+    buttonLayout->addWidget( exportButton );
+
+    layout->addLayout( buttonLayout );
+
+    connect( refreshButton, SIGNAL( clicked() ), this, SLOT( refresh() ) );
+    connect( clearButton, SIGNAL( clicked() ), this, SLOT( clear() ) );
+    connect( exportButton, SIGNAL( clicked() ), this, SLOT( exportTrace() ) );
+
+    setContentLayout( layout, false );
+
+    setDialogSizeKey( "ProfilerDialog" );
+
+    resize( 640, 400 );
+
+    refresh();
+}
+
+ProfilerDialog::~ProfilerDialog()
+{
+}
+
+void ProfilerDialog::enableToggled( bool on )
+{
+    Profiler::setEnabled( on );
+}
+
+// times are stored as numbers so that the columns are sorted numerically
+static double toMilliseconds( qint64 microseconds )
+{
+    return microseconds / 1000.0;
+}
+
+void ProfilerDialog::refresh()
+{
+    m_list->clear();
+
+    foreach ( const Profiler::Statistics& statistics, Profiler::statistics() ) {
+        QTreeWidgetItem* item = new QTreeWidgetItem( m_list );
+        item->setText( 0, QString::fromLatin1( statistics.m_name ) );
+        item->setData( 1, Qt::DisplayRole, statistics.m_count );
+
+        // counters are displayed as raw values
+        if ( statistics.m_counter ) {
+            item->setData( 2, Qt::DisplayRole, statistics.m_total );
+            item->setData( 3, Qt::DisplayRole, static_cast<double>( statistics.m_total ) / statistics.m_count );
+            item->setData( 4, Qt::DisplayRole, statistics.m_maximum );
+        } else {
+            item->setData( 2, Qt::DisplayRole, toMilliseconds( statistics.m_total ) );
+            item->setData( 3, Qt::DisplayRole, toMilliseconds( statistics.m_total / statistics.m_count ) );
+            item->setData( 4, Qt::DisplayRole, toMilliseconds( statistics.m_maximum ) );
+        }
+
+        for ( int i = 1; i < 5; i++ )
+            item->setTextAlignment( i, Qt::AlignRight | Qt::AlignVCenter );
+    }
+
+    m_list->sortByColumn( 2, Qt::DescendingOrder );
+    m_list->header()->resizeSections( QHeaderView::ResizeToContents );
+
+    m_queriesList->clear();
+
+    foreach ( const Profiler::QueryStatistics& statistics, Profiler::queryStatistics() ) {
+        QTreeWidgetItem* item = new QTreeWidgetItem( m_queriesList );
+        item->setText( 0, statistics.m_sql.simplified() );
+        item->setToolTip( 0, statistics.m_sql );
+        item->setData( 1, Qt::DisplayRole, statistics.m_count );
+        item->setData( 2, Qt::DisplayRole, toMilliseconds( statistics.m_total ) );
+        item->setData( 3, Qt::DisplayRole, toMilliseconds( statistics.m_total / statistics.m_count ) );
+        item->setData( 4, Qt::DisplayRole, toMilliseconds( statistics.m_maximum ) );
+        item->setData( 5, Qt::DisplayRole, statistics.m_rows );
+
+        for ( int i = 1; i < 6; i++ )
+            item->setTextAlignment( i, Qt::AlignRight | Qt::AlignVCenter );
+
+        foreach ( const QString& step, statistics.m_plan ) {
+            QTreeWidgetItem* stepItem = new QTreeWidgetItem( item );
+            stepItem->setText( 0, step );
+        }
+    }
+
+    m_queriesList->sortByColumn( 2, Qt::DescendingOrder );
+    m_queriesList->header()->resizeSection( 0, 400 );
+
+    qint64 memory = Profiler::peakMemoryUsage();
+    if ( memory >= 0 )
+        m_memoryLabel->setText( tr( "Peak memory usage: %1 MB" ).arg( QString::number( memory / 1024.0, 'f', 1 ) ) );
+    else
+        m_memoryLabel->setText( tr( "Peak memory usage: unknown" ) );
+}
+
+void ProfilerDialog::clear()
+{
+    Profiler::clear();
+
+    refresh();
+}
+
+void ProfilerDialog::exportTrace()
+{
+    LocalSettings* settings = application->applicationSettings();
+    QString dir = settings->value( "SaveReportPath", QDir::homePath() ).toString();
+
+    QString path = QFileDialog::getSaveFileName( this, tr( "Export Trace" ), dir, tr( "JSON Files (*.json)" ) );
+    if ( path.isEmpty() )
+        return;
+
+    QFileInfo fileInfo( path );
+    if ( fileInfo.suffix().isEmpty() )
+        path += ".json";
+    settings->setValue( "SaveReportPath", fileInfo.absoluteDir().path() );
+
+    QFile file( path );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) || file.write( Profiler::toTraceEvents() ) < 0 )
+        MessageBox::warning( this, tr( "Warning" ), tr( "File could not be saved." ) );
+}
@@ -0,0 +1,65 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef PROFILERDIALOG_H
+#define PROFILERDIALOG_H
+
+#include "dialogs/informationdialog.h"
+
+class QCheckBox;
+class QTreeWidget;
+class QLabel;
+
+/**
+* Dialog displaying statistics collected by the Profiler.
+*
+* The dialog can be used to enable profiling, view the aggregated time
+* spent in instrumented operations and export the recorded events
+* in the Chrome trace event format.
+*/
+class ProfilerDialog : public InformationDialog
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param parent The parent widget.
+    */
+    ProfilerDialog( QWidget* parent );
+
+    /**
+    * Destructor.
+    */
+    ~ProfilerDialog();
+
+private slots:
+    void enableToggled( bool on );
+
+    void refresh();
+    void clear();
+    void exportTrace();
+
+private:
+    QCheckBox* m_enableCheckBox;
+    QTreeWidget* m_list;
+    QTreeWidget* m_queriesList;
+    QLabel* m_memoryLabel;
+};
+
+#endif
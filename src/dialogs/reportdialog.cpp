@@ -38,11 +38,11 @@
 #include <QWebFrame>
 #include <QPrintDialog>
 #include <QFileDialog>
-#include <QTextStream>
-#include <QTextCodec>
 #include <QSettings>
 #include <QPrinter>
 #include <QPrintPreviewDialog>
+#include <QProgressDialog>
+#include <QTemporaryFile>
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QAction>
@@ -58,8 +58,11 @@ ReportDialog::ReportDialog( SourceType source, ReportMode mode, QWidget* parent
     m_fullTableButton( NULL ),
     m_summaryButton( NULL ),
     m_fullReportButton( NULL ),
+    m_previewButton( NULL ),
+    m_writing( false ),
     m_page( NULL ),
-    m_pdfPrinter( NULL )
+    m_pdfPrinter( NULL ),
+    m_pdfFile( NULL )
 {
     if ( source == FolderSource ) {
         m_tableButton = new QRadioButton( tr( "Table with visible columns only" ), this );
@@ -96,12 +99,12 @@ ReportDialog::ReportDialog( SourceType source, ReportMode mode, QWidget* parent
             layout->addLayout( optionsLayout );
 
         if ( mode == Print ) {
-            QPushButton* previewButton = new QPushButton( tr( "&Print Preview..." ), this );
-            previewButton->setIcon( IconLoader::icon( "print-preview" ) );
-            previewButton->setIconSize( QSize( 16, 16 ) );
-            layout->addWidget( previewButton, 0, Qt::AlignBottom | Qt::AlignRight );
+            m_previewButton = new QPushButton( tr( "&Print Preview..." ), this );
+            m_previewButton->setIcon( IconLoader::icon( "print-preview" ) );
+            m_previewButton->setIconSize( QSize( 16, 16 ) );
+            layout->addWidget( m_previewButton, 0, Qt::AlignBottom | Qt::AlignRight );
 
-            connect( previewButton, SIGNAL( clicked() ), this, SLOT( showPreview() ) );
+            connect( m_previewButton, SIGNAL( clicked() ), this, SLOT( showPreview() ) );
         }
 
         setContentLayout( layout, true );
@@ -202,6 +205,10 @@ void ReportDialog::setAvailableColumns( const QList<int>& columns )
 
 void ReportDialog::accept()
 {
+    // the progress dialog processes events while the report is written
+    if ( m_writing || m_page )
+        return;
+
     switch ( m_mode ) {
         case Print:
             print();
@@ -231,13 +238,15 @@ void ReportDialog::print()
     if ( dialog.exec() != QDialog::Accepted )
         return;
 
-    QString html = generateHtmlReport( false );
+    HtmlWriter writer;
+    if ( !writeHtmlReport( &writer ) )
+        return;
 
     m_page = new QWebPage( this );
 
     connect( m_page->mainFrame(), SIGNAL( loadFinished( bool ) ), this, SLOT( printReady() ) );
 
-    m_page->mainFrame()->setHtml( html );
+    m_page->mainFrame()->setContent( writer.toUtf8(), "text/html" );
 }
 
 void ReportDialog::printReady()
@@ -265,11 +274,16 @@ void ReportDialog::exportCsv()
         return;
     }
 
-    QTextStream stream( &file );
-    stream.setCodec( QTextCodec::codecForName( "UTF-8" ) );
-    stream.setGenerateByteOrderMark( true );
+    // write the UTF-8 byte order mark
+    file.write( "\xef\xbb\xbf" );
+
+    CsvWriter writer;
+    writer.setDevice( &file );
 
-    stream << generateCsvReport();
+    if ( !writeCsvReport( &writer ) ) {
+        file.remove();
+        return;
+    }
 
     QDialog::accept();
 }
@@ -287,10 +301,16 @@ void ReportDialog::exportHtml()
         return;
     }
 
-    QTextStream stream( &file );
-    stream.setCodec( QTextCodec::codecForName( "UTF-8" ) );
+    HtmlWriter writer;
+    writer.setEmbedded( true );
+    writer.setDevice( &file );
+
+    if ( !writeHtmlReport( &writer ) ) {
+        file.remove();
+        return;
+    }
 
-    stream << generateHtmlReport( true );
+    writer.endDocument();
 
     QDialog::accept();
 }
@@ -309,13 +329,33 @@ void ReportDialog::exportPdf()
     m_pdfPrinter->setOutputFileName( fileName );
     m_pdfPrinter->setOutputFormat( QPrinter::PdfFormat );
 
-    QString html = generateHtmlReport( false );
+    // the report is written to a temporary file instead of being kept in memory
+    m_pdfFile = new QTemporaryFile( QDir::tempPath() + "/webissues-XXXXXX.html", this );
+
+    HtmlWriter writer;
+
+    bool ok = m_pdfFile->open();
+    if ( ok ) {
+        writer.setDevice( m_pdfFile );
+        ok = writeHtmlReport( &writer );
+    }
+
+    if ( !ok ) {
+        delete m_pdfFile;
+        m_pdfFile = NULL;
+        delete m_pdfPrinter;
+        m_pdfPrinter = NULL;
+        return;
+    }
+
+    writer.endDocument();
+    m_pdfFile->close();
 
     m_page = new QWebPage( this );
 
     connect( m_page->mainFrame(), SIGNAL( loadFinished( bool ) ), this, SLOT( pdfReady() ) );
 
-    m_page->mainFrame()->setHtml( html );
+    m_page->mainFrame()->load( QUrl::fromLocalFile( m_pdfFile->fileName() ) );
 }
 
 void ReportDialog::pdfReady()
@@ -325,6 +365,9 @@ void ReportDialog::pdfReady()
     delete m_pdfPrinter;
     m_pdfPrinter = NULL;
 
+    delete m_pdfFile;
+    m_pdfFile = NULL;
+
     m_page->deleteLater();
     m_page = NULL;
 
@@ -333,19 +376,21 @@ void ReportDialog::pdfReady()
 
 void ReportDialog::showPreview()
 {
-    if ( m_page )
+    if ( m_writing || m_page )
         return;
 
     QPrinter* printer = application->printer();
     printer->setFromTo( 0, 0 );
 
-    QString html = generateHtmlReport( false );
+    HtmlWriter writer;
+    if ( !writeHtmlReport( &writer ) )
+        return;
 
     m_page = new QWebPage( this );
 
     connect( m_page->mainFrame(), SIGNAL( loadFinished( bool ) ), this, SLOT( previewReady() ) );
 
-    m_page->mainFrame()->setHtml( html );
+    m_page->mainFrame()->setContent( writer.toUtf8(), "text/html" );
 }
 
 void ReportDialog::previewReady()
@@ -378,7 +423,7 @@ void ReportDialog::previewReady()
         QDialog::accept();
 }
 
-QString ReportDialog::generateCsvReport()
+bool ReportDialog::writeCsvReport( CsvWriter* writer )
 {
     ReportGenerator generator;
 
@@ -392,48 +437,84 @@ QString ReportDialog::generateCsvReport()
     else if ( m_fullTableButton->isChecked() )
         generator.setTableMode( m_availableColumns );
 
-    CsvWriter writer;
-    generator.write( &writer );
+    QProgressDialog progress( this );
+    initializeProgress( &progress, &generator );
+
+    setWriting( true );
+    bool result = generator.write( writer );
+    setWriting( false );
 
-    return writer.toString();
+    if ( !result && !generator.isCanceled() )
+        MessageBox::warning( this, tr( "Warning" ), tr( "Report could not be generated." ) );
+
+    return result;
 }
 
-QString ReportDialog::generateHtmlReport( bool embedded )
+bool ReportDialog::writeHtmlReport( HtmlWriter* writer )
 {
-    HtmlWriter writer;
-    writer.setEmbedded( embedded );
-
     if ( m_source == ProjectSource ) {
         ProjectSummaryGenerator generator;
         generator.setProject( m_projectId );
 
-        writer.setTitle( generator.title() );
-        generator.write( &writer, HtmlText::NoInternalLinks );
-    } else {
-        ReportGenerator generator;
-
-        if ( m_source == FolderSource ) {
-            if ( m_folderId != 0 )
-                generator.setFolderSource( m_folderId, m_issues );
-            else if ( m_typeId != 0 )
-                generator.setGlobalListSource( m_typeId, m_issues );
-
-            if ( m_tableButton->isChecked() )
-                generator.setTableMode( m_currentColumns );
-            else if ( m_fullTableButton->isChecked() )
-                generator.setTableMode( m_availableColumns );
-            else
-                generator.setSummaryMode( false, IssueDetailsGenerator::NoHistory );
-        } else if ( m_source == IssueSource && !m_issues.isEmpty() ) {
-            generator.setIssueSource( m_issues.first() );
-            generator.setSummaryMode( true, m_fullReportButton->isChecked() ? m_history : IssueDetailsGenerator::NoHistory );
-        }
+        writer->setTitle( generator.title() );
+        generator.write( writer, HtmlText::NoInternalLinks );
+
+        return true;
+    }
+
+    ReportGenerator generator;
 
-        writer.setTitle( generator.title() );
-        generator.write( &writer );
+    if ( m_source == FolderSource ) {
+        if ( m_folderId != 0 )
+            generator.setFolderSource( m_folderId, m_issues );
+        else if ( m_typeId != 0 )
+            generator.setGlobalListSource( m_typeId, m_issues );
+
+        if ( m_tableButton->isChecked() )
+            generator.setTableMode( m_currentColumns );
+        else if ( m_fullTableButton->isChecked() )
+            generator.setTableMode( m_availableColumns );
+        else
+            generator.setSummaryMode( false, IssueDetailsGenerator::NoHistory );
+    } else if ( m_source == IssueSource && !m_issues.isEmpty() ) {
+        generator.setIssueSource( m_issues.first() );
+        generator.setSummaryMode( true, m_fullReportButton->isChecked() ? m_history : IssueDetailsGenerator::NoHistory );
     }
 
-    return writer.toHtml();
+    writer->setTitle( generator.title() );
+
+    QProgressDialog progress( this );
+    initializeProgress( &progress, &generator );
+
+    setWriting( true );
+    bool result = generator.write( writer );
+    setWriting( false );
+
+    if ( !result && !generator.isCanceled() )
+        MessageBox::warning( this, tr( "Warning" ), tr( "Report could not be generated." ) );
+
+    return result;
+}
+
+void ReportDialog::initializeProgress( QProgressDialog* dialog, ReportGenerator* generator )
+{
+    dialog->setWindowTitle( windowTitle() );
+    dialog->setLabelText( tr( "Generating report..." ) );
+    dialog->setRange( 0, m_issues.count() );
+    dialog->setMinimumDuration( 1000 );
+    dialog->setWindowModality( Qt::WindowModal );
+
+    connect( generator, SIGNAL( progress( int ) ), dialog, SLOT( setValue( int ) ) );
+    connect( dialog, SIGNAL( canceled() ), generator, SLOT( cancel() ) );
+}
+
+void ReportDialog::setWriting( bool writing )
+{
+    m_writing = writing;
+
+    buttonBox()->setEnabled( !writing );
+    if ( m_previewButton )
+        m_previewButton->setEnabled( !writing );
 }
 
 QString ReportDialog::getReportFileName( const QString& extension, const QString& filter )
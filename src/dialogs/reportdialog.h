@@ -23,9 +23,16 @@
 #include "dialogs/commanddialog.h"
 #include "models/issuedetailsgenerator.h"
 
+class ReportGenerator;
+class HtmlWriter;
+class CsvWriter;
+
 class QRadioButton;
+class QPushButton;
 class QWebPage;
 class QPrinter;
+class QProgressDialog;
+class QTemporaryFile;
 
 /**
 * Dialog for printing or exporting a report.
@@ -133,8 +140,12 @@ private:
     void exportHtml();
     void exportPdf();
 
-    QString generateCsvReport();
-    QString generateHtmlReport( bool embedded );
+    bool writeCsvReport( CsvWriter* writer );
+    bool writeHtmlReport( HtmlWriter* writer );
+
+    void initializeProgress( QProgressDialog* dialog, ReportGenerator* generator );
+
+    void setWriting( bool writing );
 
     QString getReportFileName( const QString& extension, const QString& filter );
 
@@ -157,9 +168,14 @@ private:
     QRadioButton* m_summaryButton;
     QRadioButton* m_fullReportButton;
 
+    QPushButton* m_previewButton;
+
+    bool m_writing;
+
     QWebPage* m_page;
 
     QPrinter* m_pdfPrinter;
+    QTemporaryFile* m_pdfFile;
 };
 
 #endif
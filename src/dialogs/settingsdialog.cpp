@@ -97,6 +97,8 @@ SettingsDialog::SettingsDialog( QWidget* parent ) : CommandDialog( parent )
 
     m_ui.attachmentsComboBox->setCurrentIndex( settings->value( "DefaultAttachmentAction" ).toInt() );
 
+    m_ui.cacheSpinBox->setValue( settings->value( "AttachmentsCacheSize" ).toInt() );
+
     m_ui.foldersSpinBox->setValue( settings->value( "FolderUpdateInterval" ).toInt() );
     m_ui.fullSpinBox->setValue( settings->value( "UpdateInterval" ).toInt() );
 
@@ -151,6 +153,8 @@ bool SettingsDialog::apply()
 
     settings->setValue( "DefaultAttachmentAction", m_ui.attachmentsComboBox->currentIndex() );
 
+    settings->setValue( "AttachmentsCacheSize", m_ui.cacheSpinBox->value() );
+
     settings->setValue( "FolderUpdateInterval", m_ui.foldersSpinBox->value() );
     settings->setValue( "UpdateInterval", m_ui.fullSpinBox->value() );
 
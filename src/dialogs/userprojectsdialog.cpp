@@ -171,7 +171,7 @@ void UserProjectsDialog::customEvent( QEvent* e )
 {
     if ( e->type() == UpdateEvent::Type ) {
         UpdateEvent* updateEvent = (UpdateEvent*)e;
-        if ( updateEvent->unit() == UpdateEvent::Users )
+        if ( updateEvent->contains( UpdateEvent::Users ) )
             updateGlobalAccess();
     }
 }
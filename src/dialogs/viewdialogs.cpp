@@ -234,7 +234,7 @@ void ViewDialog::initialize( bool withName, bool withFilters, int typeId, const
 
         for ( int i = 0; i < filters.count(); i++ ) {
             DefinitionInfo filter = filters.at( i );
-            appendCondition( filter.metadata( "column" ).toInt(), filter.type(), filter.metadata( "value" ).toString() );
+            appendCondition( filter.column(), filter.type(), filter.value() );
         }
 
         QSignalMapper* filterToggledMapper = new QSignalMapper( this );
@@ -313,7 +313,7 @@ void ViewSettingsDialog::customEvent( QEvent* e )
 {
     if ( e->type() == UpdateEvent::Type ) {
         UpdateEvent* updateEvent = (UpdateEvent*)e;
-        if ( updateEvent->unit() == UpdateEvent::Types )
+        if ( updateEvent->contains( UpdateEvent::Types ) )
             updateViewSettings();
     }
 }
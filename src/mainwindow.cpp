@@ -31,6 +31,7 @@
 #include "dialogs/preferencesdialog.h"
 #include "dialogs/settingsdialog.h"
 #include "dialogs/connectioninfodialog.h"
+#include "dialogs/profilerdialog.h"
 #include "utils/iconloader.h"
 #include "views/projectsview.h"
 #include "views/summaryview.h"
@@ -140,6 +141,13 @@ MainWindow::MainWindow() :
     connect( action, SIGNAL( triggered() ), qApp, SLOT( about() ), Qt::QueuedConnection );
     setAction( "about", action );
 
+    // the profiler is a diagnostic tool available only using the keyboard shortcut
+    action = new QAction( IconLoader::icon( "status-info" ), tr( "Performance Profiler" ), this );
+    action->setShortcut( tr( "Ctrl+Alt+Shift+P" ) );
+    connect( action, SIGNAL( triggered() ), this, SLOT( showProfiler() ), Qt::QueuedConnection );
+    setAction( "showProfiler", action );
+    addAction( action );
+
     setTitle( "sectionTools", tr( "Tools" ) );
     setTitle( "sectionManage", tr( "Manage" ) );
     setTitle( "sectionConnection", tr( "Connection" ) );
@@ -512,7 +520,7 @@ void MainWindow::customEvent( QEvent* e )
 {
     if ( e->type() == UpdateEvent::Type ) {
         UpdateEvent* ue = (UpdateEvent*)e;
-        if ( ue->unit() == UpdateEvent::GlobalAccess ) {
+        if ( ue->contains( UpdateEvent::GlobalAccess ) ) {
             QPixmap userPixmap = ( dataManager->currentUserAccess() == AdminAccess ) ? IconLoader::overlayedPixmap( "user", "overlay-admin" ) : IconLoader::pixmap( "user" );
             m_userLabel->setPixmap( userPixmap );
             m_userLabel->setText( dataManager->currentUserName() );
@@ -802,6 +810,12 @@ void MainWindow::connectionInfo()
     dialog.exec();
 }
 
+void MainWindow::showProfiler()
+{
+    ProfilerDialog dialog( this );
+    dialog.exec();
+}
+
 void MainWindow::showUsers()
 {
     if ( dataManager->currentUserAccess() == AdminAccess )
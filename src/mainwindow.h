@@ -82,6 +82,7 @@ private slots:
     void quit();
     void closeConnection();
     void connectionInfo();
+    void showProfiler();
 
     void showUsers();
     void showTypes();
@@ -50,6 +50,11 @@ AlertsModel::AlertsModel( QObject* parent ) : BaseModel( parent ),
         setHeaderData( 4, Qt::Horizontal, tr( "Email Type" ) );
     setHeaderData( 5, Qt::Horizontal, tr( "Is Public" ) );
 
+    dataManager->subscribe( this, UpdateEvent::Projects );
+    dataManager->subscribe( this, UpdateEvent::Types );
+    dataManager->subscribe( this, UpdateEvent::AlertStates );
+    dataManager->subscribe( this, UpdateEvent::States );
+
     refresh();
 }
 
@@ -157,6 +162,6 @@ void AlertsModel::refresh()
 
 void AlertsModel::updateEvent( UpdateEvent* e )
 {
-    if ( e->unit() == UpdateEvent::Projects || e->unit() == UpdateEvent::Types || e->unit() == UpdateEvent::AlertStates || e->unit() == UpdateEvent::States )
+    if ( e->contains( UpdateEvent::Projects ) || e->contains( UpdateEvent::Types ) || e->contains( UpdateEvent::AlertStates ) || e->contains( UpdateEvent::States ) )
         refresh();
 }
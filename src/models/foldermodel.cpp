@@ -22,14 +22,15 @@
 #include "data/datamanager.h"
 #include "data/entities.h"
 #include "data/issuetypecache.h"
+#include "data/querythread.h"
 #include "models/querygenerator.h"
+#include "models/queryresultmodel.h"
 #include "models/issuedetailsgenerator.h"
 #include "utils/formatter.h"
 #include "utils/viewsettingshelper.h"
 #include "utils/iconloader.h"
 
-#include <QSqlQueryModel>
-#include <QSqlQuery>
+#include <QSqlDatabase>
 #include <QDateTime>
 #include <QTextDocument>
 #include <QPixmap>
@@ -40,9 +41,13 @@ FolderModel::FolderModel( QObject* parent ) : BaseModel( parent ),
     m_typeId( 0 ),
     m_projectId( 0 ),
     m_forceColumns( false ),
-    m_searchColumn( -1 )
+    m_searchColumn( -1 ),
+    m_querySearchColumn( -1 ),
+    m_indexColumn( -1 ),
+    m_thread( NULL ),
+    m_serial( 0 )
 {
-    appendModel( new QSqlQueryModel( this ) );
+    appendModel( new QueryResultModel( this ) );
 }
 
 FolderModel::~FolderModel()
@@ -54,6 +59,8 @@ void FolderModel::initializeFolder( int folderId )
     m_folderId = folderId;
     m_viewId = 0;
     m_typeId = 0;
+
+    updateSubscriptions();
 }
 
 void FolderModel::initializeGlobalList( int typeId )
@@ -61,6 +68,19 @@ void FolderModel::initializeGlobalList( int typeId )
     m_typeId = typeId;
     m_folderId = 0;
     m_viewId = 0;
+
+    updateSubscriptions();
+}
+
+void FolderModel::updateSubscriptions()
+{
+    dataManager->clearSubscriptions( this );
+
+    // a global list receives updates of all folders and filters them by type
+    dataManager->subscribe( this, UpdateEvent::Folder, m_folderId );
+    dataManager->subscribe( this, UpdateEvent::IssueList, m_folderId );
+    dataManager->subscribe( this, UpdateEvent::Users );
+    dataManager->subscribe( this, UpdateEvent::States );
 }
 
 void FolderModel::setView( int viewId, bool resort )
@@ -92,9 +112,28 @@ void FolderModel::setSearchText( int column, const QString& text )
     m_searchColumn = column;
     m_searchText = text;
 
+    if ( canFilterRows() ) {
+        // rows are filtered when the query which is being executed is finished
+        if ( !isUpdating() )
+            filterRows();
+        return;
+    }
+
     generateQueries( false );
 }
 
+void FolderModel::setBackgroundMode( bool background )
+{
+    if ( background && !m_thread ) {
+        m_thread = new QueryThread( this );
+        connect( m_thread, SIGNAL( queryFinished( int, const QueryResult& ) ), this, SLOT( queryFinished( int, const QueryResult& ) ) );
+    } else if ( !background && m_thread ) {
+        delete m_thread;
+        m_thread = NULL;
+        m_serial = 0;
+    }
+}
+
 QVariant FolderModel::data( const QModelIndex& index, int role ) const
 {
     int level = levelOf( index );
@@ -197,9 +236,14 @@ void FolderModel::generateQueries( bool resort )
 
     m_typeId = generator.typeId();
 
+    m_querySearchColumn = m_searchColumn;
+    m_querySearchText = m_searchText;
+
     m_query = generator.query( true );
     m_arguments = generator.arguments();
 
+    bool columnsChanged = ( generator.columns() != m_columns );
+
     m_columns = generator.columns();
     m_sortColumns = generator.sortColumns();
 
@@ -207,7 +251,12 @@ void FolderModel::generateQueries( bool resort )
     for ( int i = 0; i < m_columns.count(); i++ )
         setHeaderData( i, Qt::Horizontal, helper.columnName( m_columns.at( i ) ) );
 
-    setColumnMapping( 0, generator.columnMapping() );
+    m_columnMapping = generator.columnMapping();
+    setColumnMapping( 0, m_columnMapping );
+
+    // rows retrieved for the previous columns cannot be displayed while the new query is executed
+    if ( m_thread && columnsChanged )
+        setResult( QueryResult() );
 
     if ( resort )
         setSort( generator.sortColumn(), generator.sortOrder() );
@@ -238,40 +287,130 @@ void FolderModel::updateQueries()
 void FolderModel::refresh()
 {
     if ( !m_query.isEmpty() ) {
-        QSqlQuery sqlQuery;
-        sqlQuery.prepare( QString( "%1 ORDER BY %2" ).arg( m_query, m_order ) );
+        QString sql = QString( "%1 ORDER BY %2" ).arg( m_query, m_order );
 
-        foreach ( const QVariant& arg, m_arguments )
-            sqlQuery.addBindValue( arg );
+        if ( m_thread )
+            m_serial = m_thread->execute( sql, m_arguments );
+        else
+            setSourceResult( QueryResult::execute( QSqlDatabase::database(), sql, m_arguments ) );
+    }
+}
+
+void FolderModel::queryFinished( int serial, const QueryResult& result )
+{
+    if ( serial == m_serial ) {
+        m_serial = 0;
+        setSourceResult( result );
+    }
+}
 
-        sqlQuery.exec();
-            
-        modelAt( 0 )->setQuery( sqlQuery );
+void FolderModel::setSourceResult( const QueryResult& result )
+{
+    m_sourceResult = result;
 
-        updateData();
+    m_indexColumn = -1;
+    m_searchIndex.clear();
+
+    m_filterText.clear();
+    m_filteredRows.clear();
+
+    filterRows();
+}
+
+void FolderModel::setResult( const QueryResult& result )
+{
+    QueryResultModel* model = static_cast<QueryResultModel*>( modelAt( 0 ) );
+    model->setResult( result );
+
+    updateData();
+}
+
+bool FolderModel::canFilterRows() const
+{
+    if ( m_query.isEmpty() || ( !m_sourceResult.isValid() && !isUpdating() ) )
+        return false;
+
+    if ( m_searchText.isEmpty() )
+        return m_querySearchText.isEmpty();
+
+    // the value of the column must be available and matched using the CON operator
+    if ( m_searchColumn == Column_ID || m_searchColumn == Column_Location || !m_columns.contains( m_searchColumn ) || m_columnMapping.isEmpty() )
+        return false;
+
+    // the [Me] value is converted by the query generator
+    if ( m_searchText.startsWith( QLatin1String( "[Me]" ) ) || m_querySearchText.startsWith( QLatin1String( "[Me]" ) ) )
+        return false;
+
+    if ( m_querySearchText.isEmpty() )
+        return true;
+
+    return m_searchColumn == m_querySearchColumn && m_searchText.toCaseFolded().contains( m_querySearchText.toCaseFolded() );
+}
+
+void FolderModel::filterRows()
+{
+    if ( !m_sourceResult.isValid() || m_searchText.isEmpty() || ( m_searchColumn == m_querySearchColumn && m_searchText == m_querySearchText ) ) {
+        m_filterText.clear();
+        m_filteredRows.clear();
+        setResult( m_sourceResult );
+        return;
     }
+
+    int column = m_columnMapping.value( m_columns.indexOf( m_searchColumn ) );
+    int rows = m_sourceResult.rowCount();
+
+    if ( column != m_indexColumn ) {
+        m_searchIndex.resize( rows );
+        for ( int i = 0; i < rows; i++ )
+            m_searchIndex[ i ] = m_sourceResult.value( i, column ).toString().toCaseFolded();
+        m_indexColumn = column;
+
+        m_filterText.clear();
+        m_filteredRows.clear();
+    }
+
+    QString text = m_searchText.toCaseFolded();
+
+    QVector<int> filteredRows;
+
+    if ( !m_filterText.isEmpty() && text.contains( m_filterText ) ) {
+        // the text narrows the previous filter so only the matching rows need to be checked
+        foreach ( int row, m_filteredRows ) {
+            if ( m_searchIndex.at( row ).contains( text ) )
+                filteredRows.append( row );
+        }
+    } else {
+        for ( int i = 0; i < rows; i++ ) {
+            if ( m_searchIndex.at( i ).contains( text ) )
+                filteredRows.append( i );
+        }
+    }
+
+    m_filterText = text;
+    m_filteredRows = filteredRows;
+
+    setResult( m_sourceResult.filtered( filteredRows ) );
 }
 
 void FolderModel::updateEvent( UpdateEvent* e )
 {
-    switch ( e->unit() ) {
-        case UpdateEvent::Folder:
-        case UpdateEvent::IssueList:
-            if ( m_folderId == 0 ) {
-                FolderEntity folder = FolderEntity::find( e->id() );
-                if ( folder.typeId() == m_typeId )
-                    refresh();
-            } else if ( e->id() == m_folderId ) {
-                refresh();
-            }
-            break;
+    // the queries are executed only once even if multiple units were updated
+    if ( e->contains( UpdateEvent::Users ) || e->contains( UpdateEvent::States ) || isFolderUpdated( e ) )
+        refresh();
+}
 
-        case UpdateEvent::Users:
-        case UpdateEvent::States:
-            refresh();
-            break;
+bool FolderModel::isFolderUpdated( UpdateEvent* e ) const
+{
+    if ( m_folderId != 0 )
+        return e->contains( UpdateEvent::Folder, m_folderId ) || e->contains( UpdateEvent::IssueList, m_folderId );
+
+    QList<int> folders = e->ids( UpdateEvent::Folder ) + e->ids( UpdateEvent::IssueList );
 
-        default:
-            break;
+    foreach ( int folderId, folders ) {
+        FolderEntity folder = FolderEntity::find( folderId );
+        if ( folder.typeId() == m_typeId )
+            return true;
     }
+
+    return false;
 }
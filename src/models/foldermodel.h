@@ -21,8 +21,10 @@
 #define FOLDERMODEL_H
 
 #include "basemodel.h"
+#include "data/querythread.h"
 
 #include <QStringList>
+#include <QVector>
 
 /**
 * Column type.
@@ -95,9 +97,23 @@ public:
 
     /**
     * Set the quick search text for the list.
+    * When the text narrows the previous search, the rows which were already
+    * retrieved are filtered without executing the query again.
     */
     void setSearchText( int column, const QString& text );
 
+    /**
+    * Enable executing queries in a background thread.
+    * When enabled, the contents of the model are replaced after the query
+    * is finished and a new query cancels the previous one.
+    */
+    void setBackgroundMode( bool background );
+
+    /**
+    * Return @c true if a query is being executed in the background.
+    */
+    bool isUpdating() const { return m_serial != 0; }
+
 public: // overrides
     QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
 
@@ -106,10 +122,22 @@ protected: // overrides
 
     void updateEvent( UpdateEvent* e );
 
+private slots:
+    void queryFinished( int serial, const QueryResult& result );
+
 private:
     void generateQueries( bool resort );
     void refresh();
 
+    void updateSubscriptions();
+    bool isFolderUpdated( UpdateEvent* e ) const;
+
+    void setSourceResult( const QueryResult& result );
+    void setResult( const QueryResult& result );
+
+    bool canFilterRows() const;
+    void filterRows();
+
 private:
     int m_folderId;
     int m_viewId;
@@ -121,6 +149,9 @@ private:
     int m_searchColumn;
     QString m_searchText;
 
+    int m_querySearchColumn;
+    QString m_querySearchText;
+
     QString m_query;
     QString m_order;
 
@@ -128,6 +159,18 @@ private:
 
     QList<int> m_columns;
     QList<QStringList> m_sortColumns;
+    QList<int> m_columnMapping;
+
+    QueryResult m_sourceResult;
+
+    int m_indexColumn;
+    QVector<QString> m_searchIndex;
+
+    QString m_filterText;
+    QVector<int> m_filteredRows;
+
+    QueryThread* m_thread;
+    int m_serial;
 };
 
 #endif
@@ -21,11 +21,13 @@
 
 #include "data/datamanager.h"
 #include "data/entities.h"
+#include "data/issuebatch.h"
 #include "utils/datetimehelper.h"
 #include "utils/viewsettingshelper.h"
 #include "utils/markupprocessor.h"
 #include "utils/htmlwriter.h"
 #include "utils/formatter.h"
+#include "utils/profiler.h"
 
 #include <QtAlgorithms>
 #include <QStringList>
@@ -37,7 +39,13 @@ IssueDetailsGenerator::IssueDetailsGenerator() :
     m_isOwner( false ),
     m_isAdmin( false ),
     m_commentsCount( 0 ),
-    m_filesCount( 0 )
+    m_filesCount( 0 ),
+    m_valid( false ),
+    m_historyLimit( 0 ),
+    m_historyOrder( Qt::AscendingOrder ),
+    m_batch( NULL ),
+    m_historyCache( NULL ),
+    m_sectionIds( false )
 {
 }
 
@@ -51,21 +59,86 @@ void IssueDetailsGenerator::setIssue( int issueId, bool description, History his
     m_description = description;
     m_history = history;
 
-    m_isOwner = IssueEntity::isOwner( issueId );
-    m_isAdmin = IssueEntity::isAdmin( issueId );
+    if ( m_batch != NULL && m_batch->contains( issueId ) ) {
+        m_isOwner = m_batch->isOwner( issueId );
+        m_isAdmin = m_batch->isAdmin( issueId );
+    } else {
+        m_isOwner = IssueEntity::isOwner( issueId );
+        m_isAdmin = IssueEntity::isAdmin( issueId );
+    }
+}
+
+void IssueDetailsGenerator::setIssueBatch( const IssueBatch* batch )
+{
+    m_batch = batch;
+}
+
+void IssueDetailsGenerator::setHistoryCache( QHash<int, HistoryItem>* cache )
+{
+    m_historyCache = cache;
+}
+
+void IssueDetailsGenerator::setSectionIds( bool enabled )
+{
+    m_sectionIds = enabled;
+}
+
+void IssueDetailsGenerator::setHistoryLimit( int limit )
+{
+    m_historyLimit = limit;
 }
 
 void IssueDetailsGenerator::write( HtmlWriter* writer, HtmlText::Flags flags )
 {
-    IssueEntity issue = IssueEntity::find( m_issueId );
+    ProfilerScope scope( "IssueDetailsGenerator::write" );
+
+    writeHeader( writer, flags );
+
+    int count = historyItemsCount();
+
+    if ( m_historyLimit > 0 && count > m_historyLimit ) {
+        // older items are written in place of the placeholder later
+        if ( m_historyOrder == Qt::AscendingOrder ) {
+            writeHistoryPlaceholder( writer );
+            writeHistoryItems( writer, count - m_historyLimit, m_historyLimit, flags );
+        } else {
+            writeHistoryItems( writer, 0, m_historyLimit, flags );
+            writeHistoryPlaceholder( writer );
+        }
+    } else {
+        writeHistoryItems( writer, 0, count, flags );
+    }
+
+    writeFooter( writer );
+}
+
+void IssueDetailsGenerator::writeHeader( HtmlWriter* writer, HtmlText::Flags flags )
+{
+    m_historyGroups.clear();
+    m_historyItems.clear();
+
+    m_commentsCount = 0;
+    m_filesCount = 0;
+
+    bool batched = m_batch != NULL && m_batch->contains( m_issueId );
+
+    IssueEntity issue = batched ? m_batch->issue( m_issueId ) : IssueEntity::find( m_issueId );
+
+    m_valid = issue.isValid();
 
     if ( issue.isValid() ) {
+        writer->beginSection( sectionId( "issue-title" ) );
         writer->writeBlock( issue.name(), HtmlWriter::Header2Block );
+        writer->endSection();
+
+        writer->createLayout( sectionId( "issue-details" ) );
 
-        writer->createLayout();
+        bool nonEmpty = dataManager->setting( "hide_empty_values" ) == "1";
 
         QList<ValueEntity> values;
-        if ( dataManager->setting( "hide_empty_values" ) == "1" )
+        if ( batched )
+            values = m_batch->values( m_issueId, nonEmpty );
+        else if ( nonEmpty )
             values = issue.nonEmptyValues();
         else
             values = issue.values();
@@ -79,7 +152,7 @@ void IssueDetailsGenerator::write( HtmlWriter* writer, HtmlText::Flags flags )
         }
 
         if ( m_description ) {
-            DescriptionEntity description = issue.description();
+            DescriptionEntity description = batched ? m_batch->description( m_issueId ) : issue.description();
 
             if ( description.isValid() ) {
                 writer->appendLayoutRow();
@@ -99,7 +172,7 @@ void IssueDetailsGenerator::write( HtmlWriter* writer, HtmlText::Flags flags )
         }
 
         if ( m_history != NoHistory ) {
-            writer->appendLayoutRow();
+            writer->appendLayoutSection();
             writer->beginCell( HtmlWriter::BottomPane, 2 );
 
             if ( !flags.testFlag( HtmlText::NoInternalLinks ) )
@@ -107,11 +180,46 @@ void IssueDetailsGenerator::write( HtmlWriter* writer, HtmlText::Flags flags )
 
             writer->writeBlock( tr( "Issue History" ), HtmlWriter::Header3Block );
 
-            writeHistory( writer, issue, flags );
+            prepareHistory( issue );
         }
+    }
+}
+
+void IssueDetailsGenerator::writeFooter( HtmlWriter* writer )
+{
+    if ( !m_valid )
+        return;
 
-        writer->endLayout();
+    if ( m_historyGroups.isEmpty() ) {
+        if ( m_history == OnlyComments )
+            writer->writeBlock( tr( "There are no comments." ), HtmlWriter::NoItemsBlock );
+        else if ( m_history == OnlyFiles )
+            writer->writeBlock( tr( "There are no attachments." ), HtmlWriter::NoItemsBlock );
+        else if ( m_history == CommentsAndFiles )
+            writer->writeBlock( tr( "There are no comments or attachments." ), HtmlWriter::NoItemsBlock );
     }
+
+    writer->endLayout();
+}
+
+void IssueDetailsGenerator::writeHistoryItems( HtmlWriter* writer, int first, int count, HtmlText::Flags flags )
+{
+    m_historyItems.clear();
+
+    int last = qMin( first + count, m_historyGroups.count() );
+
+    for ( int i = first; i < last; i++ ) {
+        HistoryItem item = historyItem( m_historyGroups.at( i ), flags );
+        writer->appendHtml( item.m_html );
+        m_historyItems.append( item );
+    }
+}
+
+void IssueDetailsGenerator::writeHistoryPlaceholder( HtmlWriter* writer )
+{
+    writer->beginSection( sectionId( "history-more" ) );
+    writer->writeBlock( tr( "Loading older items..." ), HtmlWriter::NoItemsBlock );
+    writer->endSection();
 }
 
 void IssueDetailsGenerator::writeProperties( HtmlWriter* writer, const IssueEntity& issue )
@@ -156,108 +264,148 @@ void IssueDetailsGenerator::writeAttributes( HtmlWriter* writer, const QList<Val
     writer->writeInfoList( headers, items, true );
 }
 
-void IssueDetailsGenerator::writeHistory( HtmlWriter* writer, const IssueEntity& issue, HtmlText::Flags flags )
+void IssueDetailsGenerator::prepareHistory( const IssueEntity& issue )
 {
-    Qt::SortOrder order = Qt::AscendingOrder;
+    m_historyOrder = Qt::AscendingOrder;
 
     if ( dataManager->preferenceOrSetting( "history_order" ) == "desc" )
-        order = Qt::DescendingOrder;
+        m_historyOrder = Qt::DescendingOrder;
 
     QList<ChangeEntity> changes;
-    if ( m_history == AllHistory )
-        changes = issue.changes( order );
+    if ( m_batch != NULL && m_batch->contains( m_issueId ) ) {
+        foreach ( const ChangeEntity& change, m_batch->changes( m_issueId, m_historyOrder ) ) {
+            if ( m_history == AllHistory || ( change.type() == CommentAdded && m_history != OnlyFiles )
+                || ( change.type() == FileAdded && m_history != OnlyComments ) )
+                changes.append( change );
+        }
+    } else if ( m_history == AllHistory )
+        changes = issue.changes( m_historyOrder );
     else if ( m_history == OnlyComments )
-        changes = issue.comments( order );
+        changes = issue.comments( m_historyOrder );
     else if ( m_history == OnlyFiles )
-        changes = issue.files( order );
+        changes = issue.files( m_historyOrder );
     else if ( m_history == CommentsAndFiles )
-        changes = issue.commentsAndFiles( order );
-
-    QList<HtmlText> list;
+        changes = issue.commentsAndFiles( m_historyOrder );
 
-    int lastUserId = 0;
-    QDateTime lastDate;
+    int i = 0;
 
-    HtmlText edited;
-
-    for ( int i = 0; i < changes.count(); i++ ) {
-        const ChangeEntity& change = changes.at( i );
+    while ( i < changes.count() ) {
+        const ChangeEntity& change = changes.at( i++ );
 
         if ( change.type() == ValueChanged && change.attributeId() == 0 )
             continue;
 
-        if ( change.type() <= ValueChanged && list.count() > 0 ) {
-            if ( change.createdUserId() == lastUserId && lastDate.secsTo( change.createdDate() ) < 180 ) {
-                list.append( formatChange( change, flags ) );
-                continue;
+        QList<ChangeEntity> group;
+        group.append( change );
+
+        // changes made by the same user within a short time are merged into a single item
+        if ( change.type() <= ValueChanged ) {
+            while ( i < changes.count() ) {
+                const ChangeEntity& next = changes.at( i );
+
+                if ( next.type() == ValueChanged && next.attributeId() == 0 ) {
+                    i++;
+                    continue;
+                }
+
+                if ( next.type() > ValueChanged || next.createdUserId() != change.createdUserId() || change.createdDate().secsTo( next.createdDate() ) >= 180 )
+                    break;
+
+                group.append( next );
+                i++;
             }
         }
 
-        if ( list.count() > 0 ) {
+        if ( change.type() == CommentAdded )
+            m_commentsCount++;
+        else if ( change.type() == FileAdded )
+            m_filesCount++;
+
+        m_historyGroups.append( group );
+    }
+}
+
+HistoryItem IssueDetailsGenerator::historyItem( const QList<ChangeEntity>& changes, HtmlText::Flags flags )
+{
+    const ChangeEntity& change = changes.first();
+
+    int stampId = 0;
+    foreach ( const ChangeEntity& entity, changes )
+        stampId = qMax( stampId, entity.stampId() );
+
+    HistoryItem item;
+
+    if ( m_historyCache != NULL )
+        item = m_historyCache->value( change.id() );
+
+    if ( item.m_id != change.id() || item.m_lastId != changes.last().id() || item.m_stampId != stampId ) {
+        HtmlWriter writer;
+        writeHistoryItem( &writer, changes, flags );
+
+        item.m_id = change.id();
+        item.m_lastId = changes.last().id();
+        item.m_stampId = stampId;
+        item.m_html = writer.bodyHtml();
+
+        if ( m_historyCache != NULL )
+            m_historyCache->insert( item.m_id, item );
+    }
+
+    return item;
+}
+
+void IssueDetailsGenerator::writeHistoryItem( HtmlWriter* writer, const QList<ChangeEntity>& changes, HtmlText::Flags flags )
+{
+    const ChangeEntity& change = changes.first();
+
+    writer->beginHistoryItem( sectionId( QString( "history%1" ).arg( change.id() ) ) );
+
+    HtmlText edited;
+
+    switch ( change.type() ) {
+        case IssueCreated:
+        case IssueRenamed:
+        case ValueChanged: {
+            writer->writeBlock( formatStamp( change ), HtmlWriter::Header4Block );
+            QList<HtmlText> list;
+            foreach ( const ChangeEntity& item, changes )
+                list.append( formatChange( item, flags ) );
             writer->writeBulletList( list );
-            writer->endHistoryItem();
-            list.clear();
+            break;
         }
 
-        switch ( change.type() ) {
-            case IssueCreated:
-            case IssueRenamed:
-            case ValueChanged:
-                lastUserId = change.createdUserId();
-                lastDate = change.createdDate();
-                writer->beginHistoryItem();
+        case CommentAdded:
+            writer->writeBlock( changeLinks( change, flags ), flags.testFlag( HtmlText::NoInternalLinks ) ? HtmlWriter::HistoryInfoBlock : HtmlWriter::HistoryLinksBlock );
+            edited = changeEdited( change, flags );
+            if ( !edited.isEmpty() )
+                writer->writeNestedBlock( formatStamp( change ), HtmlWriter::Header4Block, edited, HtmlWriter::EditedBlock );
+            else
                 writer->writeBlock( formatStamp( change ), HtmlWriter::Header4Block );
-                list.append( formatChange( change, flags ) );
-                break;
-
-            case CommentAdded:
-                writer->beginHistoryItem();
-                writer->writeBlock( changeLinks( change, flags ), flags.testFlag( HtmlText::NoInternalLinks ) ? HtmlWriter::HistoryInfoBlock : HtmlWriter::HistoryLinksBlock );
-                edited = changeEdited( change, flags );
-                if ( !edited.isEmpty() )
-                    writer->writeNestedBlock( formatStamp( change ), HtmlWriter::Header4Block, edited, HtmlWriter::EditedBlock );
-                else
-                    writer->writeBlock( formatStamp( change ), HtmlWriter::Header4Block );
-                writer->writeBlock( commentText( change.comment(), flags ), HtmlWriter::CommentBlock );
-                writer->endHistoryItem();
-                m_commentsCount++;
-                break;
-
-            case FileAdded:
-                writer->beginHistoryItem();
-                writer->writeBlock( changeLinks( change, flags ), flags.testFlag( HtmlText::NoInternalLinks ) ? HtmlWriter::HistoryInfoBlock : HtmlWriter::HistoryLinksBlock );
-                edited = changeEdited( change, flags );
-                if ( !edited.isEmpty() )
-                    writer->writeNestedBlock( formatStamp( change ), HtmlWriter::Header4Block, edited, HtmlWriter::EditedBlock );
-                else
-                    writer->writeBlock( formatStamp( change ), HtmlWriter::Header4Block );
-                writer->writeBlock( formatFile( change.file(), flags ), HtmlWriter::AttachmentBlock );
-                writer->endHistoryItem();
-                m_filesCount++;
-                break;
+            writer->writeBlock( commentText( change, flags ), HtmlWriter::CommentBlock );
+            break;
 
-            case IssueMoved:
-                writer->beginHistoryItem();
+        case FileAdded:
+            writer->writeBlock( changeLinks( change, flags ), flags.testFlag( HtmlText::NoInternalLinks ) ? HtmlWriter::HistoryInfoBlock : HtmlWriter::HistoryLinksBlock );
+            edited = changeEdited( change, flags );
+            if ( !edited.isEmpty() )
+                writer->writeNestedBlock( formatStamp( change ), HtmlWriter::Header4Block, edited, HtmlWriter::EditedBlock );
+            else
                 writer->writeBlock( formatStamp( change ), HtmlWriter::Header4Block );
-                writer->writeBulletList( QList<HtmlText>() << formatChange( change, flags ) );
-                writer->endHistoryItem();
-                break;
-        }
-    }
+            writer->writeBlock( formatFile( change.file(), flags ), HtmlWriter::AttachmentBlock );
+            break;
 
-    if ( list.count() > 0 ) {
-        writer->writeBulletList( list );
-        writer->endHistoryItem();
+        case IssueMoved:
+            writer->writeBlock( formatStamp( change ), HtmlWriter::Header4Block );
+            writer->writeBulletList( QList<HtmlText>() << formatChange( change, flags ) );
+            break;
     }
 
-    if ( changes.count() == 0 ) {
-        if ( m_history == OnlyComments )
-            writer->writeBlock( tr( "There are no comments." ), HtmlWriter::NoItemsBlock );
-        else if ( m_history == OnlyFiles )
-            writer->writeBlock( tr( "There are no attachments." ), HtmlWriter::NoItemsBlock );
-        else if ( m_history == CommentsAndFiles )
-            writer->writeBlock( tr( "There are no comments or attachments." ), HtmlWriter::NoItemsBlock );
-    }
+    writer->endHistoryItem();
+}
+
+QString IssueDetailsGenerator::sectionId( const QString& id ) const
+{
+    return m_sectionIds ? id : QString();
 }
 
 QString IssueDetailsGenerator::formatStamp( const ChangeEntity& change )
@@ -504,10 +652,21 @@ HtmlText IssueDetailsGenerator::descriptionText( const DescriptionEntity& descri
         return HtmlText::parse( HtmlText::convertTabsToSpaces( description.text() ), flags );
 }
 
-HtmlText IssueDetailsGenerator::commentText( const CommentEntity& comment, HtmlText::Flags flags )
+HtmlText IssueDetailsGenerator::commentText( const ChangeEntity& change, HtmlText::Flags flags )
 {
-    if ( comment.format() == TextWithMarkup )
-        return MarkupProcessor::parse( comment.text(), flags );
-    else
+    CommentEntity comment = change.comment();
+
+    if ( comment.format() == TextWithMarkup ) {
+        // only the interactive variant is cached, reports use different flags
+        if ( flags != 0 )
+            return MarkupProcessor::parse( comment.text(), flags );
+
+        if ( !comment.html().isEmpty() )
+            return HtmlText::fromHtml( comment.html(), flags );
+
+        HtmlText result = MarkupProcessor::parse( comment.text(), flags );
+        dataManager->cacheCommentHtml( change.id(), change.stampId(), result.toString() );
+        return result;
+    } else
         return HtmlText::parse( HtmlText::convertTabsToSpaces( comment.text() ), flags );
 }
@@ -20,18 +20,45 @@
 #ifndef ISSUEDETAILSGENERATOR_H
 #define ISSUEDETAILSGENERATOR_H
 
+#include "data/entities.h"
 #include "utils/htmltext.h"
 
 #include <QObject>
 #include <QList>
+#include <QHash>
 
 class HtmlWriter;
-class IssueEntity;
-class ChangeEntity;
-class FileEntity;
-class ValueEntity;
-class DescriptionEntity;
-class CommentEntity;
+class IssueBatch;
+
+/**
+* Rendered item of the issue history.
+*/
+class HistoryItem
+{
+public:
+    HistoryItem() : m_id( 0 ), m_lastId( 0 ), m_stampId( 0 ) { }
+
+public:
+    /**
+    * Identifier of the first change in the item.
+    */
+    int m_id;
+
+    /**
+    * Identifier of the last change in the item.
+    */
+    int m_lastId;
+
+    /**
+    * The highest stamp of the changes in the item.
+    */
+    int m_stampId;
+
+    /**
+    * HTML fragment containing the item.
+    */
+    QString m_html;
+};
 
 /**
 * Class providing issue details to the TextWriter.
@@ -72,6 +99,14 @@ public:
     */
     void setIssue( int issueId, bool description, History history );
 
+    /**
+    * Set the details of issues loaded in bulk.
+    * Details of issues contained in the batch are not queried from the
+    * database. The batch must be set before calling setIssue().
+    * @param batch The loaded details or @c NULL to query the database.
+    */
+    void setIssueBatch( const IssueBatch* batch );
+
     /**
     * Output the issue details to the writer.
     * @param writer The text document writer to output the details to.
@@ -79,6 +114,70 @@ public:
     */
     void write( HtmlWriter* writer, HtmlText::Flags flags = 0 );
 
+    /**
+    * Limit the number of history items written by write().
+    * Only the most recent items are written and a placeholder is written
+    * in place of older items, which can be written using writeHistoryItems().
+    * @param limit The maximum number of items or 0 to write all items.
+    */
+    void setHistoryLimit( int limit );
+
+    /**
+    * Output the issue details without history items to the writer.
+    * It must be followed by writeFooter(), optionally preceded by calls
+    * to writeHistoryItems() to output the history in pages.
+    * @param writer The text document writer to output the details to.
+    * @param flags Optional flags affecting extracting of links.
+    */
+    void writeHeader( HtmlWriter* writer, HtmlText::Flags flags = 0 );
+
+    /**
+    * Output a range of history items to the writer.
+    * @param writer The text document writer to output the items to.
+    * @param first Index of the first item to write.
+    * @param count The number of items to write.
+    * @param flags Optional flags affecting extracting of links.
+    */
+    void writeHistoryItems( HtmlWriter* writer, int first, int count, HtmlText::Flags flags = 0 );
+
+    /**
+    * Complete the issue details written by writeHeader().
+    * @param writer The text document writer to output the details to.
+    */
+    void writeFooter( HtmlWriter* writer );
+
+    /**
+    * Return the number of items in the history of the issue.
+    * This information is available after calling writeHeader() or write().
+    */
+    int historyItemsCount() const { return m_historyGroups.count(); }
+
+    /**
+    * Return the order of history items.
+    */
+    Qt::SortOrder historyOrder() const { return m_historyOrder; }
+
+    /**
+    * Set the cache of rendered history items.
+    * Items whose changes were not modified are not rendered again. The cache
+    * must be cleared when the settings or users affecting the details change.
+    * @param cache Rendered items indexed by the identifier of the first change.
+    */
+    void setHistoryCache( QHash<int, HistoryItem>* cache );
+
+    /**
+    * Write identifiers of sections which can be updated separately.
+    * By default no identifiers are written, so that a document containing
+    * details of multiple issues does not contain duplicate identifiers.
+    */
+    void setSectionIds( bool enabled );
+
+    /**
+    * Return the history items written by the last call to write()
+    * or writeHistoryItems().
+    */
+    const QList<HistoryItem>& historyItems() const { return m_historyItems; }
+
     int commentsCount() const { return m_commentsCount; }
 
     int filesCount() const { return m_filesCount; }
@@ -86,7 +185,14 @@ public:
 private:
     void writeProperties( HtmlWriter* writer, const IssueEntity& issue );
     void writeAttributes( HtmlWriter* writer, const QList<ValueEntity>& values, HtmlText::Flags flags );
-    void writeHistory( HtmlWriter* writer, const IssueEntity& issue, HtmlText::Flags flags );
+    void writeHistoryPlaceholder( HtmlWriter* writer );
+    void writeHistoryItem( HtmlWriter* writer, const QList<ChangeEntity>& changes, HtmlText::Flags flags );
+
+    QString sectionId( const QString& id ) const;
+
+    void prepareHistory( const IssueEntity& issue );
+
+    HistoryItem historyItem( const QList<ChangeEntity>& changes, HtmlText::Flags flags );
 
     QString formatStamp( const ChangeEntity& change );
 
@@ -102,18 +208,31 @@ private:
     HtmlText changeEdited( const ChangeEntity& change, HtmlText::Flags flags );
 
     HtmlText descriptionText( const DescriptionEntity& description, HtmlText::Flags flags );
-    HtmlText commentText( const CommentEntity& comment, HtmlText::Flags flags );
+    HtmlText commentText( const ChangeEntity& change, HtmlText::Flags flags );
 
 private:
     int m_issueId;
     bool m_description;
     History m_history;
 
+    const IssueBatch* m_batch;
+
     bool m_isOwner;
     bool m_isAdmin;
 
     int m_commentsCount;
     int m_filesCount;
+
+    bool m_valid;
+
+    int m_historyLimit;
+    Qt::SortOrder m_historyOrder;
+    QList< QList<ChangeEntity> > m_historyGroups;
+
+    QHash<int, HistoryItem>* m_historyCache;
+    QList<HistoryItem> m_historyItems;
+
+    bool m_sectionIds;
 };
 
 #endif
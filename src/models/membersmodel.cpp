@@ -36,6 +36,8 @@ MembersModel::MembersModel( int projectId, QObject* parent ) : BaseModel( parent
 
     setSort( 0, Qt::AscendingOrder );
 
+    dataManager->subscribe( this, UpdateEvent::Users );
+
     updateQueries();
 }
 
@@ -109,6 +111,6 @@ void MembersModel::refresh()
 
 void MembersModel::updateEvent( UpdateEvent* e )
 {
-    if ( e->unit() == UpdateEvent::Users )
+    if ( e->contains( UpdateEvent::Users ) )
         refresh();
 }
@@ -6,8 +6,10 @@ HEADERS += models/alertsmodel.h \
            models/projectsmodel.h \
            models/projectsummarygenerator.h \
            models/querygenerator.h \
+           models/queryresultmodel.h \
            models/reportgenerator.h \
            models/sqltreemodel.h \
+           models/summaryrenderer.h \
            models/typesmodel.h \
            models/userprojectsmodel.h \
            models/usersmodel.h \
@@ -21,8 +23,10 @@ SOURCES += models/alertsmodel.cpp \
            models/projectsmodel.cpp \
            models/projectsummarygenerator.cpp \
            models/querygenerator.cpp \
+           models/queryresultmodel.cpp \
            models/reportgenerator.cpp \
            models/sqltreemodel.cpp \
+           models/summaryrenderer.cpp \
            models/typesmodel.cpp \
            models/userprojectsmodel.cpp \
            models/usersmodel.cpp \
@@ -45,6 +45,12 @@ ProjectsModel::ProjectsModel( QObject* parent ) : BaseModel( parent )
 
     setSort( 0, Qt::AscendingOrder );
 
+    dataManager->subscribe( this, UpdateEvent::Projects );
+    dataManager->subscribe( this, UpdateEvent::Types );
+    dataManager->subscribe( this, UpdateEvent::AlertStates );
+    dataManager->subscribe( this, UpdateEvent::States );
+    dataManager->subscribe( this, UpdateEvent::Summary );
+
     updateQueries();
 }
 
@@ -198,6 +204,6 @@ void ProjectsModel::refresh()
 
 void ProjectsModel::updateEvent( UpdateEvent* e )
 {
-    if ( e->unit() == UpdateEvent::Projects || e->unit() == UpdateEvent::Types || e->unit() == UpdateEvent::AlertStates || e->unit() == UpdateEvent::States || e->unit() == UpdateEvent::Summary )
+    if ( e->contains( UpdateEvent::Projects ) || e->contains( UpdateEvent::Types ) || e->contains( UpdateEvent::AlertStates ) || e->contains( UpdateEvent::States ) || e->contains( UpdateEvent::Summary ) )
         refresh();
 }
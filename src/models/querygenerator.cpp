@@ -24,15 +24,21 @@
 #include "models/foldermodel.h"
 #include "utils/attributehelper.h"
 #include "utils/datetimehelper.h"
+#include "utils/profiler.h"
 
 #include <QSqlQuery>
 #include <QDateTime>
 
+// minimum number of attribute columns which are retrieved using a single pivoting join
+static const int PivotThreshold = 8;
+
 QueryGenerator::QueryGenerator() :
     m_folderId( 0 ),
     m_typeId( 0 ),
     m_viewId( 0 ),
     m_projectId( 0 ),
+    m_plan( NULL ),
+    m_forceColumns( false ),
     m_searchColumn( -1 ),
     m_sortColumn( -1 ),
     m_sortOrder( Qt::AscendingOrder ),
@@ -76,31 +82,17 @@ void QueryGenerator::initializeCommon( bool withLocation )
 {
     IssueTypeCache* cache = dataManager->issueTypeCache( m_typeId );
 
-    DefinitionInfo info;
-
-    if ( m_viewId != 0 ) {
-        QSqlQuery sqlQuery;
-        sqlQuery.prepare( "SELECT v.view_def"
-            " FROM views AS v"
-            " WHERE v.view_id = ? AND v.type_id = ?" );
-        sqlQuery.addBindValue( m_viewId );
-        sqlQuery.addBindValue( m_typeId );
-        sqlQuery.exec();
-
-        if ( !sqlQuery.next() )
-            return;
+    const ViewPlan* plan = cache->viewPlan( m_viewId, withLocation );
+    if ( !plan->m_valid )
+        return;
 
-        info = DefinitionInfo::fromString( sqlQuery.value( 0 ).toString() );
-    } else {
-        info = cache->defaultView();
-    }
+    m_plan = plan;
 
-    m_columns = cache->viewColumns( info, withLocation );
-    m_filters = cache->viewFilters( info );
+    m_columns = plan->m_columns;
+    m_filters = plan->m_filters;
 
-    QPair<int, Qt::SortOrder> order = cache->viewSortOrder( info );
-    m_sortColumn = m_columns.indexOf( order.first );
-    m_sortOrder = order.second;
+    m_sortColumn = m_columns.indexOf( plan->m_sortColumn );
+    m_sortOrder = plan->m_sortOrder;
 }
 
 void QueryGenerator::setProject( int projectId )
@@ -117,6 +109,7 @@ void QueryGenerator::setSearchText( int column, const QString& text )
 void QueryGenerator::setColumns( const QList<int>& columns )
 {
     m_columns = columns;
+    m_forceColumns = true;
 
     m_sortColumn = 0;
     m_sortOrder = Qt::AscendingOrder;
@@ -124,20 +117,104 @@ void QueryGenerator::setColumns( const QList<int>& columns )
 
 QString QueryGenerator::query( bool allColumns )
 {
+    ProfilerScope scope( "QueryGenerator::query" );
+
     if ( !m_typeId )
         return QString();
 
+    // the templates generated for the columns of the view are stored in its plan
+    bool cached = m_plan != NULL && !m_forceColumns;
+    int key = templateKey( allColumns );
+
+    if ( cached && m_plan->m_templates.contains( key ) ) {
+        m_template = m_plan->m_templates.value( key );
+    } else {
+        generateTemplate( allColumns );
+        if ( cached && m_template.m_cacheable )
+            m_plan->m_templates.insert( key, m_template );
+    }
+
+    if ( !m_template.m_valid )
+        return QString();
+
+    bindArguments();
+
+    return m_template.m_sql;
+}
+
+int QueryGenerator::templateKey( bool allColumns ) const
+{
+    int key = allColumns ? 1 : 0;
+
+    if ( m_folderId == 0 && m_projectId != 0 )
+        key |= 2;
+
+    if ( !m_searchText.isEmpty() )
+        key |= ( m_searchColumn + 1 ) << 2;
+
+    return key;
+}
+
+void QueryGenerator::generateTemplate( bool allColumns )
+{
     m_valid = true;
-    m_arguments.clear();
+    m_template = QueryTemplate();
+
+    planJoins( allColumns );
 
     QString select = generateSelect( allColumns );
     QString joins = generateJoins( allColumns );
     QString conditions = generateConditions();
 
     if ( !m_valid )
-        return QString();
+        return;
+
+    if ( !m_pivotColumns.isEmpty() )
+        m_template.m_sql = QString( "SELECT %1 FROM %2 WHERE %3 GROUP BY i.issue_id" ).arg( select, joins, conditions );
+    else
+        m_template.m_sql = QString( "SELECT %1 FROM %2 WHERE %3" ).arg( select, joins, conditions );
 
-    return QString( "SELECT %1 FROM %2 WHERE %3" ).arg( select, joins, conditions );
+    if ( allColumns )
+        m_template.m_sortColumns = generateSortColumns();
+
+    m_template.m_valid = true;
+}
+
+void QueryGenerator::planJoins( bool allColumns )
+{
+    m_joinColumns.clear();
+    m_pivotColumns.clear();
+
+    // columns used in conditions always need a separate join
+    foreach ( const ViewFilter& filter, m_filters ) {
+        if ( !m_joinColumns.contains( filter.m_column ) )
+            m_joinColumns.append( filter.m_column );
+    }
+
+    if ( !m_searchText.isEmpty() ) {
+        if ( !m_joinColumns.contains( m_searchColumn ) )
+            m_joinColumns.append( m_searchColumn );
+    }
+
+    if ( !allColumns )
+        return;
+
+    QList<int> attributeColumns;
+
+    foreach ( int column, m_columns ) {
+        if ( m_joinColumns.contains( column ) )
+            continue;
+        if ( column > Column_UserDefined )
+            attributeColumns.append( column );
+        else
+            m_joinColumns.append( column );
+    }
+
+    // with many attribute columns, retrieve them in one pass instead of joining the values table for each column
+    if ( attributeColumns.count() >= PivotThreshold )
+        m_pivotColumns = attributeColumns;
+    else
+        m_joinColumns += attributeColumns;
 }
 
 QString QueryGenerator::generateSelect( bool allColumns )
@@ -173,15 +250,17 @@ QString QueryGenerator::generateSelect( bool allColumns )
                     break;
                 default:
                     if ( column > Column_UserDefined )
-                        result.append( QString( "a%1.attr_value" ).arg( column - Column_UserDefined ) );
+                        result.append( attributeExpression( column ) );
                     else
                         m_valid = false;
                     break;
             }
         }
 
-        if ( m_folderId == 0 )
+        if ( m_folderId == 0 && m_columns.contains( Column_Location ) ) {
+            m_template.m_projectColumn = result.count();
             result.append( "p.project_name" );
+        }
     }
 
     return result.join( ", " );
@@ -194,30 +273,14 @@ QString QueryGenerator::generateJoins( bool allColumns )
 
     if ( m_folderId == 0 ) {
         joins.append( "INNER JOIN folders AS f ON f.folder_id = i.folder_id" );
-        if ( allColumns )
+        if ( allColumns && m_columns.contains( Column_Location ) )
             joins.append( "INNER JOIN projects AS p ON p.project_id = f.project_id" );
     }
 
     joins.append( "LEFT OUTER JOIN issue_states AS s ON s.issue_id = i.issue_id AND s.user_id = ?" );
-    m_arguments.append( dataManager->currentUserId() );
-
-    QList<int> columns;
-
-    if ( allColumns )
-        columns = m_columns;
-
-    foreach ( const DefinitionInfo& filter, m_filters ) {
-        int column = filter.metadata( "column" ).toInt();
-        if ( !columns.contains( column ) )
-            columns.append( column );
-    }
-
-    if ( !m_searchText.isEmpty() ) {
-        if ( !columns.contains( m_searchColumn ) )
-            columns.append( m_searchColumn );
-    }
+    appendArgument( QueryArgument( QueryArgument::CurrentUserId ) );
 
-    foreach ( int column, columns ) {
+    foreach ( int column, m_joinColumns ) {
         switch ( column ) {
             case Column_CreatedBy:
                 joins.append( "LEFT OUTER JOIN users AS uc ON uc.user_id = i.created_user_id" );
@@ -228,12 +291,19 @@ QString QueryGenerator::generateJoins( bool allColumns )
             default:
                 if ( column > Column_UserDefined ) {
                     joins.append( QString( "LEFT OUTER JOIN attr_values AS a%1 ON a%1.issue_id = i.issue_id AND a%1.attr_id = ?" ).arg( column - Column_UserDefined ) );
-                    m_arguments.append( column - Column_UserDefined );
+                    appendArgument( QueryArgument( QueryArgument::Constant, column - Column_UserDefined ) );
                 }
                 break;
         }
     }
 
+    if ( !m_pivotColumns.isEmpty() ) {
+        QStringList attributes;
+        foreach ( int column, m_pivotColumns )
+            attributes.append( QString::number( column - Column_UserDefined ) );
+        joins.append( QString( "LEFT OUTER JOIN attr_values AS av ON av.issue_id = i.issue_id AND av.attr_id IN ( %1 )" ).arg( attributes.join( ", " ) ) );
+    }
+
     return joins.join( " " );
 }
 
@@ -243,33 +313,39 @@ QString QueryGenerator::generateConditions()
 
     if ( m_folderId != 0 ) {
         conditions.append( "i.folder_id = ?" );
-        m_arguments.append( m_folderId );
+        appendArgument( QueryArgument( QueryArgument::FolderId ) );
     } else {
         conditions.append( "f.type_id = ?" );
-        m_arguments.append( m_typeId );
+        appendArgument( QueryArgument( QueryArgument::TypeId ) );
     }
 
     if ( m_folderId == 0 && m_projectId != 0 ) {
         conditions.append( "f.project_id = ?" );
-        m_arguments.append( m_projectId );
+        appendArgument( QueryArgument( QueryArgument::ProjectId ) );
     }
 
-    IssueTypeCache* cache = dataManager->issueTypeCache( m_typeId );
-
-    QList<DefinitionInfo> allFilters = m_filters;
+    QList<ViewFilter> allFilters = m_filters;
 
     if ( !m_searchText.isEmpty() ) {
-        DefinitionInfo info;
-        info.setType( m_searchColumn == Column_ID ? "EQ" : "CON" );
-        info.setMetadata( "column", m_searchColumn );
-        info.setMetadata( "value", m_searchText );
-        allFilters.append( info );
+        ViewFilter filter;
+        filter.m_column = m_searchColumn;
+        filter.m_operator = m_searchColumn == Column_ID ? "EQ" : "CON";
+        if ( m_searchColumn > Column_UserDefined ) {
+            IssueTypeCache* cache = dataManager->issueTypeCache( m_typeId );
+            filter.m_attributeType = AttributeHelper::toAttributeType( cache->attributeDefinition( m_searchColumn - Column_UserDefined ) );
+        }
+        allFilters.append( filter );
     }
 
-    foreach ( const DefinitionInfo& filter, allFilters ) {
-        QString type = filter.type();
-        int column = filter.metadata( "column" ).toInt();
-        QString value = filter.metadata( "value" ).toString();
+    for ( int i = 0; i < allFilters.count(); i++ ) {
+        const ViewFilter& filter = allFilters.at( i );
+        const QString& type = filter.m_operator;
+        int column = filter.m_column;
+
+        // the search text is bound as an argument, so the template can be reused for any text
+        bool search = ( i == m_filters.count() );
+
+        QueryArgument value( search ? QueryArgument::SearchText : QueryArgument::Constant, filter.m_value );
 
         QString expression;
 
@@ -300,38 +376,41 @@ QString QueryGenerator::generateConditions()
                 break;
         }
 
-        if ( value.isEmpty() ) {
+        if ( !search && filter.m_value.isEmpty() ) {
             conditions.append( makeNullCondition( expression, type ) );
             continue;
         }
 
         switch ( column ) {
             case Column_ID:
-                conditions.append( makeNumericCondition( expression, type, value.toInt() ) );
+                value.m_conversion = QueryArgument::ToInteger;
+                conditions.append( makeNumericCondition( expression, type, value ) );
                 break;
             case Column_Name:
             case Column_CreatedBy:
             case Column_ModifiedBy:
-                conditions.append( makeStringCondition( expression, type, convertUserValue( value ) ) );
+                value.m_userValue = true;
+                conditions.append( makeStringCondition( expression, type, value ) );
                 break;
             case Column_CreatedDate:
             case Column_ModifiedDate:
-                conditions.append( makeDateCondition( expression, type, convertDateTimeValue( value, false ) ) );
+                conditions.append( makeDateCondition( expression, type, filter.m_value, false ) );
                 break;
             default:
                 if ( column > Column_UserDefined ) {
-                    DefinitionInfo info = cache->attributeDefinition( column - Column_UserDefined );
-                    switch ( AttributeHelper::toAttributeType( info ) ) {
+                    switch ( filter.m_attributeType ) {
                         case TextAttribute:
                         case EnumAttribute:
                         case UserAttribute:
-                            conditions.append( makeStringCondition( QString( "COALESCE( %1, '' )" ).arg( expression ), type, convertUserValue( value ) ) );
+                            value.m_userValue = true;
+                            conditions.append( makeStringCondition( QString( "COALESCE( %1, '' )" ).arg( expression ), type, value ) );
                             break;
                         case NumericAttribute:
-                            conditions.append( makeNumericCondition( QString( "CAST( %1 AS REAL )" ).arg( expression ), type, value.toDouble() ) );
+                            value.m_conversion = QueryArgument::ToDouble;
+                            conditions.append( makeNumericCondition( QString( "CAST( %1 AS REAL )" ).arg( expression ), type, value ) );
                             break;
                         case DateTimeAttribute:
-                            conditions.append( makeDateCondition( QString( "CAST( STRFTIME( '%s', %1 ) AS INTEGER )" ).arg( expression ), type, convertDateTimeValue( value, info.metadata( "local" ).toBool() ) ) );
+                            conditions.append( makeDateCondition( QString( "CAST( STRFTIME( '%s', %1 ) AS INTEGER )" ).arg( expression ), type, filter.m_value, filter.m_local ) );
                             break;
                         default:
                             break;
@@ -344,6 +423,90 @@ QString QueryGenerator::generateConditions()
     return conditions.join( " AND " );
 }
 
+QString QueryGenerator::attributeExpression( int column ) const
+{
+    int attributeId = column - Column_UserDefined;
+
+    if ( m_pivotColumns.contains( column ) )
+        return QString( "MAX( CASE av.attr_id WHEN %1 THEN av.attr_value END )" ).arg( attributeId );
+
+    return QString( "a%1.attr_value" ).arg( attributeId );
+}
+
+void QueryGenerator::appendArgument( const QueryArgument& argument )
+{
+    // values which do not depend on the state of the generator are calculated only once
+    if ( isConstant( argument ) && ( argument.m_source != QueryArgument::Constant || argument.m_conversion != QueryArgument::NoConversion || argument.m_userValue ) )
+        m_template.m_arguments.append( QueryArgument( QueryArgument::Constant, evaluateArgument( argument ) ) );
+    else
+        m_template.m_arguments.append( argument );
+}
+
+void QueryGenerator::bindArguments()
+{
+    m_arguments.clear();
+
+    foreach ( const QueryArgument& argument, m_template.m_arguments )
+        m_arguments.append( evaluateArgument( argument ) );
+}
+
+bool QueryGenerator::isConstant( const QueryArgument& argument ) const
+{
+    switch ( argument.m_source ) {
+        case QueryArgument::Constant:
+            return true;
+        case QueryArgument::DateLower:
+        case QueryArgument::DateUpper:
+            return !argument.m_value.toString().startsWith( QLatin1String( "[Today]" ) );
+        default:
+            return false;
+    }
+}
+
+QVariant QueryGenerator::evaluateArgument( const QueryArgument& argument ) const
+{
+    QVariant value;
+
+    switch ( argument.m_source ) {
+        case QueryArgument::Constant:
+            value = argument.m_value;
+            break;
+        case QueryArgument::CurrentUserId:
+            return dataManager->currentUserId();
+        case QueryArgument::FolderId:
+            return m_folderId;
+        case QueryArgument::TypeId:
+            return m_typeId;
+        case QueryArgument::ProjectId:
+            return m_projectId;
+        case QueryArgument::SearchText:
+            value = m_searchText;
+            break;
+        case QueryArgument::DateLower:
+            return (int)convertDateTimeValue( argument.m_value.toString(), argument.m_local ).toTime_t();
+        case QueryArgument::DateUpper:
+            return (int)convertDateTimeValue( argument.m_value.toString(), argument.m_local ).addDays( 1 ).addSecs( -1 ).toTime_t();
+    }
+
+    if ( argument.m_userValue )
+        value = convertUserValue( value.toString() );
+
+    switch ( argument.m_conversion ) {
+        case QueryArgument::ToInteger:
+            return value.toString().toInt();
+        case QueryArgument::ToDouble:
+            return value.toString().toDouble();
+        case QueryArgument::ContainsPattern:
+            return QString( QLatin1String( ".*" ) + QRegExp::escape( value.toString() ) + QLatin1String( ".*" ) );
+        case QueryArgument::BeginsPattern:
+            return QString( QRegExp::escape( value.toString() ) + QLatin1String( ".*" ) );
+        case QueryArgument::EndsPattern:
+            return QString( QLatin1String( ".*" ) + QRegExp::escape( value.toString() ) );
+        default:
+            return value;
+    }
+}
+
 QString QueryGenerator::convertUserValue( const QString& value ) const
 {
     if ( value.startsWith( QLatin1String( "[Me]" ) ) )
@@ -368,39 +531,49 @@ QDateTime QueryGenerator::convertDateTimeValue( const QString& value, bool local
     return QDateTime( date, QTime( 0, 0 ), local ? Qt::LocalTime : Qt::UTC );
 }
 
-QString QueryGenerator::makeStringCondition( const QString& expression, const QString& type, const QString& value )
+QString QueryGenerator::makeStringCondition( const QString& expression, const QString& type, const QueryArgument& value )
 {
     if ( type == QLatin1String( "EQ" ) ) {
-        m_arguments.append( value );
+        appendArgument( value );
         return QString( "%1 COLLATE NOCASE = ?" ).arg( expression );
     }
     if ( type == QLatin1String( "NEQ" ) ) {
-        m_arguments.append( value );
+        appendArgument( value );
         return QString( "%1 COLLATE NOCASE <> ?" ).arg( expression );
     }
     if ( type == QLatin1String( "CON" ) ) {
-        m_arguments.append( QLatin1String( ".*" ) + QRegExp::escape( value ) + QLatin1String( ".*" ) );
+        QueryArgument pattern = value;
+        pattern.m_conversion = QueryArgument::ContainsPattern;
+        appendArgument( pattern );
         return QString( "%1 REGEXP ?" ).arg( expression );
     }
     if ( type == QLatin1String( "BEG" ) ) {
-        m_arguments.append( QRegExp::escape( value ) + QLatin1String( ".*" ) );
+        QueryArgument pattern = value;
+        pattern.m_conversion = QueryArgument::BeginsPattern;
+        appendArgument( pattern );
         return QString( "%1 REGEXP ?" ).arg( expression );
     }
     if ( type == QLatin1String( "END" ) ) {
-        m_arguments.append( QLatin1String( ".*" ) + QRegExp::escape( value ) );
+        QueryArgument pattern = value;
+        pattern.m_conversion = QueryArgument::EndsPattern;
+        appendArgument( pattern );
         return QString( "%1 REGEXP ?" ).arg( expression );
     }
     if ( type == QLatin1String( "IN" ) ) {
-        QStringList items = value.split(  ", " );
+        // the number of placeholders depends on the value
+        if ( !isConstant( value ) )
+            m_template.m_cacheable = false;
+        QString text = evaluateArgument( value ).toString();
+        QStringList items = text.split(  ", " );
         if ( items.count() >= 2 ) {
             QStringList placeholders;
             foreach ( const QString item, items ) {
-                m_arguments.append( item );
+                appendArgument( QueryArgument( QueryArgument::Constant, item ) );
                 placeholders.append( "?" );
             }
             return QString( "%1 COLLATE NOCASE IN ( %2 )" ).arg( expression, placeholders.join( ", " ) );
         } else {
-            m_arguments.append( value );
+            appendArgument( QueryArgument( QueryArgument::Constant, text ) );
             return QString( "%1 COLLATE NOCASE = ?" ).arg( expression );
         }
     }
@@ -420,9 +593,9 @@ QString QueryGenerator::makeNullCondition( const QString& expression, const QStr
     return QString();
 }
 
-QString QueryGenerator::makeNumericCondition( const QString& expression, const QString& type, const QVariant& value )
+QString QueryGenerator::makeNumericCondition( const QString& expression, const QString& type, const QueryArgument& value )
 {
-    m_arguments.append( value );
+    appendArgument( value );
 
     if ( type == QLatin1String( "EQ" ) )
         return QString( "%1 = ?" ).arg( expression );
@@ -441,35 +614,37 @@ QString QueryGenerator::makeNumericCondition( const QString& expression, const Q
     return QString();
 }
 
-QString QueryGenerator::makeDateCondition( const QString& expression, const QString& type, const QDateTime& value )
+QString QueryGenerator::makeDateCondition( const QString& expression, const QString& type, const QString& value, bool local )
 {
-    int lower = value.toTime_t();
-    int upper = value.addDays( 1 ).addSecs( -1 ).toTime_t();
+    QueryArgument lower( QueryArgument::DateLower, value );
+    lower.m_local = local;
+    QueryArgument upper( QueryArgument::DateUpper, value );
+    upper.m_local = local;
 
     if ( type == QLatin1String( "EQ" ) ) {
-        m_arguments.append( lower );
-        m_arguments.append( upper );
+        appendArgument( lower );
+        appendArgument( upper );
         return QString( "%1 BETWEEN ? AND ?" ).arg( expression );
     }
     if ( type == QLatin1String( "NEQ" ) ) {
-        m_arguments.append( lower );
-        m_arguments.append( upper );
+        appendArgument( lower );
+        appendArgument( upper );
         return QString( "%1 NOT BETWEEN ? AND ?" ).arg( expression );
     }
     if ( type == QLatin1String( "GT" ) ) {
-        m_arguments.append( upper );
+        appendArgument( upper );
         return QString( "%1 > ?" ).arg( expression );
     }
     if ( type == QLatin1String( "LT" ) ) {
-        m_arguments.append( lower );
+        appendArgument( lower );
         return QString( "%1 < ?" ).arg( expression );
     }
     if ( type == QLatin1String( "GTE" ) ) {
-        m_arguments.append( lower );
+        appendArgument( lower );
         return QString( "%1 >= ?" ).arg( expression );
     }
     if ( type == QLatin1String( "LTE" ) ) {
-        m_arguments.append( upper );
+        appendArgument( upper );
         return QString( "%1 <= ?" ).arg( expression );
     }
 
@@ -477,7 +652,7 @@ QString QueryGenerator::makeDateCondition( const QString& expression, const QStr
     return QString();
 }
 
-QList<QStringList> QueryGenerator::sortColumns() const
+QList<QStringList> QueryGenerator::generateSortColumns() const
 {
     QList<QStringList> result;
 
@@ -516,13 +691,13 @@ QList<QStringList> QueryGenerator::sortColumns() const
                             case TextAttribute:
                             case EnumAttribute:
                             case UserAttribute:
-                                columns.append( QString( "a%1.attr_value COLLATE LOCALE" ).arg( column - Column_UserDefined ) );
+                                columns.append( QString( "%1 COLLATE LOCALE" ).arg( attributeExpression( column ) ) );
                                 break;
                             case NumericAttribute:
-                                columns.append( QString( "CAST( a%1.attr_value AS REAL )" ).arg( column - Column_UserDefined ) );
+                                columns.append( QString( "CAST( %1 AS REAL )" ).arg( attributeExpression( column ) ) );
                                 break;
                             case DateTimeAttribute:
-                                columns.append( QString( "CAST( STRFTIME( '%s', a%1.attr_value ) AS INTEGER )" ).arg( column - Column_UserDefined ) );
+                                columns.append( QString( "CAST( STRFTIME( '%s', %1 ) AS INTEGER )" ).arg( attributeExpression( column ) ) );
                                 break;
                             default:
                                 break;
@@ -541,7 +716,7 @@ QList<int> QueryGenerator::columnMapping() const
 {
     QList<int> result;
 
-    if ( m_valid ) {
+    if ( m_template.m_valid ) {
         int index = 4;
 
         foreach ( int column, m_columns ) {
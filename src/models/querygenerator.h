@@ -20,9 +20,11 @@
 #ifndef QUERYGENERATOR_H
 #define QUERYGENERATOR_H
 
-#include <QObject>
+#include "data/viewplan.h"
 
-class DefinitionInfo;
+#include <QObject>
+#include <QStringList>
+#include <QVariant>
 
 class QDateTime;
 
@@ -94,13 +96,19 @@ public:
     /**
     * Return the list of sort expressions for each column.
     */
-    QList<QStringList> sortColumns() const;
+    const QList<QStringList>& sortColumns() const { return m_template.m_sortColumns; }
 
     /**
     * Return the column mapping for the view.
     */
     QList<int> columnMapping() const;
 
+    /**
+    * Return the index of the project name in the result of the query
+    * or -1 if it is not retrieved.
+    */
+    int projectColumn() const { return m_template.m_projectColumn; }
+
     /**
     * Return the index of the default sort column.
     */
@@ -114,17 +122,32 @@ public:
 private:
     void initializeCommon( bool withLocation );
 
+    int templateKey( bool allColumns ) const;
+
+    void generateTemplate( bool allColumns );
+
+    void planJoins( bool allColumns );
+
     QString generateSelect( bool allColumns );
     QString generateJoins( bool allColumns );
     QString generateConditions();
+    QList<QStringList> generateSortColumns() const;
+
+    QString attributeExpression( int column ) const;
+
+    void appendArgument( const QueryArgument& argument );
+    void bindArguments();
+
+    bool isConstant( const QueryArgument& argument ) const;
+    QVariant evaluateArgument( const QueryArgument& argument ) const;
 
     QString convertUserValue( const QString& value ) const;
     QDateTime convertDateTimeValue( const QString& value, bool local ) const;
 
     QString makeNullCondition( const QString& expression, const QString& type );
-    QString makeStringCondition( const QString& expression, const QString& type, const QString& value );
-    QString makeNumericCondition( const QString& expression, const QString& type, const QVariant& value );
-    QString makeDateCondition( const QString& expression, const QString& type, const QDateTime& value );
+    QString makeStringCondition( const QString& expression, const QString& type, const QueryArgument& value );
+    QString makeNumericCondition( const QString& expression, const QString& type, const QueryArgument& value );
+    QString makeDateCondition( const QString& expression, const QString& type, const QString& value, bool local );
 
 private:
     int m_folderId;
@@ -132,9 +155,12 @@ private:
     int m_viewId;
     int m_projectId;
 
+    const ViewPlan* m_plan;
+    bool m_forceColumns;
+
     QList<int> m_columns;
 
-    QList<DefinitionInfo> m_filters;
+    QList<ViewFilter> m_filters;
 
     int m_searchColumn;
     QString m_searchText;
@@ -142,7 +168,12 @@ private:
     int m_sortColumn;
     Qt::SortOrder m_sortOrder;
 
+    QList<int> m_joinColumns;
+    QList<int> m_pivotColumns;
+
     bool m_valid;
+    QueryTemplate m_template;
+
     QList<QVariant> m_arguments;
 };
 
@@ -0,0 +1,62 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "queryresultmodel.h"
+
+QueryResultModel::QueryResultModel( QObject* parent ) : QSqlQueryModel( parent )
+{
+}
+
+QueryResultModel::~QueryResultModel()
+{
+}
+
+void QueryResultModel::setResult( const QueryResult& result )
+{
+    beginResetModel();
+    m_result = result;
+    endResetModel();
+}
+
+int QueryResultModel::rowCount( const QModelIndex& parent ) const
+{
+    if ( parent.isValid() )
+        return 0;
+    return m_result.rowCount();
+}
+
+int QueryResultModel::columnCount( const QModelIndex& parent ) const
+{
+    if ( parent.isValid() )
+        return 0;
+    return m_result.columnCount();
+}
+
+QVariant QueryResultModel::data( const QModelIndex& index, int role ) const
+{
+    if ( role != Qt::DisplayRole && role != Qt::EditRole )
+        return QVariant();
+
+    return m_result.value( index.row(), index.column() );
+}
+
+bool QueryResultModel::canFetchMore( const QModelIndex& /*parent*/ ) const
+{
+    return false;
+}
@@ -0,0 +1,71 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef QUERYRESULTMODEL_H
+#define QUERYRESULTMODEL_H
+
+#include "data/querythread.h"
+
+#include <QSqlQueryModel>
+
+/**
+* Model providing rows which were retrieved in the background.
+*
+* This model can be used by the SqlTreeModel in place of a regular
+* QSqlQueryModel. Its contents are replaced at once by setResult().
+*/
+class QueryResultModel : public QSqlQueryModel
+{
+    Q_OBJECT
+public:
+    /**
+    * Constructor.
+    * @param parent The parent object.
+    */
+    QueryResultModel( QObject* parent );
+
+    /**
+    * Destructor.
+    */
+    ~QueryResultModel();
+
+public:
+    /**
+    * Replace the contents of the model.
+    */
+    void setResult( const QueryResult& result );
+
+    /**
+    * Return the contents of the model.
+    */
+    const QueryResult& result() const { return m_result; }
+
+public: // overrides
+    int rowCount( const QModelIndex& parent = QModelIndex() ) const;
+    int columnCount( const QModelIndex& parent = QModelIndex() ) const;
+
+    QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
+
+    bool canFetchMore( const QModelIndex& parent = QModelIndex() ) const;
+
+private:
+    QueryResult m_result;
+};
+
+#endif
@@ -23,17 +23,29 @@
 #include "commands/commandmanager.h"
 #include "data/datamanager.h"
 #include "data/entities.h"
+#include "data/issuebatch.h"
+#include "data/issuetypecache.h"
+#include "data/query.h"
 #include "models/issuedetailsgenerator.h"
 #include "models/foldermodel.h"
+#include "models/querygenerator.h"
+#include "models/summaryrenderer.h"
 #include "utils/htmlwriter.h"
 #include "utils/csvwriter.h"
+#include "utils/viewsettingshelper.h"
+
+#include <QSqlDatabase>
+#include <QDateTime>
+#include <QThread>
 
 ReportGenerator::ReportGenerator() :
     m_folderId( 0 ),
     m_typeId( 0 ),
     m_summary( false ),
     m_description( false ),
-    m_history( IssueDetailsGenerator::NoHistory )
+    m_history( IssueDetailsGenerator::NoHistory ),
+    m_projectColumn( 0 ),
+    m_canceled( false )
 {
 }
 
@@ -84,76 +96,238 @@ void ReportGenerator::setSummaryMode( bool description, IssueDetailsGenerator::H
     m_history = history;
 }
 
-void ReportGenerator::write( HtmlWriter* writer )
+bool ReportGenerator::write( HtmlWriter* writer )
 {
+    m_canceled = false;
+
     if ( m_folderId != 0 || m_typeId != 0 )
         writer->writeBlock( m_title, HtmlWriter::Header2Block );
 
     if ( !m_summary ) {
-        FolderModel model( NULL );
-        if ( m_folderId != 0 )
-            model.initializeFolder( m_folderId );
-        else if ( m_typeId != 0 )
-            model.initializeGlobalList( m_typeId );
-        model.setColumns( m_columns );
-
-        QStringList headers;
-        for ( int i = 0; i < m_columns.count(); i++ ) {
-            QString name = model.headerData( i, Qt::Horizontal, Qt::DisplayRole ).toString();
-            headers.append( name );
-        }
-        writer->createTable( headers );
-
-        for ( int i = 0; i < m_issues.count(); i++ ) {
-            QModelIndex index = model.findIndex( 0, m_issues.at( i ), 0 );
-            if ( index.isValid() ) {
-                QList<HtmlText> cells;
-                for ( int j = 0; j < m_columns.count(); j++ ) {
-                    QString text = model.data( model.index( index.row(), j ), Qt::DisplayRole ).toString();
-                    cells.append( HtmlText::parse( text, HtmlText::NoInternalLinks ) );
-                }
-                writer->appendTableRow( cells );
+        Query query;
+        if ( !executeTableQuery( query ) )
+            return false;
+
+        writer->createTable( m_headers );
+
+        int row = 0;
+        while ( query.next() ) {
+            QList<HtmlText> cells;
+            for ( int j = 0; j < m_columns.count(); j++ )
+                cells.append( HtmlText::parse( formatCell( query, j ), HtmlText::NoInternalLinks ) );
+            writer->appendTableRow( cells );
+
+            if ( ++row % ProgressInterval == 0 ) {
+                writer->flush();
+                if ( !reportProgress( row ) )
+                    return false;
             }
         }
 
         writer->endTable();
     } else {
-        IssueDetailsGenerator generator;
+        int written = 0;
 
-        for ( int i = 0; i < m_issues.count(); i++ ) {
-            generator.setIssue( m_issues.at( i ), m_description,  m_history );
-            generator.write( writer, HtmlText::NoInternalLinks );
+        if ( m_issues.count() >= ParallelThreshold && QThread::idealThreadCount() > 1 ) {
+            if ( !writeParallelSummary( writer, written ) )
+                return false;
         }
+
+        // the remaining issues are written sequentially if rendering in parallel failed
+        if ( written < m_issues.count() && !writeSummary( writer, written ) )
+            return false;
     }
+
+    return true;
 }
 
-void ReportGenerator::write( CsvWriter* writer )
+bool ReportGenerator::write( CsvWriter* writer )
 {
+    m_canceled = false;
+
     if ( !m_summary ) {
-        FolderModel model( NULL );
-        if ( m_folderId != 0 )
-            model.initializeFolder( m_folderId );
-        else if ( m_typeId != 0 )
-            model.initializeGlobalList( m_typeId );
-        model.setColumns( m_columns );
-
-        QStringList headers;
-        for ( int i = 0; i < m_columns.count(); i++ ) {
-            QString name = model.headerData( i, Qt::Horizontal, Qt::DisplayRole ).toString();
-            headers.append( name );
+        Query query;
+        if ( !executeTableQuery( query ) )
+            return false;
+
+        writer->appendRow( m_headers );
+
+        int row = 0;
+        while ( query.next() ) {
+            QStringList cells;
+            for ( int j = 0; j < m_columns.count(); j++ )
+                cells.append( formatCell( query, j ) );
+            writer->appendRow( cells );
+
+            if ( ++row % ProgressInterval == 0 && !reportProgress( row ) )
+                return false;
         }
-        writer->appendRow( headers );
-
-        for ( int i = 0; i < m_issues.count(); i++ ) {
-            QModelIndex index = model.findIndex( 0, m_issues.at( i ), 0 );
-            if ( index.isValid() ) {
-                QStringList cells;
-                for ( int j = 0; j < m_columns.count(); j++ ) {
-                    QString text = model.data( model.index( index.row(), j ), Qt::DisplayRole ).toString();
-                    cells.append( text );
-                }
-                writer->appendRow( cells );
-            }
+    }
+
+    writer->flush();
+
+    return true;
+}
+
+void ReportGenerator::cancel()
+{
+    m_canceled = true;
+}
+
+bool ReportGenerator::reportProgress( int value )
+{
+    emit progress( value );
+
+    return !m_canceled;
+}
+
+bool ReportGenerator::writeSummary( HtmlWriter* writer, int first )
+{
+    IssueDetailsGenerator generator;
+
+    IssueBatch batch;
+    generator.setIssueBatch( &batch );
+
+    for ( int i = first; i < m_issues.count(); i++ ) {
+        // load details of multiple issues at once instead of querying each issue separately
+        if ( ( i - first ) % IssueBatchSize == 0 )
+            batch.load( m_issues.mid( i, IssueBatchSize ), m_description, m_history != IssueDetailsGenerator::NoHistory );
+
+        generator.setIssue( m_issues.at( i ), m_description,  m_history );
+        generator.writeHeader( writer, HtmlText::NoInternalLinks );
+
+        // write the history in pages and flush each page to avoid keeping all items in memory
+        int count = generator.historyItemsCount();
+        for ( int page = 0; page < count; page += HistoryPageSize ) {
+            generator.writeHistoryItems( writer, page, HistoryPageSize, HtmlText::NoInternalLinks );
+            writer->flush();
+        }
+
+        generator.writeFooter( writer );
+
+        writer->flush();
+        if ( !reportProgress( i + 1 ) )
+            return false;
+    }
+
+    return true;
+}
+
+bool ReportGenerator::writeParallelSummary( HtmlWriter* writer, int& written )
+{
+    SummaryRenderer renderer( m_description, m_history, HtmlText::NoInternalLinks );
+
+    while ( written < m_issues.count() ) {
+        QStringList fragments;
+        if ( !renderer.render( m_issues.mid( written, renderer.batchSize() ), fragments ) )
+            break;
+
+        foreach ( const QString& fragment, fragments )
+            writer->appendHtml( fragment );
+
+        written += fragments.count();
+
+        writer->flush();
+        if ( !reportProgress( written ) )
+            return false;
+    }
+
+    return true;
+}
+
+bool ReportGenerator::executeTableQuery( Query& query )
+{
+    QueryGenerator generator;
+    if ( m_folderId != 0 )
+        generator.initializeFolder( m_folderId, 0 );
+    else if ( m_typeId != 0 )
+        generator.initializeGlobalList( m_typeId, 0 );
+    generator.setColumns( m_columns );
+
+    QString sql = generator.query( true );
+    if ( sql.isEmpty() )
+        return false;
+
+    prepareColumns( generator );
+
+    // the rows are retrieved in the order in which the issues were passed to the report
+    QSqlDatabase database = QSqlDatabase::database();
+
+    Query positionQuery( database );
+    if ( !positionQuery.execQuery( "CREATE TEMP TABLE IF NOT EXISTS report_issues ( issue_id integer PRIMARY KEY, position integer )" ) )
+        return false;
+
+    if ( !database.transaction() )
+        return false;
+
+    bool ok = positionQuery.execQuery( "DELETE FROM report_issues" );
+
+    if ( ok ) {
+        positionQuery.setQuery( "INSERT OR IGNORE INTO report_issues VALUES ( ?, ? )" );
+        for ( int i = 0; i < m_issues.count() && ok; i++ )
+            ok = positionQuery.exec( m_issues.at( i ), i );
+    }
+
+    if ( ok )
+        ok = database.commit();
+
+    if ( !ok ) {
+        database.rollback();
+        return false;
+    }
+
+    query.setQuery( QString( "SELECT q.* FROM ( %1 ) AS q JOIN report_issues AS r ON r.issue_id = q.issue_id ORDER BY r.position" ).arg( sql ) );
+
+    return query.exec( generator.arguments() );
+}
+
+void ReportGenerator::prepareColumns( const QueryGenerator& generator )
+{
+    int typeId = generator.typeId();
+
+    m_columns = generator.columns();
+    m_mapping = generator.columnMapping();
+
+    m_headers.clear();
+    m_definitions.clear();
+
+    ViewSettingsHelper helper( typeId );
+    IssueTypeCache* cache = dataManager->issueTypeCache( typeId );
+
+    for ( int i = 0; i < m_columns.count(); i++ ) {
+        int column = m_columns.at( i );
+        m_headers.append( helper.columnName( column ) );
+        if ( column > Column_UserDefined )
+            m_definitions.append( cache->attributeDefinition( column - Column_UserDefined ) );
+        else
+            m_definitions.append( DefinitionInfo() );
+    }
+
+    m_projectColumn = generator.projectColumn();
+}
+
+QString ReportGenerator::formatCell( const Query& query, int index ) const
+{
+    QVariant value = query.value( m_mapping.at( index ) );
+
+    switch ( m_columns.at( index ) ) {
+        case Column_ID:
+            return QString( "#%1" ).arg( value.toInt() );
+        case Column_Name:
+        case Column_CreatedBy:
+        case Column_ModifiedBy:
+            return value.toString();
+        case Column_CreatedDate:
+        case Column_ModifiedDate: {
+            QDateTime dateTime;
+            dateTime.setTime_t( value.toInt() );
+            return m_formatter.formatDateTime( dateTime, true );
         }
+        case Column_Location:
+            return query.value( m_projectColumn ).toString() + QString::fromUtf8( " — " ) + value.toString();
+        default:
+            if ( !value.isNull() && m_columns.at( index ) > Column_UserDefined )
+                return m_formatter.convertAttributeValue( m_definitions.at( index ), value.toString(), false );
+            return QString();
     }
 }
@@ -22,8 +22,13 @@
 
 #include "issuedetailsgenerator.h"
 
+#include "utils/definitioninfo.h"
+#include "utils/formatter.h"
+
 class HtmlWriter;
 class CsvWriter;
+class Query;
+class QueryGenerator;
 class FolderRow;
 class IssueRow;
 
@@ -90,15 +95,69 @@ public:
 
     /**
     * Write the report as a text document.
+    * The output is periodically flushed when the writer has a device.
     * @param writer The text document writer to output the report to.
+    * @return @c false if generating the report failed or was canceled.
     */
-    void write( HtmlWriter* writer );
+    bool write( HtmlWriter* writer );
 
     /**
     * Write the report as a CSV file.
     * @param writer The CSV file writer to output the report to.
+    * @return @c false if generating the report failed or was canceled.
+    */
+    bool write( CsvWriter* writer );
+
+    /**
+    * Return @c true if writing the report was canceled by the user.
+    */
+    bool isCanceled() const { return m_canceled; }
+
+public slots:
+    /**
+    * Stop generating the report.
+    */
+    void cancel();
+
+signals:
+    /**
+    * Emitted periodically while the report is generated.
+    * @param value The number of issues written so far.
+    */
+    void progress( int value );
+
+private:
+    bool reportProgress( int value );
+
+    bool writeSummary( HtmlWriter* writer, int first );
+    bool writeParallelSummary( HtmlWriter* writer, int& written );
+
+    bool executeTableQuery( Query& query );
+
+    void prepareColumns( const QueryGenerator& generator );
+
+    QString formatCell( const Query& query, int index ) const;
+
+private:
+    /**
+    * The number of history items written at once in summary mode.
+    */
+    static const int HistoryPageSize = 100;
+
+    /**
+    * The number of issues whose details are loaded at once in summary mode.
+    */
+    static const int IssueBatchSize = 100;
+
+    /**
+    * The minimum number of issues rendered in parallel in summary mode.
+    */
+    static const int ParallelThreshold = 50;
+
+    /**
+    * The number of table rows written between progress notifications.
     */
-    void write( CsvWriter* writer );
+    static const int ProgressInterval = 500;
 
 private:
     int m_folderId;
@@ -111,6 +170,15 @@ private:
     IssueDetailsGenerator::History m_history;
 
     QString m_title;
+
+    QStringList m_headers;
+    QList<int> m_mapping;
+    QList<DefinitionInfo> m_definitions;
+    int m_projectColumn;
+
+    Formatter m_formatter;
+
+    bool m_canceled;
 };
 
 #endif
@@ -19,6 +19,8 @@
 
 #include "sqltreemodel.h"
 
+#include "utils/profiler.h"
+
 #include <QSqlQueryModel>
 #include <QVector>
 #include <QHash>
@@ -140,6 +142,8 @@ void SqlTreeModel::setColumnMapping( int level, const QList<int>& columnMapping
 
 void SqlTreeModel::updateData()
 {
+    ProfilerScope scope( "SqlTreeModel::updateData" );
+
     bool columnsChanged = false;
 
     if ( d->m_columns == -1 ) {
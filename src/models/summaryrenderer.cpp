@@ -0,0 +1,186 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#include "summaryrenderer.h"
+
+#include "data/datamanager.h"
+#include "data/entities.h"
+#include "data/issuebatch.h"
+#include "data/threadconnection.h"
+#include "utils/htmlwriter.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <QSqlDatabase>
+
+class SummaryWorker : public QRunnable
+{
+public:
+    SummaryWorker( SummaryRenderer* renderer ) :
+        m_renderer( renderer )
+    {
+    }
+
+public:
+    void run()
+    {
+        m_renderer->runWorker();
+    }
+
+private:
+    SummaryRenderer* m_renderer;
+};
+
+SummaryRenderer::SummaryRenderer( bool description, IssueDetailsGenerator::History history, HtmlText::Flags flags ) :
+    m_description( description ),
+    m_history( history ),
+    m_flags( flags ),
+    m_workersCount( qMax( QThread::idealThreadCount(), 1 ) ),
+    m_nextChunk( 0 ),
+    m_pendingChunks( 0 ),
+    m_started( false ),
+    m_failed( false ),
+    m_stop( false )
+{
+    m_databaseName = QSqlDatabase::database().databaseName();
+
+    m_pool.setMaxThreadCount( m_workersCount );
+}
+
+SummaryRenderer::~SummaryRenderer()
+{
+    m_mutex.lock();
+    m_stop = true;
+    m_workCondition.wakeAll();
+    m_mutex.unlock();
+
+    m_pool.waitForDone();
+}
+
+void SummaryRenderer::setWorkersCount( int count )
+{
+    if ( m_started )
+        return;
+
+    m_workersCount = qMax( count, 1 );
+
+    m_pool.setMaxThreadCount( m_workersCount );
+}
+
+bool SummaryRenderer::render( const QList<int>& issues, QStringList& fragments )
+{
+    fragments.clear();
+
+    if ( issues.isEmpty() )
+        return true;
+
+    // create caches of all issue types in advance because the workers cannot modify the data manager
+    foreach ( const TypeEntity& type, TypeEntity::list() )
+        dataManager->issueTypeCache( type.id() );
+
+    if ( !m_started ) {
+        for ( int i = 0; i < m_workersCount; i++ )
+            m_pool.start( new SummaryWorker( this ) );
+        m_started = true;
+    }
+
+    QMutexLocker locker( &m_mutex );
+
+    m_issues = issues;
+    m_chunks.fill( QStringList(), ( issues.count() + ChunkSize - 1 ) / ChunkSize );
+    m_nextChunk = 0;
+    m_pendingChunks = m_chunks.count();
+
+    m_workCondition.wakeAll();
+
+    while ( m_pendingChunks > 0 )
+        m_doneCondition.wait( &m_mutex );
+
+    if ( !m_failed ) {
+        foreach ( const QStringList& chunk, m_chunks )
+            fragments += chunk;
+    }
+
+    m_chunks.clear();
+    m_nextChunk = 0;
+
+    return !m_failed;
+}
+
+void SummaryRenderer::runWorker()
+{
+    ThreadConnection connection( m_databaseName );
+
+    IssueDetailsGenerator generator;
+
+    QMutexLocker locker( &m_mutex );
+
+    if ( !connection.isOpen() )
+        m_failed = true;
+
+    for ( ;; ) {
+        while ( !m_stop && m_nextChunk >= m_chunks.count() )
+            m_workCondition.wait( &m_mutex );
+
+        if ( m_stop )
+            break;
+
+        int chunk = m_nextChunk++;
+        QList<int> issues = m_issues.mid( chunk * ChunkSize, ChunkSize );
+
+        locker.unlock();
+
+        // a worker without a connection only completes the chunks so that render() can return
+        QStringList fragments;
+        if ( connection.isOpen() )
+            fragments = renderChunk( &generator, issues );
+
+        locker.relock();
+
+        m_chunks[ chunk ] = fragments;
+
+        if ( --m_pendingChunks == 0 )
+            m_doneCondition.wakeAll();
+    }
+}
+
+QStringList SummaryRenderer::renderChunk( IssueDetailsGenerator* generator, const QList<int>& issues )
+{
+    QStringList fragments;
+
+    IssueBatch batch;
+    batch.load( issues, m_description, m_history != IssueDetailsGenerator::NoHistory );
+
+    generator->setIssueBatch( &batch );
+
+    foreach ( int issueId, issues ) {
+        HtmlWriter writer;
+
+        generator->setIssue( issueId, m_description, m_history );
+        generator->writeHeader( &writer, m_flags );
+        generator->writeHistoryItems( &writer, 0, generator->historyItemsCount(), m_flags );
+        generator->writeFooter( &writer );
+
+        fragments.append( writer.bodyHtml() );
+    }
+
+    generator->setIssueBatch( NULL );
+
+    return fragments;
+}
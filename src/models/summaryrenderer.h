@@ -0,0 +1,123 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef SUMMARYRENDERER_H
+#define SUMMARYRENDERER_H
+
+#include "issuedetailsgenerator.h"
+
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QVector>
+
+/**
+* Class rendering summaries of multiple issues in parallel.
+*
+* The issues are divided into chunks which are processed by workers running
+* in a separate thread pool. Each worker opens a read-only connection to the
+* database, loads details of a chunk of issues in bulk and renders them using
+* the IssueDetailsGenerator.
+*
+* The workers are only running during a call to render(), so the data
+* shared with the main thread cannot be modified while they are active.
+*/
+class SummaryRenderer
+{
+public:
+    /**
+    * Constructor.
+    * @param description @c true if the description should be included.
+    * @param history Type of issue history to be included.
+    * @param flags Optional flags affecting extracting of links.
+    */
+    SummaryRenderer( bool description, IssueDetailsGenerator::History history, HtmlText::Flags flags = 0 );
+
+    /**
+    * Destructor.
+    * Stops the workers and waits until they are finished.
+    */
+    ~SummaryRenderer();
+
+public:
+    /**
+    * Set the number of worker threads.
+    * By default the ideal number of threads is used. The number of workers
+    * can only be changed before the first call to render().
+    */
+    void setWorkersCount( int count );
+
+    /**
+    * Return the number of worker threads.
+    */
+    int workersCount() const { return m_workersCount; }
+
+    /**
+    * Return the recommended number of issues passed to render() at once.
+    */
+    int batchSize() const { return m_workersCount * ChunkSize * 2; }
+
+    /**
+    * Render summaries of the given issues.
+    * The call blocks until all issues are rendered.
+    * @param issues Identifiers of issues to render.
+    * @param fragments Rendered HTML fragments in the order of issues.
+    * @return @c false if a worker could not connect to the database.
+    */
+    bool render( const QList<int>& issues, QStringList& fragments );
+
+private:
+    void runWorker();
+
+    QStringList renderChunk( IssueDetailsGenerator* generator, const QList<int>& issues );
+
+private:
+    friend class SummaryWorker;
+
+    /**
+    * The number of issues loaded and rendered by a worker at once.
+    */
+    static const int ChunkSize = 20;
+
+private:
+    bool m_description;
+    IssueDetailsGenerator::History m_history;
+    HtmlText::Flags m_flags;
+
+    QString m_databaseName;
+
+    QThreadPool m_pool;
+    int m_workersCount;
+
+    QMutex m_mutex;
+    QWaitCondition m_workCondition;
+    QWaitCondition m_doneCondition;
+
+    QList<int> m_issues;
+    QVector<QStringList> m_chunks;
+    int m_nextChunk;
+    int m_pendingChunks;
+
+    bool m_started;
+    bool m_failed;
+    bool m_stop;
+};
+
+#endif
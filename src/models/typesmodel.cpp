@@ -41,6 +41,8 @@ TypesModel::TypesModel( QObject* parent ) : BaseModel( parent )
     setHeaderData( 3, Qt::Horizontal, tr( "Required" ) );
     setHeaderData( 4, Qt::Horizontal, tr( "Details" ) );
 
+    dataManager->subscribe( this, UpdateEvent::Types );
+
     refresh();
 }
 
@@ -107,6 +109,6 @@ void TypesModel::refresh()
 
 void TypesModel::updateEvent( UpdateEvent* e )
 {
-    if ( e->unit() == UpdateEvent::Types )
+    if ( e->contains( UpdateEvent::Types ) )
         refresh();
 }
@@ -36,6 +36,9 @@ UserProjectsModel::UserProjectsModel( int userId, QObject* parent ) : BaseModel(
 
     setSort( 0, Qt::AscendingOrder );
 
+    dataManager->subscribe( this, UpdateEvent::Users );
+    dataManager->subscribe( this, UpdateEvent::Projects );
+
     updateQueries();
 }
 
@@ -109,6 +112,6 @@ void UserProjectsModel::refresh()
 
 void UserProjectsModel::updateEvent( UpdateEvent* e )
 {
-    if ( e->unit() == UpdateEvent::Users || e->unit() == UpdateEvent::Projects )
+    if ( e->contains( UpdateEvent::Users ) || e->contains( UpdateEvent::Projects ) )
         refresh();
 }
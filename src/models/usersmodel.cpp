@@ -46,6 +46,8 @@ UsersModel::UsersModel( QObject* parent ) : BaseModel( parent ),
 
     setSort( 0, Qt::AscendingOrder );
 
+    dataManager->subscribe( this, UpdateEvent::Users );
+
     updateQueries();
 }
 
@@ -136,6 +138,6 @@ void UsersModel::refresh()
 
 void UsersModel::updateEvent( UpdateEvent* e )
 {
-    if ( e->unit() == UpdateEvent::Users )
+    if ( e->contains( UpdateEvent::Users ) )
         refresh();
 }
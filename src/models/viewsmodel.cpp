@@ -42,6 +42,8 @@ ViewsModel::ViewsModel( int typeId, bool isPublic, QObject* parent ) : BaseModel
     setHeaderData( 2, Qt::Horizontal, tr( "Sort By" ) );
     setHeaderData( 3, Qt::Horizontal, tr( "Filter" ) );
 
+    dataManager->subscribe( this, UpdateEvent::Types );
+
     refresh();
 }
 
@@ -105,6 +107,6 @@ void ViewsModel::refresh()
 
 void ViewsModel::updateEvent( UpdateEvent* e )
 {
-    if ( e->unit() == UpdateEvent::Types )
+    if ( e->contains( UpdateEvent::Types ) )
         refresh();
 }
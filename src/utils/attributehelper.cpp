@@ -83,7 +83,7 @@ QString AttributeHelper::convertInitialValue( const DefinitionInfo& info, const
 
     if ( type == DateTimeAttribute && value.startsWith( QLatin1String( "[Today]" ) ) ) {
         QDateTime date;
-        if ( info.metadata( "local" ).toBool() )
+        if ( info.isLocal() )
             date = QDateTime::currentDateTime().toUTC();
         else
             date = QDateTime::currentDateTime();
@@ -230,7 +230,7 @@ QString AttributeHelper::dateTimeMetadataDetails( const DefinitionInfo& info ) c
     if ( time )
         details.append( tr( "With time" ) );
 
-    bool local = info.metadata( "local" ).toBool();
+    bool local = info.isLocal();
     if ( local )
         details.append( tr( "Local time zone" ) );
 
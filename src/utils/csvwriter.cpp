@@ -19,7 +19,13 @@
 
 #include "csvwriter.h"
 
-CsvWriter::CsvWriter()
+#include <QIODevice>
+
+CsvWriter::CsvWriter() :
+    m_fieldSeparator( ',' ),
+    m_rowSeparator( "\r\n" ),
+    m_device( NULL ),
+    m_empty( true )
 {
 }
 
@@ -27,23 +33,100 @@ CsvWriter::~CsvWriter()
 {
 }
 
+void CsvWriter::setSeparators( QChar fieldSeparator, const QString& rowSeparator )
+{
+    m_fieldSeparator = fieldSeparator;
+    m_rowSeparator = rowSeparator;
+}
+
+void CsvWriter::setDevice( QIODevice* device )
+{
+    m_device = device;
+    m_empty = true;
+
+    // the capacity is preserved when the buffer is truncated
+    m_buffer.reserve( BufferSize + 1024 );
+    m_buffer.resize( 0 );
+}
+
 void CsvWriter::appendRow( const QStringList& cells )
 {
-    QStringList formatted = cells;
+    if ( m_device ) {
+        writeRow( cells );
+        if ( m_buffer.size() >= BufferSize )
+            flush();
+    } else {
+        m_rows.append( formatRow( cells ) );
+    }
+}
+
+void CsvWriter::flush()
+{
+    if ( m_device && !m_buffer.isEmpty() ) {
+        m_device->write( m_buffer );
+        m_buffer.resize( 0 );
+    }
+}
+
+QString CsvWriter::toString() const
+{
+    return m_rows.join( m_rowSeparator );
+}
+
+bool CsvWriter::needsQuoting( const QString& field ) const
+{
+    int length = field.length();
+    if ( length == 0 )
+        return false;
+
+    const QChar* data = field.unicode();
+
+    if ( data[ 0 ] == QLatin1Char( ' ' ) || data[ length - 1 ] == QLatin1Char( ' ' ) )
+        return true;
+
+    // a file starting with ID is recognized by Excel as a SYLK file
+    if ( length == 2 && data[ 0 ] == QLatin1Char( 'I' ) && data[ 1 ] == QLatin1Char( 'D' ) )
+        return true;
+
+    for ( int i = 0; i < length; i++ ) {
+        QChar ch = data[ i ];
+        if ( ch == QLatin1Char( '"' ) || ch == m_fieldSeparator || ch == QLatin1Char( '\n' ) || ch == QLatin1Char( '\r' ) )
+            return true;
+    }
+
+    return false;
+}
+
+QString CsvWriter::formatRow( const QStringList& cells ) const
+{
+    QString row;
+
+    for ( int i = 0; i < cells.count(); i++ ) {
+        if ( i > 0 )
+            row += m_fieldSeparator;
 
-    for ( int i = 0; i < formatted.count(); i++ ) {
-        QString field = formatted.at( i );
-        if ( field.startsWith( ' ' ) || field.endsWith( ' ' ) || field.contains( '"' )
-             || field.contains( ',' ) || field.contains( '\n' ) || field == QLatin1String( "ID" ) ) {
-            field.replace( "\"", "\"\"" );
-            formatted.replace( i, '"' + field + '"' );
+        const QString& field = cells.at( i );
+        if ( needsQuoting( field ) ) {
+            row += QLatin1Char( '"' );
+            for ( int j = 0; j < field.length(); j++ ) {
+                if ( field.at( j ) == QLatin1Char( '"' ) )
+                    row += QLatin1Char( '"' );
+                row += field.at( j );
+            }
+            row += QLatin1Char( '"' );
+        } else {
+            row += field;
         }
     }
 
-    m_rows.append( formatted.join( "," ) );
+    return row;
 }
 
-QString CsvWriter::toString() const
+void CsvWriter::writeRow( const QStringList& cells )
 {
-    return m_rows.join( "\r\n" );
+    if ( !m_empty )
+        m_buffer += m_rowSeparator.toUtf8();
+    m_empty = false;
+
+    m_buffer += formatRow( cells ).toUtf8();
 }
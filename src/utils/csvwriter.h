@@ -21,6 +21,9 @@
 #define CSVWRITER_H
 
 #include <QStringList>
+#include <QByteArray>
+
+class QIODevice;
 
 /**
 * Class for writing data in CSV format.
@@ -39,18 +42,60 @@ public:
     ~CsvWriter();
 
 public:
+    /**
+    * Set the separators used by the writer.
+    * By default fields are separated with a comma and rows are separated
+    * with CR LF.
+    * @param fieldSeparator The character separating fields.
+    * @param rowSeparator The string separating rows.
+    */
+    void setSeparators( QChar fieldSeparator, const QString& rowSeparator );
+
+    /**
+    * Write rows directly to the given device instead of keeping them in memory.
+    * Rows are encoded using UTF-8 and buffered until flush() is called
+    * or the buffer is full.
+    */
+    void setDevice( QIODevice* device );
+
     /**
     * Append a single row.
     */
     void appendRow( const QStringList& cells );
 
+    /**
+    * Write the buffered rows to the device.
+    * This must be called after appending the last row.
+    */
+    void flush();
+
     /**
     * Return the content of the generated CSV file.
     */
     QString toString() const;
 
 private:
+    bool needsQuoting( const QString& field ) const;
+
+    QString formatRow( const QStringList& cells ) const;
+
+    void writeRow( const QStringList& cells );
+
+private:
+    /**
+    * The size of the buffer after which the output is written to the device.
+    */
+    static const int BufferSize = 65536;
+
+private:
+    QChar m_fieldSeparator;
+    QString m_rowSeparator;
+
     QStringList m_rows;
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    bool m_empty;
 };
 
 #endif
@@ -19,10 +19,67 @@
 
 #include "definitioninfo.h"
 
+#include "utils/profiler.h"
+
 #include <QStringList>
 #include <QCache>
+#include <QMutex>
+
+class DefinitionInfoData : public QSharedData
+{
+public:
+    DefinitionInfoData();
+    ~DefinitionInfoData();
+
+public:
+    void updateKey( const QString& key, const QVariant& value );
+
+public:
+    QString m_type;
+    QVariantMap m_metadata;
+
+    int m_column;
+    QString m_value;
+    bool m_local;
+};
+
+DefinitionInfoData::DefinitionInfoData() :
+    m_column( 0 ),
+    m_local( false )
+{
+}
+
+DefinitionInfoData::~DefinitionInfoData()
+{
+}
+
+void DefinitionInfoData::updateKey( const QString& key, const QVariant& value )
+{
+    if ( key == QLatin1String( "column" ) )
+        m_column = value.toInt();
+    else if ( key == QLatin1String( "value" ) )
+        m_value = value.toString();
+    else if ( key == QLatin1String( "local" ) )
+        m_local = value.toBool();
+}
+
+static DefinitionInfoData* createSharedEmptyData()
+{
+    DefinitionInfoData* data = new DefinitionInfoData();
+    // the extra reference ensures that the shared instance is never deleted
+    data->ref.ref();
+    return data;
+}
+
+static DefinitionInfoData* sharedEmptyData()
+{
+    // initialization of the static variable is safe when definitions are used by multiple threads
+    static DefinitionInfoData* data = createSharedEmptyData();
+    return data;
+}
 
-DefinitionInfo::DefinitionInfo()
+DefinitionInfo::DefinitionInfo() :
+    d( sharedEmptyData() )
 {
 }
 
@@ -30,17 +87,65 @@ DefinitionInfo::~DefinitionInfo()
 {
 }
 
+DefinitionInfo::DefinitionInfo( const DefinitionInfo& other ) :
+    d( other.d )
+{
+}
+
+DefinitionInfo& DefinitionInfo::operator =( const DefinitionInfo& other )
+{
+    d = other.d;
+    return *this;
+}
+
+bool DefinitionInfo::isEmpty() const
+{
+    return d->m_type.isEmpty();
+}
+
+void DefinitionInfo::setType( const QString& type )
+{
+    d->m_type = type;
+}
+
+const QString& DefinitionInfo::type() const
+{
+    return d->m_type;
+}
+
 void DefinitionInfo::setMetadata( const QString& key, const QVariant& value )
 {
     if ( value.isValid() )
-        m_metadata.insert( key, value );
+        d->m_metadata.insert( key, value );
     else
-        m_metadata.remove( key );
+        d->m_metadata.remove( key );
+
+    d->updateKey( key, value );
 }
 
 QVariant DefinitionInfo::metadata( const QString& key ) const
 {
-    return m_metadata.value( key );
+    return d->m_metadata.value( key );
+}
+
+const QVariantMap& DefinitionInfo::metadata() const
+{
+    return d->m_metadata;
+}
+
+int DefinitionInfo::column() const
+{
+    return d->m_column;
+}
+
+const QString& DefinitionInfo::value() const
+{
+    return d->m_value;
+}
+
+bool DefinitionInfo::isLocal() const
+{
+    return d->m_local;
 }
 
 QString DefinitionInfo::toString() const
@@ -48,9 +153,9 @@ QString DefinitionInfo::toString() const
     if ( isEmpty() )
         return QString();
 
-    QString result = m_type;
+    QString result = d->m_type;
 
-    for ( QMap<QString, QVariant>::const_iterator it = m_metadata.constBegin(); it != m_metadata.constEnd(); ++it ) {
+    for ( QMap<QString, QVariant>::const_iterator it = d->m_metadata.constBegin(); it != d->m_metadata.constEnd(); ++it ) {
         QString value;
         if ( it.value().type() == QVariant::StringList ) {
             QStringList list = it.value().toStringList();
@@ -93,73 +198,162 @@ QString DefinitionInfo::quoteString( const QString& string )
 
 DefinitionInfo DefinitionInfo::fromString( const QString& text )
 {
+    ProfilerScope scope( "DefinitionInfo::fromString" );
+
     if ( text.isEmpty() )
         return DefinitionInfo();
 
-    static QCache<QString, DefinitionInfo> definitionsCache;
+    static QCache<QString, DefinitionInfo> definitionsCache( 1000 );
+    static QMutex definitionsMutex;
 
-    DefinitionInfo* info = definitionsCache.object( text );
-    if ( info )
-        return *info;
+    // the cache is shared by all threads rendering reports
+    QMutexLocker locker( &definitionsMutex );
 
-    info = new DefinitionInfo();
-    definitionsCache.insert( text, info );
+    DefinitionInfo* cached = definitionsCache.object( text );
+    if ( cached )
+        return *cached;
 
-    QString patternNumber = "-?\\d+";
-    QString patternString = "\"(?:\\\\[\"\\\\nt]|[^\"\\\\])*\"";
-    QString patternArray = QString( "\\{(?:%1(?:,%2)*)?\\}" ).arg( patternString, patternString );
-    QString patternKey = "[a-z0-9]+(?:-[a-z0-9]+)*";
-    QString patternKeyAndValue = QString( "(%1)=(%2|%3|%4)" ).arg( patternKey, patternNumber, patternString, patternArray );
+    locker.unlock();
 
-    QRegExp definitionRegExp( QString( "([A-Z]+)(( %1)*)" ).arg( patternKeyAndValue ) );
+    DefinitionInfo info;
+    if ( !parse( text, info ) )
+        info = DefinitionInfo();
 
-    if ( !definitionRegExp.exactMatch( text ) )
-        return *info;
+    locker.relock();
 
-    info->setType( definitionRegExp.cap( 1 ) );
+    definitionsCache.insert( text, new DefinitionInfo( info ) );
 
-    QString attributes = definitionRegExp.cap( 2 );
+    return info;
+}
+
+static inline bool isUpperChar( const QChar* ptr )
+{
+    return ptr->unicode() >= 'A' && ptr->unicode() <= 'Z';
+}
+
+static inline bool isDigitChar( const QChar* ptr )
+{
+    return ptr->unicode() >= '0' && ptr->unicode() <= '9';
+}
 
-    QRegExp metadataRegExp( patternKeyAndValue );
-    QRegExp stringRegExp( patternString );
+static inline bool isKeyChar( const QChar* ptr )
+{
+    return ( ptr->unicode() >= 'a' && ptr->unicode() <= 'z' ) || isDigitChar( ptr );
+}
 
-    int i = 0;
-    while ( ( i = metadataRegExp.indexIn( attributes, i ) ) != -1 ) {
-        QString key = metadataRegExp.cap( 1 );
-        QString value = metadataRegExp.cap( 2 );
-        if ( value[ 0 ] == QLatin1Char( '\"' ) ) {
-            info->setMetadata( key, unquoteString( value ) );
-        } else if ( value[ 0 ] == QLatin1Char( '{' ) ) {
+bool DefinitionInfo::parse( const QString& text, DefinitionInfo& info )
+{
+    const QChar* ptr = text.constData();
+    const QChar* end = ptr + text.length();
+
+    const QChar* start = ptr;
+    while ( ptr != end && isUpperChar( ptr ) )
+        ptr++;
+
+    if ( ptr == start )
+        return false;
+
+    info.setType( QString( start, ptr - start ) );
+
+    while ( ptr != end ) {
+        if ( *ptr != QLatin1Char( ' ' ) )
+            return false;
+        ptr++;
+
+        // the key consists of alphanumeric parts separated with hyphens
+        const QChar* keyStart = ptr;
+        for ( ;; ) {
+            const QChar* partStart = ptr;
+            while ( ptr != end && isKeyChar( ptr ) )
+                ptr++;
+            if ( ptr == partStart )
+                return false;
+            if ( ptr == end || *ptr != QLatin1Char( '-' ) )
+                break;
+            ptr++;
+        }
+
+        QString key( keyStart, ptr - keyStart );
+
+        if ( ptr == end || *ptr != QLatin1Char( '=' ) )
+            return false;
+        ptr++;
+
+        if ( ptr == end )
+            return false;
+
+        if ( *ptr == QLatin1Char( '\"' ) ) {
+            QString value;
+            if ( !parseString( ptr, end, value ) )
+                return false;
+            info.setMetadata( key, value );
+        } else if ( *ptr == QLatin1Char( '{' ) ) {
+            ptr++;
             QStringList list;
-            int j = 0;
-            while ( ( j = stringRegExp.indexIn( value, j ) ) != -1 ) {
-                list.append( unquoteString( stringRegExp.cap( 0 ) ) );
-                j += stringRegExp.matchedLength();
+            if ( ptr != end && *ptr != QLatin1Char( '}' ) ) {
+                for ( ;; ) {
+                    QString item;
+                    if ( !parseString( ptr, end, item ) )
+                        return false;
+                    list.append( item );
+                    if ( ptr == end || *ptr != QLatin1Char( ',' ) )
+                        break;
+                    ptr++;
+                }
             }
-            info->setMetadata( key, list );
+            if ( ptr == end || *ptr != QLatin1Char( '}' ) )
+                return false;
+            ptr++;
+            info.setMetadata( key, list );
         } else {
-            info->setMetadata( key, value.toInt() );
+            const QChar* numberStart = ptr;
+            if ( *ptr == QLatin1Char( '-' ) )
+                ptr++;
+            const QChar* digitsStart = ptr;
+            while ( ptr != end && isDigitChar( ptr ) )
+                ptr++;
+            if ( ptr == digitsStart )
+                return false;
+            info.setMetadata( key, QString( numberStart, ptr - numberStart ).toInt() );
         }
-        i += metadataRegExp.matchedLength();
     }
 
-    return *info;
+    return true;
 }
 
-QString DefinitionInfo::unquoteString( const QString& string )
+bool DefinitionInfo::parseString( const QChar*& ptr, const QChar* end, QString& result )
 {
-    QString result = "";
-    int length = string.length();
-    for ( int i = 1; i < length - 1; i++ ) {
-        QChar ch = string[ i ];
-        if ( ch == QLatin1Char( '\\' ) ) {
-            ch = string[ ++i ];
-            if ( ch == QLatin1Char( 'n' ) )
-                ch = QLatin1Char( '\n' );
-            else if ( ch == QLatin1Char( 't' ) )
-                ch = QLatin1Char( '\t' );
+    if ( ptr == end || *ptr != QLatin1Char( '\"' ) )
+        return false;
+    ptr++;
+
+    // copy runs of unescaped characters at once
+    const QChar* runStart = ptr;
+
+    while ( ptr != end && *ptr != QLatin1Char( '\"' ) ) {
+        if ( *ptr == QLatin1Char( '\\' ) ) {
+            result.append( runStart, ptr - runStart );
+            ptr++;
+            if ( ptr == end )
+                return false;
+            if ( *ptr == QLatin1Char( 'n' ) )
+                result.append( QLatin1Char( '\n' ) );
+            else if ( *ptr == QLatin1Char( 't' ) )
+                result.append( QLatin1Char( '\t' ) );
+            else if ( *ptr == QLatin1Char( '\"' ) || *ptr == QLatin1Char( '\\' ) )
+                result.append( *ptr );
+            else
+                return false;
+            runStart = ptr + 1;
         }
-        result += ch;
+        ptr++;
     }
-    return result;
+
+    if ( ptr == end )
+        return false;
+
+    result.append( runStart, ptr - runStart );
+    ptr++;
+
+    return true;
 }
@@ -21,11 +21,15 @@
 #define DEFINITIONINFO_H
 
 #include <QVariant>
+#include <QSharedDataPointer>
+
+class DefinitionInfoData;
 
 /**
 * Structure storing a definition.
 *
-* The definition consists of a type keyword and metadata.
+* The definition consists of a type keyword and metadata. The data is
+* implicitly shared, so copying a definition is cheap.
 */
 class DefinitionInfo
 {
@@ -40,22 +44,25 @@ public:
     */
     ~DefinitionInfo();
 
+    DefinitionInfo( const DefinitionInfo& other );
+    DefinitionInfo& operator =( const DefinitionInfo& other );
+
 public:
     /**
     * Check if the definition is empty.
     * @return @c true if the definition is empty.
     */
-    bool isEmpty() const { return m_type.isEmpty(); }
+    bool isEmpty() const;
 
     /**
     * Set the type.
     */
-    void setType( const QString& type ) { m_type = type; }
+    void setType( const QString& type );
 
     /**
     * Return the type.
     */
-    const QString& type() const { return m_type; }
+    const QString& type() const;
 
     /**
     * Set the metadata of the attribute.
@@ -75,7 +82,22 @@ public:
     /**
     * Return all metadata of the attribute.
     */
-    const QVariantMap& metadata() const { return m_metadata; }
+    const QVariantMap& metadata() const;
+
+    /**
+    * Return the value of the "column" metadata as an integer.
+    */
+    int column() const;
+
+    /**
+    * Return the value of the "value" metadata as a string.
+    */
+    const QString& value() const;
+
+    /**
+    * Return the value of the "local" metadata as a boolean.
+    */
+    bool isLocal() const;
 
     /**
     * Build the attribute definition string according to the WebIssues protocol.
@@ -90,11 +112,12 @@ public:
 
 private:
     static QString quoteString( const QString& string );
-    static QString unquoteString( const QString& string );
+
+    static bool parse( const QString& text, DefinitionInfo& info );
+    static bool parseString( const QChar*& ptr, const QChar* end, QString& result );
 
 private:
-    QString m_type;
-    QVariantMap m_metadata;
+    QSharedDataPointer<DefinitionInfoData> d;
 };
 
 #endif
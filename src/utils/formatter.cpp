@@ -187,7 +187,7 @@ QString Formatter::convertAttributeValue( const DefinitionInfo& info, const QStr
 
         case DateTimeAttribute:
             if ( info.metadata( "time" ).toBool() )
-                return convertDateTime( value, info.metadata( "local" ).toBool() );
+                return convertDateTime( value, info.isLocal() );
             else
                 return convertDate( value );
             break;
@@ -19,9 +19,13 @@
 
 #include "htmltext.h"
 
-#include <QRegExp>
 #include <QTextDocument>
 
+static inline bool isOneOf( QChar ch, const char* chars )
+{
+    return ch.unicode() != 0 && ch.unicode() < 128 && qstrchr( chars, ch.toLatin1() ) != NULL;
+}
+
 HtmlText::HtmlText( Flags flags ) :
     m_flags( flags )
 {
@@ -54,30 +58,179 @@ void HtmlText::appendLink( const QString& text, const QString& url )
 
 void HtmlText::appendParsed( const QString& text )
 {
-    QRegExp linkExp( "\\b(?:mailto:)?[\\w.%+-]+@[\\w.-]+\\.[a-z]{2,}\\b"
-        "|(?:\\b(?:(?:https?|ftp|file):\\/\\/|www\\.|ftp\\.)|\\\\\\\\)(?:\\([\\w+&@#\\/\\\\%=~|$?!:,.-]*\\)|[\\w+&@#\\/\\\\%=~|$?!:,.-])*(?:\\([\\w+&@#\\/\\\\%=~|$?!:,.-]*\\)|[\\w+&@#\\/\\\\%=~|$])"
-        "|#\\d+\\b", Qt::CaseInsensitive );
+    appendParsed( m_html, text, m_flags );
+}
+
+void HtmlText::appendParsed( QString& html, const QString& text, Flags flags )
+{
+    const QChar* data = text.constData();
+    int length = text.length();
+
+    int last = 0;
+    int localEnd = 0;
+
+    for ( int pos = 0; pos < length; pos++ ) {
+        QChar ch = data[ pos ];
+
+        int end = -1;
+
+        if ( ch == QLatin1Char( '#' ) ) {
+            end = matchItemLink( data, length, pos );
+        } else if ( ch == QLatin1Char( '\\' ) ) {
+            if ( pos + 1 < length && data[ pos + 1 ] == QLatin1Char( '\\' ) )
+                end = matchUrlLink( data, length, pos + 2 );
+        } else if ( isWordChar( ch ) != ( pos > 0 && isWordChar( data[ pos - 1 ] ) ) ) {
+            // links other than UNC paths must start at a word boundary
+            int prefix = urlPrefixLength( data, length, pos );
+            if ( prefix > 0 )
+                end = matchUrlLink( data, length, pos + prefix );
+
+            // all addresses starting inside an already rejected local part are rejected as well
+            if ( pos >= localEnd || matchesAt( data, length, pos, "mailto:" ) )
+                end = qMax( end, matchEmailLink( data, length, pos, localEnd ) );
+        }
+
+        if ( end > pos ) {
+            if ( pos > last )
+                html += text.mid( last, pos - last ).toHtmlEscaped();
+
+            QString link = text.mid( pos, end - pos );
+            html += QString( "<a href=\"%1\">%2</a>" ).arg( convertUrl( link, flags ).toHtmlEscaped(), link.toHtmlEscaped() );
+
+            last = end;
+            pos = end - 1;
+        }
+    }
+
+    if ( last < length )
+        html += ( last > 0 ? text.mid( last ) : text ).toHtmlEscaped();
+}
+
+int HtmlText::matchItemLink( const QChar* data, int length, int pos )
+{
+    int end = pos + 1;
+    while ( end < length && data[ end ].isDigit() )
+        end++;
 
-    int pos = 0;
-    for ( ; ; ) {
-        int oldpos = pos;
-        pos = linkExp.indexIn( text, pos );
+    if ( end == pos + 1 || ( end < length && isWordChar( data[ end ] ) ) )
+        return -1;
+
+    return end;
+}
+
+int HtmlText::matchUrlLink( const QChar* data, int length, int pos )
+{
+    // the last character cannot be a punctuation character, unless it closes a parenthesis
+    int end = -1;
 
-        if ( pos < 0 ) {
-            appendText( text.mid( oldpos ) );
+    int i = pos;
+    while ( i < length ) {
+        QChar ch = data[ i ];
+        if ( ch == QLatin1Char( '(' ) ) {
+            int j = i + 1;
+            while ( j < length && isUrlChar( data[ j ] ) )
+                j++;
+            if ( j >= length || data[ j ] != QLatin1Char( ')' ) )
+                break;
+            i = j + 1;
+            end = i;
+        } else if ( isUrlChar( ch ) ) {
+            i++;
+            if ( isUrlEndChar( ch ) )
+                end = i;
+        } else {
             break;
         }
+    }
+
+    return end;
+}
 
-        if ( pos > oldpos )
-            appendText( text.mid( oldpos, pos - oldpos ) );
+int HtmlText::matchEmailLink( const QChar* data, int length, int pos, int& localEnd )
+{
+    int i = pos;
+    if ( matchesAt( data, length, i, "mailto:" ) )
+        i += 7;
+
+    int local = i;
+    while ( i < length && isEmailChar( data[ i ] ) )
+        i++;
 
-        QString link = linkExp.cap( 0 );
-        QString url = convertUrl( link, m_flags );
+    localEnd = i;
 
-        appendLink( link, url );
+    if ( i == local || i >= length || data[ i ] != QLatin1Char( '@' ) )
+        return -1;
 
-        pos += linkExp.matchedLength();
+    int domain = i + 1;
+    int domainEnd = domain;
+    while ( domainEnd < length && isDomainChar( data[ domainEnd ] ) )
+        domainEnd++;
+
+    // find the longest domain ending with a dot and at least two letters at a word boundary
+    for ( int end = domainEnd; end >= domain + 4; end-- ) {
+        if ( end < length && isWordChar( data[ end ] ) )
+            continue;
+        int letters = 0;
+        while ( letters < end - domain && isAsciiLetter( data[ end - letters - 1 ] ) )
+            letters++;
+        int dot = end - letters - 1;
+        if ( letters >= 2 && dot > domain && data[ dot ] == QLatin1Char( '.' ) )
+            return end;
     }
+
+    return -1;
+}
+
+int HtmlText::urlPrefixLength( const QChar* data, int length, int pos )
+{
+    static const char* const prefixes[] = { "http://", "https://", "ftp://", "file://", "www.", "ftp." };
+
+    for ( int i = 0; i < (int)( sizeof( prefixes ) / sizeof( prefixes[ 0 ] ) ); i++ ) {
+        if ( matchesAt( data, length, pos, prefixes[ i ] ) )
+            return qstrlen( prefixes[ i ] );
+    }
+
+    return 0;
+}
+
+bool HtmlText::matchesAt( const QChar* data, int length, int pos, const char* text )
+{
+    for ( int i = 0; text[ i ] != '\0'; i++ ) {
+        if ( pos + i >= length || data[ pos + i ].toLower() != QLatin1Char( text[ i ] ) )
+            return false;
+    }
+    return true;
+}
+
+bool HtmlText::isWordChar( QChar ch )
+{
+    return ch.isLetterOrNumber() || ch.isMark() || ch == QLatin1Char( '_' );
+}
+
+bool HtmlText::isEmailChar( QChar ch )
+{
+    return isWordChar( ch ) || isOneOf( ch, ".%+-" );
+}
+
+bool HtmlText::isDomainChar( QChar ch )
+{
+    return isWordChar( ch ) || isOneOf( ch, ".-" );
+}
+
+bool HtmlText::isUrlChar( QChar ch )
+{
+    return isWordChar( ch ) || isOneOf( ch, "+&@#/\\%=~|$?!:,.-" );
+}
+
+bool HtmlText::isUrlEndChar( QChar ch )
+{
+    return isWordChar( ch ) || isOneOf( ch, "+&@#/\\%=~|$" );
+}
+
+bool HtmlText::isAsciiLetter( QChar ch )
+{
+    ushort code = ch.toLower().unicode();
+    return code >= 'a' && code <= 'z';
 }
 
 HtmlText HtmlText::parse( const QString& text, Flags flags )
@@ -87,6 +240,13 @@ HtmlText HtmlText::parse( const QString& text, Flags flags )
     return result;
 }
 
+HtmlText HtmlText::fromHtml( const QString& html, Flags flags )
+{
+    HtmlText result( flags );
+    result.m_html = html;
+    return result;
+}
+
 void HtmlText::appendImage( const QString& image, const QString& text )
 {
     m_html += QString( "<img src=\"qrc:/icons/%1-16.png\" alt=\"%2\" title=\"%2\" width=\"16\" height=\"16\" class=\"icon\">" ).arg( image, text.toHtmlEscaped() );
@@ -136,12 +136,35 @@ public:
     */
     static HtmlText parse( const QString& text, Flags flags = 0 );
 
+    /**
+    * Create text from HTML which was already converted.
+    * @param html The converted HTML.
+    * @param flags Flags affecting extracting of links.
+    */
+    static HtmlText fromHtml( const QString& html, Flags flags = 0 );
+
     /**
     * Convert tabs to spaces.
     */
     static QString convertTabsToSpaces( const QString& text );
 
 private:
+    static void appendParsed( QString& html, const QString& text, Flags flags );
+
+    static int matchItemLink( const QChar* data, int length, int pos );
+    static int matchUrlLink( const QChar* data, int length, int pos );
+    static int matchEmailLink( const QChar* data, int length, int pos, int& localEnd );
+
+    static int urlPrefixLength( const QChar* data, int length, int pos );
+    static bool matchesAt( const QChar* data, int length, int pos, const char* text );
+
+    static bool isWordChar( QChar ch );
+    static bool isEmailChar( QChar ch );
+    static bool isDomainChar( QChar ch );
+    static bool isUrlChar( QChar ch );
+    static bool isUrlEndChar( QChar ch );
+    static bool isAsciiLetter( QChar ch );
+
     static QString convertUrl( const QString& url, Flags flags );
 
     static QString convertTabsToSpaces( const QString& text, int& column );
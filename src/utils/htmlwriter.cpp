@@ -27,7 +27,10 @@
 #include <QTextStream>
 
 HtmlWriter::HtmlWriter() :
-    m_embedded( false )
+    m_embedded( false ),
+    m_chunksLength( 0 ),
+    m_device( NULL ),
+    m_headerWritten( false )
 {
 }
 
@@ -45,10 +48,21 @@ void HtmlWriter::setEmbedded( bool on )
     m_embedded = on;
 }
 
-void HtmlWriter::createLayout()
+void HtmlWriter::createLayout( const QString& sectionId )
 {
     pushTag( "div", "class=\"sub-pane-wrapper\"" );
     pushTag( "table", "class=\"sub-pane-layout\"" );
+    if ( !sectionId.isEmpty() )
+        pushTag( "tbody", QString(), sectionId );
+    pushTag( "tr" );
+}
+
+void HtmlWriter::appendLayoutSection( const QString& sectionId )
+{
+    popTag( "td" );
+    popTag( "tr" );
+    popTag( "tbody" );
+    pushTag( "tbody", QString(), sectionId );
     pushTag( "tr" );
 }
 
@@ -66,7 +80,7 @@ void HtmlWriter::beginCell( Pane pane, int mergeColumns )
     QStringList attributes;
 
     if ( mergeColumns > 1 )
-        attributes.append( QString( "colspan=\"%1\"" ).arg( mergeColumns ) );
+        attributes.append( QLatin1String( "colspan=\"" ) + QString::number( mergeColumns ) + QLatin1Char( '"' ) );
 
     switch ( pane ) {
         case TopPane:
@@ -84,13 +98,24 @@ void HtmlWriter::endLayout()
 {
     popTag( "td" );
     popTag( "tr" );
+    popTag( "tbody" );
     popTag( "table" );
     popTag( "div" );
 }
 
-void HtmlWriter::beginHistoryItem()
+void HtmlWriter::beginSection( const QString& sectionId )
 {
-    pushTag( "div", "class=\"history-item\"" );
+    pushTag( "div", QString(), sectionId );
+}
+
+void HtmlWriter::endSection()
+{
+    popTag( "div" );
+}
+
+void HtmlWriter::beginHistoryItem( const QString& sectionId )
+{
+    pushTag( "div", "class=\"history-item\"", sectionId );
 }
 
 void HtmlWriter::endHistoryItem()
@@ -237,6 +262,13 @@ void HtmlWriter::endTable()
     popTag( "table" );
 }
 
+void HtmlWriter::appendHtml( const QString& html )
+{
+    m_body += html;
+
+    appendChunk();
+}
+
 static QString readFile( const QString& path )
 {
     QFile file( path );
@@ -250,6 +282,43 @@ QString HtmlWriter::toHtml()
 {
     popAll();
 
+    QString header = documentHeader();
+    QString footer = documentFooter();
+
+    QString html;
+    html.reserve( header.length() + bodyLength() + footer.length() );
+
+    html += header;
+    foreach ( const QString& chunk, m_chunks )
+        html += chunk;
+    html += m_body;
+    html += footer;
+
+    return html;
+}
+
+QByteArray HtmlWriter::toUtf8()
+{
+    popAll();
+
+    QByteArray header = documentHeader().toUtf8();
+    QByteArray footer = documentFooter().toUtf8();
+
+    // most of the generated text is ASCII so the length of the body is a good estimate
+    QByteArray html;
+    html.reserve( header.length() + bodyLength() + footer.length() );
+
+    html += header;
+    foreach ( const QString& chunk, m_chunks )
+        html += chunk.toUtf8();
+    html += m_body.toUtf8();
+    html += footer;
+
+    return html;
+}
+
+QString HtmlWriter::documentHeader() const
+{
     QString html;
     html += QLatin1String( "<!DOCTYPE html>\n" );
     html += QLatin1String( "<html>\n" );
@@ -267,43 +336,151 @@ QString HtmlWriter::toHtml()
     }
     html += QLatin1String( "</head>\n" );
     html += QLatin1String( "<body>\n" );
-    html += m_body;
+
+    return html;
+}
+
+QString HtmlWriter::documentFooter() const
+{
+    QString html;
     html += QLatin1String( "</body>\n" );
     html += QLatin1String( "</html>\n" );
 
     return html;
 }
 
-void HtmlWriter::pushTag( const QString& tag, const QString& attributes )
+QString HtmlWriter::bodyHtml()
+{
+    popAll();
+
+    return bodyFrom( 0 );
+}
+
+void HtmlWriter::setDevice( QIODevice* device )
+{
+    m_device = device;
+    m_headerWritten = false;
+}
+
+void HtmlWriter::flush()
+{
+    if ( !m_device )
+        return;
+
+    // the contents of open sections are extracted from the body when they are closed
+    foreach ( const QString& sectionId, m_sectionIds ) {
+        if ( !sectionId.isEmpty() )
+            return;
+    }
+
+    if ( !m_headerWritten ) {
+        m_device->write( documentHeader().toUtf8() );
+        m_headerWritten = true;
+    }
+
+    foreach ( const QString& chunk, m_chunks )
+        m_device->write( chunk.toUtf8() );
+    m_device->write( m_body.toUtf8() );
+
+    m_chunks.clear();
+    m_chunksLength = 0;
+    m_body.resize( 0 );
+
+    m_sectionOffsets.fill( 0 );
+}
+
+void HtmlWriter::endDocument()
+{
+    popAll();
+    flush();
+
+    if ( m_device )
+        m_device->write( documentFooter().toUtf8() );
+}
+
+void HtmlWriter::pushTag( const QString& tag, const QString& attributes, const QString& sectionId )
 {
     m_tags.push( tag );
     m_body += QLatin1Char( '<' );
     m_body += tag;
+    if ( !sectionId.isEmpty() ) {
+        m_body += QLatin1String( " id=\"" );
+        m_body += sectionId;
+        m_body += QLatin1Char( '"' );
+    }
     if ( !attributes.isEmpty() ) {
         m_body += QLatin1Char( ' ' );
         m_body += attributes;
     }
     m_body += QLatin1Char( '>' );
+
+    m_sectionIds.push( sectionId );
+    m_sectionOffsets.push( bodyLength() );
 }
 
 void HtmlWriter::popTag( const QString& tag )
 {
-    if ( !m_tags.isEmpty() && m_tags.top() == tag ) {
-        m_body += QLatin1Char( '<' );
-        m_body += QLatin1Char( '/' );
-        m_body += m_tags.pop();
-        m_body += QLatin1Char( '>' );
-        m_body += QLatin1Char( '\n' );
-    }
+    if ( !m_tags.isEmpty() && m_tags.top() == tag )
+        closeTag();
 }
 
 void HtmlWriter::popAll()
 {
-    while ( !m_tags.isEmpty() ) {
-        m_body += QLatin1Char( '<' );
-        m_body += QLatin1Char( '/' );
-        m_body += m_tags.pop();
-        m_body += QLatin1Char( '>' );
-        m_body += QLatin1Char( '\n' );
+    while ( !m_tags.isEmpty() )
+        closeTag();
+}
+
+void HtmlWriter::closeTag()
+{
+    QString sectionId = m_sectionIds.pop();
+    int offset = m_sectionOffsets.pop();
+
+    // remember the contents of elements which can be updated separately
+    if ( !sectionId.isEmpty() )
+        m_sections.insert( sectionId, bodyFrom( offset ) );
+
+    m_body += QLatin1Char( '<' );
+    m_body += QLatin1Char( '/' );
+    m_body += m_tags.pop();
+    m_body += QLatin1Char( '>' );
+    m_body += QLatin1Char( '\n' );
+
+    appendChunk();
+}
+
+void HtmlWriter::appendChunk()
+{
+    if ( m_body.length() < ChunkSize )
+        return;
+
+    // completed chunks are never modified, so the body does not have to be reallocated and copied as it grows
+    m_chunks.append( m_body );
+    m_chunksLength += m_body.length();
+
+    m_body = QString();
+    m_body.reserve( ChunkSize + ChunkSize / 4 );
+}
+
+QString HtmlWriter::bodyFrom( int offset ) const
+{
+    if ( offset >= m_chunksLength )
+        return m_body.mid( offset - m_chunksLength );
+
+    // find the chunk containing the offset starting from the most recent chunk
+    int index = m_chunks.count() - 1;
+    int start = m_chunksLength - m_chunks.at( index ).length();
+    while ( start > offset ) {
+        index--;
+        start -= m_chunks.at( index ).length();
     }
+
+    QString html;
+    html.reserve( bodyLength() - offset );
+
+    html += m_chunks.at( index ).midRef( offset - start );
+    for ( int i = index + 1; i < m_chunks.count(); i++ )
+        html += m_chunks.at( i );
+    html += m_body;
+
+    return html;
 }
@@ -21,10 +21,14 @@
 #define HTMLWRITER_H
 
 #include <QString>
+#include <QStringList>
 #include <QStack>
+#include <QHash>
 
 class HtmlText;
 
+class QIODevice;
+
 /**
 * Class for writing documents in HTML format.
 */
@@ -67,12 +71,16 @@ public:
     void setEmbedded( bool on );
     bool isEmbedded() const { return m_embedded; }
 
-    void createLayout();
+    void createLayout( const QString& sectionId = QString() );
+    void appendLayoutSection( const QString& sectionId = QString() );
     void appendLayoutRow();
     void beginCell( Pane pane, int mergeColumns = 1 );
     void endLayout();
 
-    void beginHistoryItem();
+    void beginSection( const QString& sectionId );
+    void endSection();
+
+    void beginHistoryItem( const QString& sectionId = QString() );
     void endHistoryItem();
 
     void writeBlock( const HtmlText& text, BlockStyle style );
@@ -86,25 +94,88 @@ public:
     void appendTableRow( const QList<HtmlText>& cells );
     void endTable();
 
+    /**
+    * Append HTML which was previously returned by bodyHtml().
+    */
+    void appendHtml( const QString& html );
+
     /**
     * Return the resulting HTML.
     */
     QString toHtml();
 
+    /**
+    * Return the resulting HTML encoded using UTF-8.
+    * This avoids creating a copy of the whole document as a string.
+    */
+    QByteArray toUtf8();
+
+    /**
+    * Return the HTML of the body without the document header.
+    */
+    QString bodyHtml();
+
+    /**
+    * Write the document to the given device instead of keeping it in memory.
+    * The title and style must be set before the first call to flush().
+    */
+    void setDevice( QIODevice* device );
+
+    /**
+    * Write the HTML generated so far to the device.
+    * HTML is kept in memory while a section is open.
+    */
+    void flush();
+
+    /**
+    * Close all elements and write the rest of the document to the device.
+    */
+    void endDocument();
+
+    /**
+    * Return the HTML contained in the element with given identifier.
+    */
+    QString sectionHtml( const QString& sectionId ) const { return m_sections.value( sectionId ); }
+
 private:
-    void pushTag( const QString& tag, const QString& attributes = QString() );
+    void pushTag( const QString& tag, const QString& attributes = QString(), const QString& sectionId = QString() );
     void popTag( const QString& tag );
     void popAll();
+    void closeTag();
 
     void getTagAndAttributes( HtmlWriter::BlockStyle style, QString& tag, QString& attributes );
 
+    QString documentHeader() const;
+    QString documentFooter() const;
+
+    void appendChunk();
+
+    int bodyLength() const { return m_chunksLength + m_body.length(); }
+    QString bodyFrom( int offset ) const;
+
+private:
+    /**
+    * The length of a chunk of the body after which a new chunk is started.
+    */
+    static const int ChunkSize = 32768;
+
 private:
     QString m_title;
     bool m_embedded;
 
+    QStringList m_chunks;
+    int m_chunksLength;
+
     QString m_body;
 
+    QIODevice* m_device;
+    bool m_headerWritten;
+
     QStack<QString> m_tags;
+
+    QStack<QString> m_sectionIds;
+    QStack<int> m_sectionOffsets;
+    QHash<QString, QString> m_sections;
 };
 
 #endif
@@ -19,11 +19,15 @@
 
 #include "markupprocessor.h"
 
+#include "utils/profiler.h"
+
 #include <QStringList>
 #include <QTextDocument>
 
 HtmlText MarkupProcessor::parse( const QString& text, HtmlText::Flags flags )
 {
+    ProfilerScope scope( "MarkupProcessor::parse" );
+
     MarkupProcessor processor( text, flags );
 
     processor.next();
@@ -39,43 +43,37 @@ MarkupProcessor::MarkupProcessor( const QString& text, HtmlText::Flags flags ) :
     m_flags( flags ),
     m_index( 0 ),
     m_matched( false ),
+    m_matchToken( 0 ),
+    m_matchEnd( 0 ),
+    m_headEnd( 0 ),
+    m_closeIndex( 0 ),
     m_token( 0 )
 {
-    m_regExp.setPattern( "\\n|`[^`\\n]+`"
-        "|\\[\\/?(?:list|code|quote|rtl)(?:[ \\t][^]\\n]*)?\\](?:[ \\t]*\\n)?"
-        "|\\[(?:(?:mailto:)?[\\w.%+-]+@[\\w.-]+\\.[a-z]{2,}|(?:(?:https?|ftp|file):\\/\\/|www\\.|ftp\\.|\\\\\\\\)[\\w+&@#\\/\\\\%=~|$?!:,.()-]+|#\\d+)(?:[ \\t][^]\\n]*)?\\]");
-    m_regExp.setCaseSensitivity( Qt::CaseInsensitive );
 }
 
 MarkupProcessor::~MarkupProcessor()
 {
 }
 
-static int strcspn( const QString& text )
-{
-    int i = 0, len = text.length();
-    while ( i < len ) {
-        QChar ch = text.at( i );
-        if ( ch == QLatin1Char( ' ' ) || ch == QLatin1Char( '\t' ) || ch == QLatin1Char( ']' ) )
-            break;
-        i++;
-    }
-    return i;
-}
-
 void MarkupProcessor::next()
 {
-    if ( m_index >= m_text.length() ) {
+    int length = m_text.length();
+
+    if ( m_index >= length ) {
         m_token = T_END;
         return;
     }
 
     if ( !m_matched ) {
         int lastIndex = m_index;
-        m_index = m_regExp.indexIn( m_text, m_index );
 
-        if ( m_index < 0 ) {
-            m_index = m_text.length();
+        for ( ; m_index < length; m_index++ ) {
+            m_matchEnd = matchToken( m_index );
+            if ( m_matchEnd > 0 )
+                break;
+        }
+
+        if ( m_index >= length ) {
             m_token = T_TEXT;
             m_value = m_rawValue = m_text.mid( lastIndex );
             return;
@@ -89,41 +87,167 @@ void MarkupProcessor::next()
         }
     }
 
-    m_index += m_regExp.matchedLength();
+    m_token = m_matchToken;
+    m_rawValue = m_text.mid( m_index, m_matchEnd - m_index );
+
+    if ( m_token == T_BACKTICK ) {
+        m_value = m_text.mid( m_index + 1, m_matchEnd - m_index - 2 );
+    } else if ( m_token != T_NEWLINE ) {
+        m_value = m_text.mid( m_index + 1, m_headEnd - m_index - 1 );
+        m_extra = m_text.mid( m_headEnd, m_closeIndex - m_headEnd ).trimmed();
+    }
+
+    m_index = m_matchEnd;
     m_matched = false;
+}
+
+int MarkupProcessor::matchToken( int index )
+{
+    const QChar* data = m_text.constData();
+    int length = m_text.length();
+
+    QChar ch = data[ index ];
+
+    if ( ch == QLatin1Char( '\n' ) ) {
+        m_matchToken = T_NEWLINE;
+        return index + 1;
+    }
+
+    if ( ch == QLatin1Char( '`' ) ) {
+        int end = index + 1;
+        while ( end < length && data[ end ] != QLatin1Char( '`' ) && data[ end ] != QLatin1Char( '\n' ) )
+            end++;
+        if ( end == index + 1 || end >= length || data[ end ] != QLatin1Char( '`' ) )
+            return -1;
+        m_matchToken = T_BACKTICK;
+        return end + 1;
+    }
+
+    if ( ch == QLatin1Char( '[' ) )
+        return matchBracket( index );
+
+    return -1;
+}
+
+int MarkupProcessor::matchBracket( int index )
+{
+    const QChar* data = m_text.constData();
+    int length = m_text.length();
+
+    // the tag or link ends with the first bracket and cannot span multiple lines
+    int close = index + 1;
+    while ( close < length && data[ close ] != QLatin1Char( ']' ) && data[ close ] != QLatin1Char( '\n' ) )
+        close++;
+    if ( close >= length || data[ close ] != QLatin1Char( ']' ) )
+        return -1;
+
+    // the name of the tag or the link is followed by optional extra text
+    int head = index + 1;
+    while ( head < close && data[ head ] != QLatin1Char( ' ' ) && data[ head ] != QLatin1Char( '\t' ) )
+        head++;
+
+    int from = index + 1;
+    bool closing = from < head && data[ from ] == QLatin1Char( '/' );
+    int name = closing ? from + 1 : from;
+
+    if ( isTag( name, head, "code" ) )
+        m_matchToken = closing ? T_END_CODE : T_START_CODE;
+    else if ( isTag( name, head, "list" ) )
+        m_matchToken = closing ? T_END_LIST : T_START_LIST;
+    else if ( isTag( name, head, "quote" ) )
+        m_matchToken = closing ? T_END_QUOTE : T_START_QUOTE;
+    else if ( isTag( name, head, "rtl" ) )
+        m_matchToken = closing ? T_END_RTL : T_START_RTL;
+    else if ( isLink( from, head ) )
+        m_matchToken = T_LINK;
+    else
+        return -1;
+
+    m_headEnd = head;
+    m_closeIndex = close;
+
+    int end = close + 1;
+
+    // a tag swallows trailing whitespace up to the end of line
+    if ( m_matchToken != T_LINK ) {
+        int i = end;
+        while ( i < length && ( data[ i ] == QLatin1Char( ' ' ) || data[ i ] == QLatin1Char( '\t' ) ) )
+            i++;
+        if ( i < length && data[ i ] == QLatin1Char( '\n' ) )
+            end = i + 1;
+    }
+
+    return end;
+}
+
+bool MarkupProcessor::isTag( int from, int to, const char* tag ) const
+{
+    return to - from == (int)qstrlen( tag ) && HtmlText::matchesAt( m_text.constData(), to, from, tag );
+}
+
+bool MarkupProcessor::isLink( int from, int to ) const
+{
+    const QChar* data = m_text.constData();
+
+    if ( from >= to )
+        return false;
+
+    if ( data[ from ] == QLatin1Char( '#' ) ) {
+        if ( to - from < 2 )
+            return false;
+        for ( int i = from + 1; i < to; i++ ) {
+            if ( !data[ i ].isDigit() )
+                return false;
+        }
+        return true;
+    }
+
+    int prefix = HtmlText::urlPrefixLength( data, to, from );
+    if ( prefix == 0 && HtmlText::matchesAt( data, to, from, "\\\\" ) )
+        prefix = 2;
+
+    if ( prefix > 0 && from + prefix < to ) {
+        int i = from + prefix;
+        while ( i < to && ( HtmlText::isUrlChar( data[ i ] ) || data[ i ] == QLatin1Char( '(' ) || data[ i ] == QLatin1Char( ')' ) ) )
+            i++;
+        if ( i == to )
+            return true;
+    }
+
+    int i = from;
+    if ( HtmlText::matchesAt( data, to, i, "mailto:" ) )
+        i += 7;
+
+    int local = i;
+    while ( i < to && HtmlText::isEmailChar( data[ i ] ) )
+        i++;
+
+    if ( i == local || i >= to || data[ i ] != QLatin1Char( '@' ) )
+        return false;
+
+    int domain = i + 1;
+    int dot = -1;
+    for ( i = domain; i < to; i++ ) {
+        if ( !HtmlText::isDomainChar( data[ i ] ) )
+            return false;
+        if ( data[ i ] == QLatin1Char( '.' ) )
+            dot = i;
+    }
+
+    if ( dot <= domain || to - dot - 1 < 2 )
+        return false;
 
-    m_rawValue = m_regExp.cap( 0 );
-
-    if ( m_rawValue.at( 0 ) == QLatin1Char( '[' ) ) {
-        int index = strcspn( m_rawValue );
-        m_value = m_rawValue.mid( 1, index - 1 );
-        m_extra = m_rawValue.mid( index, m_rawValue.lastIndexOf( ']' ) - index ).trimmed();
-
-        QString tag = m_value.toLower();
-        if ( tag == QLatin1String( "code" ) )
-            m_token = T_START_CODE;
-        else if ( tag == QLatin1String( "list" ) )
-            m_token = T_START_LIST;
-        else if ( tag == QLatin1String( "quote" ) )
-            m_token = T_START_QUOTE;
-        else if ( tag == QLatin1String( "rtl" ) )
-            m_token = T_START_RTL;
-        else if ( tag == QLatin1String( "/code" ) )
-            m_token = T_END_CODE;
-        else if ( tag == QLatin1String( "/list" ) )
-            m_token = T_END_LIST;
-        else if ( tag == QLatin1String( "/quote" ) )
-            m_token = T_END_QUOTE;
-        else if ( tag == QLatin1String( "/rtl" ) )
-            m_token = T_END_RTL;
-        else
-            m_token = T_LINK;
-    } else if ( m_rawValue.at( 0 ) == QLatin1Char( '`' ) ) {
-        m_token = T_BACKTICK;
-        m_value = m_rawValue.mid( 1, m_rawValue.length() - 2 );
-    } else {
-        m_token = T_NEWLINE;
+    for ( i = dot + 1; i < to; i++ ) {
+        if ( !HtmlText::isAsciiLetter( data[ i ] ) )
+            return false;
     }
+
+    return true;
+}
+
+void MarkupProcessor::appendText( const QString& text, int& column )
+{
+    HtmlText::appendParsed( m_result, HtmlText::convertTabsToSpaces( text, column ), m_flags );
 }
 
 void MarkupProcessor::parse()
@@ -218,29 +342,27 @@ void MarkupProcessor::parseText()
     for ( ; ; ) {
         switch ( m_token ) {
             case T_TEXT: {
-                QRegExp subtokenExp( "\\*\\*+|__+" );
+                const QChar* data = m_value.constData();
+                int length = m_value.length();
+                int last = 0;
                 int pos = 0;
-                for ( ; ; ) {
-                    int oldpos = pos;
-                    pos = subtokenExp.indexIn( m_value, pos );
-
-                    if ( pos < 0 ) {
-                        text = HtmlText::convertTabsToSpaces( m_value.mid( oldpos ), column );
-                        m_result += HtmlText::parse( text, m_flags ).toString();
-                        break;
-                    }
-
-                    if ( pos > oldpos ) {
-                        text = HtmlText::convertTabsToSpaces( m_value.mid( oldpos, pos - oldpos ), column );
-                        m_result += HtmlText::parse( text, m_flags ).toString();
+                while ( pos < length ) {
+                    QChar ch = data[ pos ];
+                    if ( ( ch != QLatin1Char( '*' ) && ch != QLatin1Char( '_' ) ) || pos + 1 >= length || data[ pos + 1 ] != ch ) {
+                        pos++;
+                        continue;
                     }
 
-                    pos += subtokenExp.matchedLength();
+                    if ( pos > last )
+                        appendText( m_value.mid( last, pos - last ), column );
 
-                    QString subtoken = subtokenExp.cap( 0 );
+                    last = pos;
+                    pos += 2;
+                    while ( pos < length && data[ pos ] == ch )
+                        pos++;
 
-                    if ( subtoken == QLatin1String( "**" ) || subtoken == QLatin1String( "__" ) ) {
-                        QString tag = subtoken.at( 0 ) == QLatin1Char( '*' ) ? "strong" : "em";
+                    if ( pos - last == 2 ) {
+                        QString tag = ch == QLatin1Char( '*' ) ? "strong" : "em";
                         int key = tags.indexOf( tag );
                         if ( key < 0 ) {
                             tags.append( tag );
@@ -252,12 +374,16 @@ void MarkupProcessor::parseText()
                             for ( int i = key; i < tags.count(); i++ )
                                 m_result += QString( "<%1>" ).arg( tags.at( i ) );
                         }
-                        continue;
+                    } else {
+                        // longer sequences of asterisks or underscores are not markup
+                        m_result += m_value.midRef( last, pos - last );
+                        column += pos - last;
                     }
 
-                    text = HtmlText::convertTabsToSpaces( subtoken, column );
-                    m_result += text.toHtmlEscaped();
+                    last = pos;
                 }
+                if ( last < length )
+                    appendText( last > 0 ? m_value.mid( last ) : m_value, column );
                 next();
                 break;
             }
@@ -333,12 +459,24 @@ void MarkupProcessor::parseList()
 int MarkupProcessor::itemLevel()
 {
     if ( m_token == T_TEXT ) {
-        QRegExp listExp( "[ \\t]*(\\*{1,6})[ \\t](.*)" );
-        if ( listExp.exactMatch( m_value ) ) {
-            m_value = listExp.cap( 2 );
+        const QChar* data = m_value.constData();
+        int length = m_value.length();
+
+        int pos = 0;
+        while ( pos < length && ( data[ pos ] == QLatin1Char( ' ' ) || data[ pos ] == QLatin1Char( '\t' ) ) )
+            pos++;
+
+        int level = 0;
+        while ( pos < length && data[ pos ] == QLatin1Char( '*' ) ) {
+            level++;
+            pos++;
+        }
+
+        if ( level >= 1 && level <= 6 && pos < length && ( data[ pos ] == QLatin1Char( ' ' ) || data[ pos ] == QLatin1Char( '\t' ) ) ) {
+            m_value = m_value.mid( pos + 1 );
             if ( m_value.isEmpty() )
                 next();
-            return listExp.cap( 1 ).length();
+            return level;
         }
     }
     return 0;
@@ -22,8 +22,6 @@
 
 #include "utils/htmltext.h"
 
-#include <QRegExp>
-
 /**
 * Convert text with markup to HTML formatting.
 */
@@ -57,6 +55,14 @@ private:
 private:
     void next();
 
+    int matchToken( int index );
+    int matchBracket( int index );
+
+    bool isTag( int from, int to, const char* tag ) const;
+    bool isLink( int from, int to ) const;
+
+    void appendText( const QString& text, int& column );
+
     void parse();
     void parseBlock();
     void parseText();
@@ -71,11 +77,14 @@ private:
     QString m_text;
     HtmlText::Flags m_flags;
 
-    QRegExp m_regExp;
-
     int m_index;
     bool m_matched;
-    
+
+    int m_matchToken;
+    int m_matchEnd;
+    int m_headEnd;
+    int m_closeIndex;
+
     int m_token;
     QString m_value;
     QString m_extra;
@@ -0,0 +1,259 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+#include "profiler.h"
+
+#include <QMutex>
+#include <QVector>
+#include <QHash>
+#include <QThread>
+#include <QElapsedTimer>
+
+#if defined( Q_OS_UNIX )
+#include <sys/resource.h>
+#endif
+
+struct ProfilerEvent
+{
+    const char* m_name;
+    qint64 m_start;
+    qint64 m_value;
+    Qt::HANDLE m_thread;
+    bool m_counter;
+};
+
+// the number of most recent events which are stored
+static const int BufferSize = 65536;
+
+static QMutex mutex;
+
+static QVector<ProfilerEvent> events;
+static int nextEvent = 0;
+static bool wrapped = false;
+
+static QHash<const char*, Profiler::Statistics> aggregated;
+
+// the number of distinct queries is limited because their text can be long
+static const int MaxQueries = 500;
+
+static QHash<QString, Profiler::QueryStatistics> queries;
+
+static QElapsedTimer timer;
+
+QAtomicInt Profiler::m_enabled;
+
+static void appendEvent( const char* name, qint64 start, qint64 value, bool counter )
+{
+    QMutexLocker lock( &mutex );
+
+    if ( events.isEmpty() )
+        events.resize( BufferSize );
+
+    ProfilerEvent& event = events[ nextEvent ];
+    event.m_name = name;
+    event.m_start = start;
+    event.m_value = value;
+    event.m_thread = QThread::currentThreadId();
+    event.m_counter = counter;
+
+    if ( ++nextEvent == BufferSize ) {
+        nextEvent = 0;
+        wrapped = true;
+    }
+
+    QHash<const char*, Profiler::Statistics>::iterator it = aggregated.find( name );
+    if ( it == aggregated.end() ) {
+        Profiler::Statistics statistics;
+        statistics.m_name = name;
+        statistics.m_count = 0;
+        statistics.m_total = 0;
+        statistics.m_maximum = 0;
+        statistics.m_counter = counter;
+        it = aggregated.insert( name, statistics );
+    }
+
+    it->m_count++;
+    it->m_total += value;
+    if ( value > it->m_maximum )
+        it->m_maximum = value;
+}
+
+void Profiler::setEnabled( bool enabled )
+{
+    if ( enabled ) {
+        QMutexLocker lock( &mutex );
+        // the timer is never restarted so that timestamps of all events are comparable
+        if ( !timer.isValid() )
+            timer.start();
+    }
+
+    m_enabled.store( enabled ? 1 : 0 );
+}
+
+qint64 Profiler::timestamp()
+{
+    return timer.nsecsElapsed() / 1000;
+}
+
+void Profiler::addEvent( const char* name, qint64 start, qint64 duration )
+{
+    appendEvent( name, start, duration, false );
+}
+
+void Profiler::addCounter( const char* name, qint64 value )
+{
+    if ( isEnabled() )
+        appendEvent( name, timestamp(), value, true );
+}
+
+QList<Profiler::Statistics> Profiler::statistics()
+{
+    QMutexLocker lock( &mutex );
+
+    return aggregated.values();
+}
+
+bool Profiler::hasQueryPlan( const QString& sql )
+{
+    QMutexLocker lock( &mutex );
+
+    return queries.contains( sql ) || queries.count() >= MaxQueries;
+}
+
+void Profiler::addQuery( const QString& sql, const QStringList& plan, qint64 duration, int rows )
+{
+    QMutexLocker lock( &mutex );
+
+    QHash<QString, QueryStatistics>::iterator it = queries.find( sql );
+    if ( it == queries.end() ) {
+        if ( queries.count() >= MaxQueries )
+            return;
+
+        QueryStatistics statistics;
+        statistics.m_sql = sql;
+        statistics.m_plan = plan;
+        statistics.m_count = 0;
+        statistics.m_total = 0;
+        statistics.m_maximum = 0;
+        statistics.m_rows = 0;
+        it = queries.insert( sql, statistics );
+    }
+
+    it->m_count++;
+    it->m_total += duration;
+    if ( duration > it->m_maximum )
+        it->m_maximum = duration;
+    it->m_rows = rows;
+}
+
+QList<Profiler::QueryStatistics> Profiler::queryStatistics()
+{
+    QMutexLocker lock( &mutex );
+
+    return queries.values();
+}
+
+void Profiler::clear()
+{
+    QMutexLocker lock( &mutex );
+
+    events.clear();
+    nextEvent = 0;
+    wrapped = false;
+
+    aggregated.clear();
+    queries.clear();
+}
+
+static void appendString( QByteArray& json, const char* string )
+{
+    json += '"';
+    for ( const char* ch = string; *ch; ch++ ) {
+        if ( *ch == '"' || *ch == '\\' )
+            json += '\\';
+        json += *ch;
+    }
+    json += '"';
+}
+
+QByteArray Profiler::toTraceEvents()
+{
+    QMutexLocker lock( &mutex );
+
+    QByteArray json = "{\"traceEvents\":[";
+
+    QHash<Qt::HANDLE, int> threads;
+
+    int count = wrapped ? BufferSize : nextEvent;
+    int first = wrapped ? nextEvent : 0;
+
+    for ( int i = 0; i < count; i++ ) {
+        const ProfilerEvent& event = events.at( ( first + i ) % BufferSize );
+
+        // threads are numbered in order of appearance
+        int thread = threads.value( event.m_thread, 0 );
+        if ( thread == 0 ) {
+            thread = threads.count() + 1;
+            threads.insert( event.m_thread, thread );
+        }
+
+        if ( i > 0 )
+            json += ',';
+
+        json += "\n{\"name\":";
+        appendString( json, event.m_name );
+
+        if ( event.m_counter ) {
+            json += ",\"ph\":\"C\",\"ts\":";
+            json += QByteArray::number( event.m_start );
+            json += ",\"args\":{\"value\":";
+            json += QByteArray::number( event.m_value );
+            json += '}';
+        } else {
+            json += ",\"ph\":\"X\",\"ts\":";
+            json += QByteArray::number( event.m_start );
+            json += ",\"dur\":";
+            json += QByteArray::number( event.m_value );
+        }
+
+        json += ",\"pid\":1,\"tid\":";
+        json += QByteArray::number( thread );
+        json += '}';
+    }
+
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return json;
+}
+
+qint64 Profiler::peakMemoryUsage()
+{
+#if defined( Q_OS_UNIX )
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return -1;
+#if defined( Q_OS_MAC )
+    // the value is reported in bytes on Mac OS X
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,188 @@
+/**************************************************************************
+* This file is part of the WebIssues Desktop Client program
+* Copyright (C) 2006 Michał Męciński
+* Copyright (C) 2007-2017 WebIssues Team
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**************************************************************************/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QStringList>
+#include <QList>
+
+/**
+* Collector of timing information used for diagnosing performance problems.
+*
+* Durations of instrumented operations are measured using ProfilerScope.
+* The most recent events are stored in a ring buffer, which can be exported
+* in the Chrome trace event format, and the statistics of all operations
+* are aggregated by name.
+*
+* Profiling is disabled by default. When it is disabled, only a single flag
+* is checked by ProfilerScope and no time is measured.
+*
+* All methods are thread-safe.
+*/
+class Profiler
+{
+public:
+    /**
+    * Aggregated statistics of an instrumented operation.
+    */
+    struct Statistics
+    {
+        /** Name of the operation. */
+        const char* m_name;
+        /** Number of calls or the number of counter samples. */
+        int m_count;
+        /** Total time in microseconds or the sum of counter values. */
+        qint64 m_total;
+        /** Maximum time in microseconds or the maximum counter value. */
+        qint64 m_maximum;
+        /** @c true if the statistics refer to a counter. */
+        bool m_counter;
+    };
+
+    /**
+    * Aggregated statistics of an SQL query with its execution plan.
+    */
+    struct QueryStatistics
+    {
+        /** Text of the query. */
+        QString m_sql;
+        /** Lines of the plan reported by EXPLAIN QUERY PLAN. */
+        QStringList m_plan;
+        /** Number of executions. */
+        int m_count;
+        /** Total time in microseconds. */
+        qint64 m_total;
+        /** Maximum time in microseconds. */
+        qint64 m_maximum;
+        /** Number of rows returned by the last execution. */
+        int m_rows;
+    };
+
+public:
+    /**
+    * Enable or disable profiling.
+    */
+    static void setEnabled( bool enabled );
+
+    /**
+    * Return @c true if profiling is enabled.
+    */
+    static bool isEnabled() { return m_enabled.load() != 0; }
+
+    /**
+    * Return the current time in microseconds.
+    */
+    static qint64 timestamp();
+
+    /**
+    * Record a measured operation.
+    * @param name Name of the operation, which must be a string literal.
+    * @param start Starting time returned by timestamp().
+    * @param duration Duration of the operation in microseconds.
+    */
+    static void addEvent( const char* name, qint64 start, qint64 duration );
+
+    /**
+    * Record a value of a counter if profiling is enabled.
+    * @param name Name of the counter, which must be a string literal.
+    * @param value Value of the counter.
+    */
+    static void addCounter( const char* name, qint64 value );
+
+    /**
+    * Return statistics of all operations recorded since profiling was enabled.
+    */
+    static QList<Statistics> statistics();
+
+    /**
+    * Return @c true if the plan of the given query was already recorded.
+    */
+    static bool hasQueryPlan( const QString& sql );
+
+    /**
+    * Record an execution of an SQL query.
+    * @param sql Text of the query.
+    * @param plan Plan of the query or an empty list if it was already recorded.
+    * @param duration Duration of the query in microseconds.
+    * @param rows Number of returned rows.
+    */
+    static void addQuery( const QString& sql, const QStringList& plan, qint64 duration, int rows );
+
+    /**
+    * Return statistics of queries recorded since profiling was enabled.
+    */
+    static QList<QueryStatistics> queryStatistics();
+
+    /**
+    * Remove all recorded events and statistics.
+    */
+    static void clear();
+
+    /**
+    * Return recorded events as a JSON document in the Chrome trace event format.
+    */
+    static QByteArray toTraceEvents();
+
+    /**
+    * Return the peak resident memory of the process in kilobytes
+    * or -1 if it cannot be determined on this platform.
+    */
+    static qint64 peakMemoryUsage();
+
+private:
+    static QAtomicInt m_enabled;
+};
+
+/**
+* Helper class measuring the duration of a block of code.
+*
+* The time between construction and destruction of the object is recorded
+* by the Profiler if profiling is enabled.
+*/
+class ProfilerScope
+{
+public:
+    /**
+    * Constructor.
+    * @param name Name of the operation, which must be a string literal.
+    */
+    ProfilerScope( const char* name ) :
+        m_name( Profiler::isEnabled() ? name : NULL ),
+        m_start( m_name ? Profiler::timestamp() : 0 )
+    {
+    }
+
+    /**
+    * Destructor.
+    */
+    ~ProfilerScope()
+    {
+        if ( m_name )
+            Profiler::addEvent( m_name, m_start, Profiler::timestamp() - m_start );
+    }
+
+private:
+    const char* m_name;
+    qint64 m_start;
+};
+
+#endif
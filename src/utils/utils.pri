@@ -12,6 +12,7 @@ HEADERS += utils/attributehelper.h \
            utils/markupprocessor.h \
            utils/multiselectcompleter.h \
            utils/networkproxyfactory.h \
+           utils/profiler.h \
            utils/treeviewhelper.h \
            utils/updateclient.h \
            utils/validator.h \
@@ -31,6 +32,7 @@ SOURCES += utils/attributehelper.cpp \
            utils/markupprocessor.cpp \
            utils/multiselectcompleter.cpp \
            utils/networkproxyfactory.cpp \
+           utils/profiler.cpp \
            utils/treeviewhelper.cpp \
            utils/updateclient.cpp \
            utils/validator.cpp \
@@ -95,7 +95,7 @@ QString ViewSettingsHelper::filtersInfo( const QList<DefinitionInfo>& filters )
     for ( int i = 0; i < filters.count(); i++ ) {
         DefinitionInfo filter = filters.at( i );
 
-        int column = filter.metadata( "column" ).toInt();
+        int column = filter.column();
         QString name = columnName( column );
 
         QString operatorName;
@@ -120,7 +120,7 @@ QString ViewSettingsHelper::filtersInfo( const QList<DefinitionInfo>& filters )
         else if ( filter.type() == QLatin1String( "IN" ) )
             operatorName = tr( "in" );
 
-        QString value = filter.metadata( "value" ).toString();
+        QString value = filter.value();
 
         IssueTypeCache* cache = dataManager->issueTypeCache( m_typeId );
     
@@ -187,11 +187,11 @@ void FolderView::updateEvent( UpdateEvent* e )
     setAccess( checkDataAccess() );
 
     if ( isEnabled() ) {
-        if ( e->unit() == UpdateEvent::Projects )
+        if ( e->contains( UpdateEvent::Projects ) )
             updateCaption();
     }
 
-    if ( id() != 0 && e->unit() == UpdateEvent::Projects )
+    if ( id() != 0 && e->contains( UpdateEvent::Projects ) )
         cascadeUpdateFolder();
 
     ListView::updateEvent( e );
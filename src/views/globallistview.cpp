@@ -94,14 +94,12 @@ void GlobalListView::initialUpdateFolder()
     if ( isEnabled() ) {
         UpdateBatch* batch = NULL;
 
-        foreach ( const FolderEntity& folder, FolderEntity::list() ) {
-            if ( dataManager->folderUpdateNeeded( folder.id() ) ) {
-                if ( !batch ) {
-                    batch = new UpdateBatch();
-                    batch->setIfNeeded( true );
-                }
-                batch->updateFolder( folder.id() );
+        foreach ( int folderId, dataManager->staleFolders() ) {
+            if ( !batch ) {
+                batch = new UpdateBatch();
+                batch->setIfNeeded( true );
             }
+            batch->updateFolder( folderId );
         }
 
         if ( batch )
@@ -130,14 +128,12 @@ void GlobalListView::cascadeUpdateFolder()
     if ( isEnabled() && !isUpdating() ) {
         UpdateBatch* batch = NULL;
 
-        foreach ( const FolderEntity& folder, FolderEntity::list() ) {
-            if ( dataManager->folderUpdateNeeded( folder.id() ) ) {
-                if ( !batch ) {
-                    batch = new UpdateBatch( -10 );
-                    batch->setIfNeeded( true );
-                }
-                batch->updateFolder( folder.id() );
+        foreach ( int folderId, dataManager->staleFolders() ) {
+            if ( !batch ) {
+                batch = new UpdateBatch( -10 );
+                batch->setIfNeeded( true );
             }
+            batch->updateFolder( folderId );
         }
 
         if ( batch )
@@ -202,11 +198,11 @@ void GlobalListView::updateEvent( UpdateEvent* e )
     setAccess( checkDataAccess() );
 
     if ( isEnabled() ) {
-        if ( e->unit() == UpdateEvent::Types )
+        if ( e->contains( UpdateEvent::Types ) )
             updateCaption();
     }
 
-    if ( id() != 0 && e->unit() == UpdateEvent::Projects )
+    if ( id() != 0 && e->contains( UpdateEvent::Projects ) )
         cascadeUpdateFolder();
 
     ListView::updateEvent( e );
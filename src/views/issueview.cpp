@@ -51,12 +51,14 @@
 #include <QClipboard>
 #include <QDesktopServices>
 #include <QSettings>
+#include <QSet>
 #include <QKeyEvent>
 #include <QScrollBar>
 #include <QPushButton>
 #include <QTimer>
 #include <QWebView>
 #include <QWebFrame>
+#include <QWebElement>
 
 IssueView::IssueView( QObject* parent, QWidget* parentWidget ) : View( parent ),
     m_folderId( 0 ),
@@ -66,7 +68,10 @@ IssueView::IssueView( QObject* parent, QWidget* parentWidget ) : View( parent ),
     m_history( IssueDetailsGenerator::AllHistory ),
     m_isFindEnabled( false ),
     m_lockedIssueId( 0 ),
-    m_loading( false )
+    m_loading( false ),
+    m_pendingFirst( 0 ),
+    m_pendingLast( 0 ),
+    m_renderedHistory( IssueDetailsGenerator::NoHistory )
 {
     QAction* action;
 
@@ -251,6 +256,12 @@ IssueView::IssueView( QObject* parent, QWidget* parentWidget ) : View( parent ),
 
     connect( m_populateTimer, SIGNAL( timeout() ), this, SLOT( populateDetails() ) );
 
+    m_historyTimer = new QTimer( this );
+    m_historyTimer->setInterval( 0 );
+    m_historyTimer->setSingleShot( true );
+
+    connect( m_historyTimer, SIGNAL( timeout() ), this, SLOT( loadMoreHistory() ) );
+
     connect( application->applicationSettings(), SIGNAL( settingsChanged() ), this, SLOT( settingsChanged() ) );
 }
 
@@ -265,6 +276,8 @@ void IssueView::cleanUp()
         dataManager->unlockIssue( m_lockedIssueId );
         m_lockedIssueId = 0;
     }
+
+    clearDetails();
 }
 
 void IssueView::initialUpdate()
@@ -328,11 +341,16 @@ void IssueView::disableView()
     m_browser->setHtml( QString() );
     m_findBar->hide();
 
+    clearDetails();
+
     updateCaption();
 }
 
 void IssueView::updateAccess( Access access )
 {
+    // links to edit and delete items depend on permissions
+    clearDetails();
+
     bool emailEnabled = dataManager->setting( "email_enabled" ).toInt();
 
     action( "moveIssue" )->setVisible( access == AdminAccess );
@@ -630,6 +648,8 @@ void IssueView::findText( const QString& text, int flags )
 {
     bool warn = false;
 
+    loadAllHistory();
+
     if ( !text.isEmpty() )
         warn = !m_browser->findText( text, (QWebPage::FindFlags)flags | QWebPage::FindWrapsAroundDocument );
 
@@ -714,32 +734,22 @@ void IssueView::updateEvent( UpdateEvent* e )
     setAccess( checkDataAccess() );
 
     if ( isEnabled() ) {
-        if ( e->unit() == UpdateEvent::Issue && e->id() == id() ) {
-            updateCaption();
-            updateActions();
-            populateDetails();
-        }
-
-        if ( e->unit() == UpdateEvent::Users )
-            populateDetailsDelayed();
-
-        if ( e->unit() == UpdateEvent::Types )
-            populateDetailsDelayed();
-
-        if ( e->unit() == UpdateEvent::Projects )
+        if ( e->contains( UpdateEvent::Users ) || e->contains( UpdateEvent::Types ) || e->contains( UpdateEvent::Projects ) ) {
+            // names of users and attributes may be included in rendered items
+            clearDetails();
             populateDetailsDelayed();
+        }
 
-        if ( e->unit() == UpdateEvent::Folder && e->id() == m_folderId ) {
+        if ( e->contains( UpdateEvent::Issue, id() ) || e->contains( UpdateEvent::Folder, m_folderId ) ) {
             updateCaption();
             updateActions();
             populateDetails();
-        }
-
-        if ( e->unit() == UpdateEvent::States )
+        } else if ( e->contains( UpdateEvent::States ) ) {
             updateActions();
+        }
     }
 
-    if ( id() != 0 && m_folderId != 0 && e->unit() == UpdateEvent::Folder && e->id() == m_folderId )
+    if ( id() != 0 && m_folderId != 0 && e->contains( UpdateEvent::Folder, m_folderId ) )
         cascadeUpdateIssue();
 }
 
@@ -757,37 +767,227 @@ void IssueView::populateDetails()
 
     QApplication::setOverrideCursor( Qt::WaitCursor );
 
-    QPoint pos = m_browser->page()->mainFrame()->scrollPosition();
+    m_historyTimer->stop();
+
+    // the displayed page can only be updated when all items are loaded
+    bool update = !m_loading && m_pendingFirst >= m_pendingLast && m_history == m_renderedHistory && !m_renderedItems.isEmpty();
 
-    IssueDetailsGenerator generator;
-    generator.setIssue( id(), true, m_history );
+    m_generator.setIssue( id(), true, m_history );
+    m_generator.setHistoryCache( &m_historyCache );
+    m_generator.setSectionIds( true );
+    m_generator.setHistoryLimit( update ? 0 : HistoryPageSize );
 
     HtmlWriter writer;
-    generator.write( &writer );
+    m_generator.write( &writer );
+
+    const QList<HistoryItem>& items = m_generator.historyItems();
+    int count = m_generator.historyItemsCount();
 
-    m_loading = true;
-    m_browser->setHtml( writer.toHtml() );
+    if ( !update || !updateDetails( writer, items ) ) {
+        QPoint pos = m_browser->page()->mainFrame()->scrollPosition();
 
-    m_browser->page()->mainFrame()->setScrollPosition( pos );
+        m_loading = true;
+        m_browser->setHtml( writer.toHtml() );
+
+        m_browser->page()->mainFrame()->setScrollPosition( pos );
+    }
+
+    // older items are loaded in pages after the page is loaded
+    if ( m_generator.historyOrder() == Qt::AscendingOrder ) {
+        m_pendingFirst = 0;
+        m_pendingLast = count - items.count();
+    } else {
+        m_pendingFirst = items.count();
+        m_pendingLast = count;
+    }
+
+    m_renderedHistory = m_history;
+    m_renderedItems = items;
+    m_renderedTitle = writer.sectionHtml( "issue-title" );
+    m_renderedDetails = writer.sectionHtml( "issue-details" );
+
+    if ( m_pendingFirst >= m_pendingLast )
+        pruneHistoryCache();
 
     QStringList status;
     if ( m_history != IssueDetailsGenerator::OnlyFiles )
-        status.append( tr( "%1 comments" ).arg( generator.commentsCount() ) );
+        status.append( tr( "%1 comments" ).arg( m_generator.commentsCount() ) );
     if ( m_history != IssueDetailsGenerator::OnlyComments )
-        status.append( tr( "%1 attachments" ).arg( generator.filesCount() ) );
+        status.append( tr( "%1 attachments" ).arg( m_generator.filesCount() ) );
     showSummary( QPixmap(), status.join( ", " ) );
 
     QApplication::restoreOverrideCursor();
 }
 
+bool IssueView::updateDetails( const HtmlWriter& writer, const QList<HistoryItem>& items )
+{
+    if ( items.isEmpty() )
+        return false;
+
+    QHash<int, int> renderedIndexes;
+    for ( int i = 0; i < m_renderedItems.count(); i++ )
+        renderedIndexes.insert( m_renderedItems.at( i ).m_id, i );
+
+    QSet<int> ids;
+    int lastIndex = -1;
+
+    // items which are not modified must remain in the same order
+    foreach ( const HistoryItem& item, items ) {
+        int index = renderedIndexes.value( item.m_id, -1 );
+        if ( index >= 0 ) {
+            if ( index < lastIndex )
+                return false;
+            lastIndex = index;
+        }
+        ids.insert( item.m_id );
+    }
+
+    QWebFrame* frame = m_browser->page()->mainFrame();
+
+    QWebElement title = frame->findFirstElement( "#issue-title" );
+    QWebElement details = frame->findFirstElement( "#issue-details" );
+
+    if ( title.isNull() || details.isNull() )
+        return false;
+
+    QString titleHtml = writer.sectionHtml( "issue-title" );
+    if ( titleHtml != m_renderedTitle )
+        title.setInnerXml( titleHtml );
+
+    QString detailsHtml = writer.sectionHtml( "issue-details" );
+    if ( detailsHtml != m_renderedDetails )
+        details.setInnerXml( detailsHtml );
+
+    foreach ( const HistoryItem& item, m_renderedItems ) {
+        if ( !ids.contains( item.m_id ) )
+            frame->findFirstElement( QString( "#history%1" ).arg( item.m_id ) ).removeFromDocument();
+    }
+
+    QWebElement previous;
+
+    foreach ( const HistoryItem& item, items ) {
+        QString selector = QString( "#history%1" ).arg( item.m_id );
+
+        int index = renderedIndexes.value( item.m_id, -1 );
+
+        if ( index >= 0 ) {
+            const HistoryItem& rendered = m_renderedItems.at( index );
+            if ( rendered.m_lastId != item.m_lastId || rendered.m_stampId != item.m_stampId )
+                frame->findFirstElement( selector ).setOuterXml( item.m_html );
+        } else if ( !previous.isNull() ) {
+            previous.appendOutside( item.m_html );
+        } else {
+            QWebElement first = frame->findFirstElement( "div.history-item" );
+            if ( first.isNull() )
+                return false;
+            first.prependOutside( item.m_html );
+        }
+
+        previous = frame->findFirstElement( selector );
+        if ( previous.isNull() )
+            return false;
+    }
+
+    frame->evaluateJavaScript( "prettyPrint();" );
+
+    if ( !m_scrollAnchor.isEmpty() )
+        scrollToAnchor();
+
+    return true;
+}
+
+void IssueView::clearDetails()
+{
+    m_historyCache.clear();
+
+    m_historyTimer->stop();
+    m_pendingFirst = 0;
+    m_pendingLast = 0;
+
+    m_renderedHistory = IssueDetailsGenerator::NoHistory;
+    m_renderedItems.clear();
+    m_renderedTitle.clear();
+    m_renderedDetails.clear();
+}
+
+void IssueView::loadMoreHistory()
+{
+    if ( m_loading || m_pendingFirst >= m_pendingLast )
+        return;
+
+    QWebElement placeholder = m_browser->page()->mainFrame()->findFirstElement( "#history-more" );
+
+    if ( placeholder.isNull() ) {
+        m_pendingFirst = m_pendingLast = 0;
+        return;
+    }
+
+    bool ascending = ( m_generator.historyOrder() == Qt::AscendingOrder );
+
+    // the most recent of the remaining items are loaded first
+    int first;
+    int count;
+    if ( ascending ) {
+        first = qMax( m_pendingFirst, m_pendingLast - HistoryPageSize );
+        count = m_pendingLast - first;
+        m_pendingLast = first;
+    } else {
+        first = m_pendingFirst;
+        count = qMin( HistoryPageSize, m_pendingLast - first );
+        m_pendingFirst += count;
+    }
+
+    HtmlWriter writer;
+    m_generator.writeHistoryItems( &writer, first, count );
+
+    if ( ascending ) {
+        placeholder.appendOutside( writer.bodyHtml() );
+        m_renderedItems = m_generator.historyItems() + m_renderedItems;
+    } else {
+        placeholder.prependOutside( writer.bodyHtml() );
+        m_renderedItems += m_generator.historyItems();
+    }
+
+    if ( m_pendingFirst >= m_pendingLast ) {
+        placeholder.removeFromDocument();
+        pruneHistoryCache();
+    } else {
+        m_historyTimer->start();
+    }
+
+    m_browser->page()->mainFrame()->evaluateJavaScript( "prettyPrint();" );
+}
+
+void IssueView::loadAllHistory()
+{
+    while ( !m_loading && m_pendingFirst < m_pendingLast )
+        loadMoreHistory();
+
+    m_historyTimer->stop();
+}
+
+void IssueView::pruneHistoryCache()
+{
+    // only keep items which are still part of the history
+    m_historyCache.clear();
+    foreach ( const HistoryItem& item, m_renderedItems )
+        m_historyCache.insert( item.m_id, item );
+}
+
 void IssueView::scrollToAnchor()
 {
     m_loading = false;
 
     if ( !m_scrollAnchor.isEmpty() ) {
+        // the item may be located in the part of history which is not loaded yet
+        loadAllHistory();
+
         m_browser->page()->mainFrame()->scrollToAnchor( m_scrollAnchor );
         m_scrollAnchor.clear();
     }
+
+    if ( m_pendingFirst < m_pendingLast )
+        m_historyTimer->start();
 }
 
 bool IssueView::linkContextMenu( const QUrl& link, const QPoint& pos )
@@ -979,7 +1179,12 @@ void IssueView::handleAttachment( int fileId, AttachmentAction action )
             return;
         }
 
-        dataManager->commitFile( fileId, cachePath, file.size() );
+        cachePath = dataManager->commitFile( fileId, cachePath, file.size(), dialog.fileHash() );
+
+        if ( cachePath.isEmpty() ) {
+            MessageBox::warning( mainWidget(), tr( "Error" ), tr( "File could not be saved." ) );
+            return;
+        }
     }
 
     if ( action == ActionOpen ) {
@@ -992,12 +1197,20 @@ void IssueView::handleAttachment( int fileId, AttachmentAction action )
             }
         }
 
-        if ( !QFile::copy( cachePath, path ) )
+        if ( !QFile::copy( cachePath, path ) ) {
             MessageBox::warning( mainWidget(), tr( "Error" ), tr( "File could not be saved." ) );
+            return;
+        }
+
+        // the copy of a read-only cached file can be modified
+        QFile::setPermissions( path, QFile::permissions( path ) | QFile::WriteOwner | QFile::WriteUser );
     }
 }
 
 void IssueView::settingsChanged()
 {
     m_browser->setTextSizeMultiplier( application->textSizeMultiplier() );
+
+    // the format of dates depends on settings
+    clearDetails();
 }
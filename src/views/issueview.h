@@ -31,6 +31,7 @@ class PopEditPanel;
 class PopEditBox;
 class RowIndex;
 class FindBar;
+class HtmlWriter;
 
 class QTabWidget;
 class QTreeView;
@@ -124,6 +125,8 @@ private slots:
 
     void scrollToAnchor();
 
+    void loadMoreHistory();
+
     void issueAdded( int issueId );
 
     void settingsChanged();
@@ -138,6 +141,12 @@ private:
 
     void populateDetailsDelayed();
 
+    bool updateDetails( const HtmlWriter& writer, const QList<HistoryItem>& items );
+    void clearDetails();
+
+    void loadAllHistory();
+    void pruneHistoryCache();
+
     void findItem( int itemId );
 
     void findText( const QString& text, int flags );
@@ -173,6 +182,24 @@ private:
 
     bool m_loading;
     QString m_scrollAnchor;
+
+    IssueDetailsGenerator m_generator;
+
+    QHash<int, HistoryItem> m_historyCache;
+
+    QTimer* m_historyTimer;
+    int m_pendingFirst;
+    int m_pendingLast;
+
+    IssueDetailsGenerator::History m_renderedHistory;
+    QList<HistoryItem> m_renderedItems;
+    QString m_renderedTitle;
+    QString m_renderedDetails;
+
+    /**
+    * The number of history items rendered at once.
+    */
+    static const int HistoryPageSize = 50;
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 #include "listview.h"
 
+#include "commands/commandmanager.h"
 #include "commands/updatebatch.h"
 #include "data/datamanager.h"
 #include "data/entities.h"
@@ -47,6 +48,7 @@
 #include <QAction>
 #include <QMenu>
 #include <QKeyEvent>
+#include <QTimer>
 
 ListView::ListView( QObject* parent, QWidget* parentWidget ) : View( parent ),
     m_model( NULL ),
@@ -57,7 +59,10 @@ ListView::ListView( QObject* parent, QWidget* parentWidget ) : View( parent ),
     m_hasIssues( false ),
     m_currentViewId( 0 ),
     m_currentProjectId( 0 ),
-    m_searchColumn( Column_Name )
+    m_searchColumn( Column_Name ),
+    m_pendingIssueId( 0 ),
+    m_pendingItemId( 0 ),
+    m_prefetchIssueId( 0 )
 {
     QAction* action;
 
@@ -236,6 +241,18 @@ ListView::ListView( QObject* parent, QWidget* parentWidget ) : View( parent ),
 
     searchLabel->setBuddy( m_searchBox );
 
+    m_searchTimer = new QTimer( this );
+    m_searchTimer->setInterval( 250 );
+    m_searchTimer->setSingleShot( true );
+
+    connect( m_searchTimer, SIGNAL( timeout() ), this, SLOT( applyQuickSearch() ) );
+
+    m_prefetchTimer = new QTimer( this );
+    m_prefetchTimer->setInterval( 500 );
+    m_prefetchTimer->setSingleShot( true );
+
+    connect( m_prefetchTimer, SIGNAL( timeout() ), this, SLOT( prefetchIssues() ) );
+
     m_list = new QTreeView( main );
     mainLayout->addWidget( m_list );
 
@@ -278,6 +295,14 @@ void ListView::cleanUp()
     m_currentViewId = 0;
     m_currentProjectId = 0;
 
+    m_pendingIssueId = 0;
+    m_pendingItemId = 0;
+
+    m_searchTimer->stop();
+
+    cancelPrefetch();
+    m_prefetchIssueId = 0;
+
     delete m_model;
     m_model = NULL;
 }
@@ -287,13 +312,17 @@ void ListView::initialUpdate()
     cleanUp();
 
     m_searchBox->clear();
+    m_searchTimer->stop();
 
     m_model = new FolderModel( this );
+    m_model->setBackgroundMode( true );
 
     connect( m_model, SIGNAL( layoutChanged() ), this, SLOT( updateActions() ) );
     connect( m_model, SIGNAL( layoutChanged() ), this, SLOT( updateSummary() ) );
+    connect( m_model, SIGNAL( layoutChanged() ), this, SLOT( selectPendingIssue() ) );
     connect( m_model, SIGNAL( modelReset() ), this, SLOT( updateActions() ) );
     connect( m_model, SIGNAL( modelReset() ), this, SLOT( updateSummary() ) );
+    connect( m_model, SIGNAL( modelReset() ), this, SLOT( selectPendingIssue() ) );
 
     initializeList();
 }
@@ -382,6 +411,8 @@ void ListView::updateActions()
 
     action( "modifyView" )->setEnabled( isPersonalView );
 
+    schedulePrefetch();
+
     emit selectedIssueChanged( m_selectedIssueId );
 }
 
@@ -543,23 +574,106 @@ void ListView::modifyView()
 void ListView::updateEvent( UpdateEvent* e )
 {
     if ( isEnabled() ) {
-        if ( e->unit() == UpdateEvent::Types ) {
+        if ( e->contains( UpdateEvent::Types ) ) {
             updateViews();
             loadCurrentView( false );
             updateSearchOptions();
+        } else if ( e->contains( UpdateEvent::Settings ) ) {
+            loadCurrentView( false );
         }
 
-        if ( e->unit() == UpdateEvent::Projects )
+        if ( e->contains( UpdateEvent::Projects ) )
             updateProjects();
 
-        if ( e->unit() == UpdateEvent::States )
+        if ( e->contains( UpdateEvent::States ) )
             updateActions();
 
-        if ( e->unit() == UpdateEvent::Settings )
-            loadCurrentView( false );
+        // the neighbors are prefetched when details of the selected issue are loaded
+        if ( e->contains( UpdateEvent::Issue, m_prefetchIssueId ) && m_prefetchIssueId != 0 )
+            m_prefetchTimer->start();
+    }
+}
+
+void ListView::schedulePrefetch()
+{
+    if ( m_selectedIssueId == m_prefetchIssueId )
+        return;
+
+    cancelPrefetch();
+
+    m_prefetchIssueId = m_selectedIssueId;
+
+    if ( m_prefetchIssueId != 0 && !dataManager->issueUpdateNeeded( m_prefetchIssueId ) )
+        m_prefetchTimer->start();
+}
+
+void ListView::cancelPrefetch()
+{
+    m_prefetchTimer->stop();
+
+    if ( !commandManager )
+        return;
+
+    // the command which was already sent is completed, but the pending ones are discarded
+    foreach ( AbstractBatch* batch, m_prefetchBatches ) {
+        if ( !commandManager->isExecuting( batch ) )
+            commandManager->abort( batch );
     }
 }
 
+void ListView::prefetchIssues()
+{
+    if ( !isEnabled() || m_prefetchIssueId == 0 || m_prefetchIssueId != m_selectedIssueId )
+        return;
+
+    TreeViewHelper helper( m_list );
+    QModelIndex index = helper.selectedIndex();
+
+    if ( !index.isValid() )
+        return;
+
+    QList<int> issues;
+
+    QModelIndex below = index;
+    QModelIndex above = index;
+
+    for ( int i = 0; i < PrefetchCount; i++ ) {
+        if ( below.isValid() )
+            below = m_list->indexBelow( below );
+        if ( below.isValid() )
+            issues.append( m_model->rowId( below ) );
+
+        if ( above.isValid() )
+            above = m_list->indexAbove( above );
+        if ( above.isValid() )
+            issues.append( m_model->rowId( above ) );
+    }
+
+    foreach ( int issueId, dataManager->staleIssues( issues ) ) {
+        if ( m_prefetchBatches.contains( issueId ) )
+            continue;
+
+        // each issue is updated by a separate batch with low priority, so that other updates are executed first
+        UpdateBatch* batch = new UpdateBatch( -20 );
+        batch->setIfNeeded( true );
+        batch->updateIssue( issueId, false );
+
+        connect( batch, SIGNAL( completed( bool ) ), this, SLOT( prefetchCompleted() ) );
+
+        m_prefetchBatches.insert( issueId, batch );
+
+        commandManager->execute( batch );
+    }
+}
+
+void ListView::prefetchCompleted()
+{
+    AbstractBatch* batch = static_cast<AbstractBatch*>( sender() );
+
+    int issueId = m_prefetchBatches.key( batch );
+    m_prefetchBatches.remove( issueId );
+}
+
 void ListView::headerContextMenu( const QPoint& pos )
 {
     QMenu* menu = builder()->contextMenu( "menuHeader" );
@@ -605,6 +719,10 @@ void ListView::setSelectedIssueId( int issueId )
     if ( index.isValid() ) {
         m_list->selectionModel()->setCurrentIndex( index, QItemSelectionModel::Current );
         m_list->selectionModel()->select( index, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows );
+        m_pendingIssueId = 0;
+    } else if ( m_model->isUpdating() ) {
+        // the issue will be selected when the list is loaded
+        m_pendingIssueId = issueId;
     }
 }
 
@@ -615,6 +733,25 @@ void ListView::gotoIssue( int issueId, int itemId )
 
     if ( issueId == m_selectedIssueId )
         emit itemActivated( itemId );
+    else if ( issueId == m_pendingIssueId )
+        m_pendingItemId = itemId;
+}
+
+void ListView::selectPendingIssue()
+{
+    if ( m_pendingIssueId == 0 || m_model->isUpdating() )
+        return;
+
+    int issueId = m_pendingIssueId;
+    int itemId = m_pendingItemId;
+
+    m_pendingIssueId = 0;
+    m_pendingItemId = 0;
+
+    if ( itemId != 0 )
+        gotoIssue( issueId, itemId );
+    else
+        setSelectedIssueId( issueId );
 }
 
 void ListView::updateSearchOptions()
@@ -652,10 +789,17 @@ void ListView::updateSearchOptions()
     m_searchBox->setPlaceholderText( helper.columnName( m_searchColumn ) );
 }
 
-void ListView::quickSearchChanged( const QString& text )
+void ListView::quickSearchChanged( const QString& /*text*/ )
 {
+    // wait until the user stops typing
     if ( m_model )
-        m_model->setSearchText( m_searchColumn, text );
+        m_searchTimer->start();
+}
+
+void ListView::applyQuickSearch()
+{
+    if ( m_model )
+        m_model->setSearchText( m_searchColumn, m_searchBox->text() );
 }
 
 void ListView::searchActionTriggered( QAction* action )
@@ -665,6 +809,8 @@ void ListView::searchActionTriggered( QAction* action )
     ViewSettingsHelper helper( m_typeId );
     m_searchBox->setPlaceholderText( helper.columnName( m_searchColumn ) );
 
+    m_searchTimer->stop();
+
     m_model->setSearchText( m_searchColumn, m_searchBox->text() );
 }
 
@@ -22,6 +22,8 @@
 
 #include "views/view.h"
 
+#include <QMap>
+
 class FolderModel;
 class IssueRowFilter;
 class SearchEditBox;
@@ -33,6 +35,9 @@ class QModelIndex;
 class QMenu;
 class QActionGroup;
 class QLabel;
+class QTimer;
+
+class AbstractBatch;
 
 /**
 * Abstract view displaying a list of issues.
@@ -126,6 +131,8 @@ private slots:
     void updateActions();
     void updateSummary();
 
+    void selectPendingIssue();
+
     void openIssue();
     void editIssue();
     void cloneIssue();
@@ -153,13 +160,21 @@ private slots:
     void quickSearchChanged( const QString& text );
     void searchActionTriggered( QAction* action );
 
+    void applyQuickSearch();
+
     void viewActivated( int index );
 
     void projectActivated( int index );
 
+    void prefetchIssues();
+    void prefetchCompleted();
+
 private:
     void cleanUp();
 
+    void schedulePrefetch();
+    void cancelPrefetch();
+
     void updateViews();
     void updateProjects();
     void updateSearchOptions();
@@ -183,6 +198,13 @@ protected:
 
     bool m_hasIssues;
 
+private:
+    /**
+    * The number of issues above and below the selected issue whose details are prefetched.
+    * It is kept well below the limit of cached issue details.
+    */
+    static const int PrefetchCount = 2;
+
 private:
     QTreeView* m_list;
 
@@ -196,10 +218,19 @@ private:
     QMenu* m_searchMenu;
     QActionGroup* m_searchActionGroup;
 
+    QTimer* m_searchTimer;
+
     int m_currentViewId;
     int m_currentProjectId;
 
     int m_searchColumn;
+
+    int m_pendingIssueId;
+    int m_pendingItemId;
+
+    QTimer* m_prefetchTimer;
+    int m_prefetchIssueId;
+    QMap<int, AbstractBatch*> m_prefetchBatches;
 };
 
 #endif
@@ -43,10 +43,13 @@
 #include <QMenu>
 #include <QTimer>
 #include <QMessageBox>
+#include <QApplication>
 
 ProjectsView::ProjectsView( QObject* parent, QWidget* parentWidget ) : View( parent ),
-    m_folderUpdateCounter( 0 ),
-    m_updateCounter( 0 ),
+    m_backoff( 0 ),
+    m_updatePending( false ),
+    m_periodicUpdate( false ),
+    m_globalUpdate( false ),
     m_sessionExpired( false )
 {
     m_systemAdmin = dataManager->currentUserAccess() == AdminAccess;
@@ -165,11 +168,17 @@ void ProjectsView::initialUpdate()
 
     updateActions();
 
-    initialUpdateData();
-
     m_timer = new QTimer( this );
+    m_timer->setSingleShot( true );
+    m_timer->setTimerType( Qt::VeryCoarseTimer );
     connect( m_timer, SIGNAL( timeout() ), this, SLOT( updateTimeout() ) );
-    m_timer->start( 60 * 1000 );
+
+    // make sure that clients started at the same time use different jitter
+    qsrand( static_cast<uint>( QDateTime::currentMSecsSinceEpoch() ) ^ static_cast<uint>( QCoreApplication::applicationPid() ) );
+
+    connect( qApp, SIGNAL( applicationStateChanged( Qt::ApplicationState ) ), this, SLOT( applicationStateChanged( Qt::ApplicationState ) ) );
+
+    initialUpdateData();
 
     setAccess( checkDataAccess(), true );
 }
@@ -197,26 +206,210 @@ void ProjectsView::updateAccess( Access /*access*/ )
 }
 
 void ProjectsView::updateTimeout()
+{
+    // the timer is started again when the current update is completed
+    if ( m_periodicUpdate )
+        return;
+
+    if ( m_sessionExpired ) {
+        scheduleUpdate();
+        return;
+    }
+
+    // the update is resumed when the application is activated again
+    if ( isPaused() ) {
+        m_updatePending = true;
+        return;
+    }
+
+    // the timer has a resolution of one second
+    QDateTime now = QDateTime::currentDateTime().addSecs( 1 );
+
+    if ( now >= nextGlobalUpdate() ) {
+        LocalSettings* settings = application->applicationSettings();
+        int interval = settings->value( "UpdateInterval" ).toInt() * 60;
+
+        bool full = !m_lastFullUpdate.isValid() || m_lastFullUpdate.secsTo( now ) >= interval;
+
+        periodicUpdateData( full );
+        return;
+    }
+
+    QList<int> folders;
+    foreach ( int folderId, activeFolders() ) {
+        if ( now >= nextFolderUpdate( folderId ) )
+            folders.append( folderId );
+    }
+
+    if ( !folders.isEmpty() )
+        periodicUpdateFolders( folders );
+    else
+        scheduleUpdate();
+}
+
+void ProjectsView::periodicUpdateCompleted( bool successful )
+{
+    m_periodicUpdate = false;
+
+    QDateTime now = QDateTime::currentDateTime();
+    int interval = updateInterval();
+
+    bool changed = checkFolderStamps();
+
+    if ( m_globalUpdate ) {
+        // back off exponentially as long as no folder is modified
+        if ( changed )
+            m_backoff = 0;
+        else if ( successful && m_backoff < MaxBackoff )
+            m_backoff++;
+
+        LocalSettings* settings = application->applicationSettings();
+        int maxInterval = qMax( interval, settings->value( "UpdateInterval" ).toInt() * 60 );
+
+        m_lastUpdate = now;
+        m_nextUpdate = jitteredTime( qMin( interval << m_backoff, maxInterval ) );
+
+        // the update of projects also updates all folders which were modified
+        m_folderUpdates.clear();
+        foreach ( int folderId, activeFolders() )
+            m_folderUpdates.insert( folderId, jitteredTime( interval ) );
+    } else {
+        if ( changed )
+            m_backoff = 0;
+
+        foreach ( int folderId, m_updatedFolders )
+            m_folderUpdates.insert( folderId, jitteredTime( interval ) );
+    }
+
+    m_updatedFolders.clear();
+
+    scheduleUpdate();
+}
+
+void ProjectsView::applicationStateChanged( Qt::ApplicationState state )
+{
+    if ( state == Qt::ApplicationActive ) {
+        m_inactiveSince = QDateTime();
+
+        if ( m_updatePending ) {
+            m_updatePending = false;
+            updateTimeout();
+        }
+    } else if ( !m_inactiveSince.isValid() ) {
+        m_inactiveSince = QDateTime::currentDateTime();
+    }
+}
+
+bool ProjectsView::isPaused() const
+{
+    if ( m_list->window()->isMinimized() )
+        return true;
+
+    return m_inactiveSince.isValid() && m_inactiveSince.secsTo( QDateTime::currentDateTime() ) >= IdleTimeout;
+}
+
+int ProjectsView::updateInterval() const
 {
     LocalSettings* settings = application->applicationSettings();
-    int folderUpdateInterval = settings->value( "FolderUpdateInterval" ).toInt();
-    int updateInterval = settings->value( "UpdateInterval" ).toInt();
-
-    m_folderUpdateCounter++;
-    m_updateCounter++;
-
-    if ( m_updateCounter >= updateInterval ) {
-        m_folderUpdateCounter = 0;
-        m_updateCounter = 0;
-        periodicUpdateData( true );
-    } else if ( m_folderUpdateCounter >= folderUpdateInterval ) {
-        m_folderUpdateCounter = 0;
-        periodicUpdateData( false );
+    return qMax( settings->value( "FolderUpdateInterval" ).toInt(), 1 ) * 60;
+}
+
+QDateTime ProjectsView::jitteredTime( int interval ) const
+{
+    // spread updates of many clients over time to avoid load peaks on the server
+    int jitter = interval / 10;
+    if ( jitter > 0 )
+        interval += qrand() % ( 2 * jitter + 1 ) - jitter;
+
+    return QDateTime::currentDateTime().addSecs( interval );
+}
+
+QList<int> ProjectsView::activeFolders() const
+{
+    QList<int> result = viewManager->visibleViewIds( "FolderView" );
+
+    QDateTime now = QDateTime::currentDateTime();
+
+    for ( QHash<int, QDateTime>::const_iterator it = m_folderChanges.constBegin(); it != m_folderChanges.constEnd(); ++it ) {
+        if ( it.value().secsTo( now ) < RecentChangePeriod && !result.contains( it.key() ) )
+            result.append( it.key() );
     }
+
+    return result;
+}
+
+QDateTime ProjectsView::nextGlobalUpdate() const
+{
+    if ( !m_lastUpdate.isValid() )
+        return QDateTime::currentDateTime();
+
+    // global lists depend on the update of projects and states, so it is not backed off
+    if ( !viewManager->visibleViewIds( "GlobalListView" ).isEmpty() )
+        return qMin( m_nextUpdate, m_lastUpdate.addSecs( updateInterval() ) );
+
+    return m_nextUpdate;
+}
+
+QDateTime ProjectsView::nextFolderUpdate( int folderId ) const
+{
+    if ( m_folderUpdates.contains( folderId ) )
+        return m_folderUpdates.value( folderId );
+
+    // a folder which became active is updated one interval after the last update of projects
+    if ( m_lastUpdate.isValid() )
+        return m_lastUpdate.addSecs( updateInterval() );
+
+    return QDateTime::currentDateTime();
+}
+
+void ProjectsView::scheduleUpdate()
+{
+    // the timer is started again when the current update is completed
+    if ( m_periodicUpdate )
+        return;
+
+    QDateTime now = QDateTime::currentDateTime();
+
+    // check for newly visible folders and global lists at least once per interval
+    QDateTime next = qMin( nextGlobalUpdate(), now.addSecs( updateInterval() ) );
+
+    foreach ( int folderId, activeFolders() )
+        next = qMin( next, nextFolderUpdate( folderId ) );
+
+    m_timer->start( (int)qMax( now.msecsTo( next ), (qint64)0 ) );
+}
+
+bool ProjectsView::checkFolderStamps()
+{
+    bool changed = false;
+
+    QDateTime now = QDateTime::currentDateTime();
+
+    QHash<int, int> stamps;
+    foreach ( const FolderEntity& folder, FolderEntity::list() ) {
+        stamps.insert( folder.id(), folder.stampId() );
+        if ( m_folderStamps.contains( folder.id() ) && m_folderStamps.value( folder.id() ) != folder.stampId() ) {
+            m_folderChanges.insert( folder.id(), now );
+            changed = true;
+        }
+    }
+
+    m_folderStamps = stamps;
+
+    for ( QHash<int, QDateTime>::iterator it = m_folderChanges.begin(); it != m_folderChanges.end(); ) {
+        if ( !stamps.contains( it.key() ) || it.value().secsTo( now ) >= RecentChangePeriod )
+            it = m_folderChanges.erase( it );
+        else
+            ++it;
+    }
+
+    return changed;
 }
 
 void ProjectsView::initialUpdateData()
 {
+    m_lastFullUpdate = QDateTime::currentDateTime();
+
     UpdateBatch* batch = new UpdateBatch( -1 );
     batch->updateSettings();
     batch->updateUsers();
@@ -224,22 +417,45 @@ void ProjectsView::initialUpdateData()
     batch->updateProjects();
     batch->updateStates();
 
+    m_periodicUpdate = true;
+    m_globalUpdate = true;
+
+    connect( batch, SIGNAL( completed( bool ) ), this, SLOT( periodicUpdateCompleted( bool ) ) );
+
     executeUpdate( batch );
 }
 
 void ProjectsView::periodicUpdateData( bool full )
 {
-    if ( m_sessionExpired )
-        return;
-
     UpdateBatch* batch = new UpdateBatch( -15 );
     if ( full ) {
+        m_lastFullUpdate = QDateTime::currentDateTime();
         batch->updateUsers();
         batch->updateTypes();
     }
     batch->updateProjects();
     batch->updateStates();
 
+    m_periodicUpdate = true;
+    m_globalUpdate = true;
+
+    connect( batch, SIGNAL( completed( bool ) ), this, SLOT( periodicUpdateCompleted( bool ) ) );
+
+    executeUpdate( batch );
+}
+
+void ProjectsView::periodicUpdateFolders( const QList<int>& folders )
+{
+    UpdateBatch* batch = new UpdateBatch( -15 );
+    foreach ( int folderId, folders )
+        batch->updateFolder( folderId );
+
+    m_periodicUpdate = true;
+    m_globalUpdate = false;
+    m_updatedFolders = folders;
+
+    connect( batch, SIGNAL( completed( bool ) ), this, SLOT( periodicUpdateCompleted( bool ) ) );
+
     executeUpdate( batch );
 }
 
@@ -247,14 +463,12 @@ void ProjectsView::cascadeUpdateFolders()
 {
     UpdateBatch* batch = NULL;
 
-    foreach ( const FolderEntity& folder, FolderEntity::list() ) {
-        if ( dataManager->folderUpdateNeeded( folder.id() ) ) {
-            if ( !batch ) {
-                batch = new UpdateBatch( -20 );
-                batch->setIfNeeded( true );
-            }
-            batch->updateFolder( folder.id() );
+    foreach ( int folderId, dataManager->staleFolders() ) {
+        if ( !batch ) {
+            batch = new UpdateBatch( -20 );
+            batch->setIfNeeded( true );
         }
+        batch->updateFolder( folderId );
     }
 
     if ( batch )
@@ -409,10 +623,9 @@ void ProjectsView::setSelection( int folderId, int typeId, int viewId )
 
 void ProjectsView::updateProjects()
 {
-    if ( !isUpdating() ) {
-        m_folderUpdateCounter = 0;
-        m_updateCounter = 0;
-        m_timer->start();
+    if ( !isUpdating() && !m_periodicUpdate ) {
+        m_backoff = 0;
+        m_lastFullUpdate = QDateTime::currentDateTime();
 
         UpdateBatch* batch = new UpdateBatch();
         batch->updateUsers();
@@ -420,6 +633,11 @@ void ProjectsView::updateProjects()
         batch->updateProjects();
         batch->updateStates();
 
+        m_periodicUpdate = true;
+        m_globalUpdate = true;
+
+        connect( batch, SIGNAL( completed( bool ) ), this, SLOT( periodicUpdateCompleted( bool ) ) );
+
         executeUpdate( batch );
     }
 }
@@ -534,10 +752,10 @@ void ProjectsView::updateEvent( UpdateEvent* e )
 {
     setAccess( checkDataAccess() );
 
-    if ( e->unit() == UpdateEvent::Projects )
+    if ( e->contains( UpdateEvent::Projects ) )
         cascadeUpdateFolders();
 
-    if ( e->unit() == UpdateEvent::GlobalAccess && m_sessionExpired ) {
+    if ( e->contains( UpdateEvent::GlobalAccess ) && m_sessionExpired ) {
         m_sessionExpired = false;
         initialUpdateData();
     }
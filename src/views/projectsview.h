@@ -22,6 +22,9 @@
 
 #include "views/view.h"
 
+#include <QDateTime>
+#include <QHash>
+
 class ProjectsModel;
 
 class QTreeView;
@@ -78,6 +81,8 @@ private slots:
     void updateSelection();
 
     void updateTimeout();
+    void periodicUpdateCompleted( bool successful );
+    void applicationStateChanged( Qt::ApplicationState state );
 
     void updateProjects();
     void managePermissions();
@@ -100,16 +105,58 @@ private:
 
     void initialUpdateData();
     void periodicUpdateData( bool full );
+    void periodicUpdateFolders( const QList<int>& folders );
     void cascadeUpdateFolders();
 
+    void scheduleUpdate();
+    bool isPaused() const;
+
+    int updateInterval() const;
+    QDateTime jitteredTime( int interval ) const;
+
+    QList<int> activeFolders() const;
+    QDateTime nextGlobalUpdate() const;
+    QDateTime nextFolderUpdate( int folderId ) const;
+
+    bool checkFolderStamps();
+
+private:
+    /**
+    * The maximum number of times the update interval is doubled when nothing changes.
+    */
+    static const int MaxBackoff = 4;
+
+    /**
+    * The time in seconds after a change during which the interval is not increased.
+    */
+    static const int RecentChangePeriod = 15 * 60;
+
+    /**
+    * The time in seconds after which an inactive application stops updating.
+    */
+    static const int IdleTimeout = 30 * 60;
+
 private:
     QTreeView* m_list;
     ProjectsModel* m_model;
 
     QTimer* m_timer;
 
-    int m_folderUpdateCounter;
-    int m_updateCounter;
+    int m_backoff;
+    bool m_updatePending;
+
+    bool m_periodicUpdate;
+    bool m_globalUpdate;
+    QList<int> m_updatedFolders;
+
+    QDateTime m_lastUpdate;
+    QDateTime m_nextUpdate;
+    QDateTime m_lastFullUpdate;
+    QDateTime m_inactiveSince;
+
+    QHash<int, int> m_folderStamps;
+    QHash<int, QDateTime> m_folderChanges;
+    QHash<int, QDateTime> m_folderUpdates;
 
     int m_selectedProjectId;
     int m_selectedFolderId;
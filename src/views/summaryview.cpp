@@ -431,23 +431,16 @@ void SummaryView::updateEvent( UpdateEvent* e )
     setAccess( checkDataAccess() );
 
     if ( isEnabled() ) {
-        if ( e->unit() == UpdateEvent::Summary && e->id() == id() ) {
+        if ( e->contains( UpdateEvent::Summary, id() ) || e->contains( UpdateEvent::Projects ) ) {
             updateCaption();
             updateActions();
             populateSummaryDelayed();
-        }
-
-        if ( e->unit() == UpdateEvent::Projects ) {
-            updateCaption();
-            updateActions();
+        } else if ( e->contains( UpdateEvent::Users ) ) {
             populateSummaryDelayed();
         }
-
-        if ( e->unit() == UpdateEvent::Users )
-            populateSummaryDelayed();
     }
 
-    if ( id() != 0 && e->unit() == UpdateEvent::Projects )
+    if ( id() != 0 && e->contains( UpdateEvent::Projects ) )
         cascadeUpdateProject();
 }
 
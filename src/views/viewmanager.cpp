@@ -25,6 +25,7 @@
 #include "viewerwindow.h"
 
 #include <QApplication>
+#include <QWidget>
 
 ViewManager* viewManager = NULL;
 
@@ -152,3 +153,18 @@ bool ViewManager::isStandAlone( View* view )
 {
     return m_views.value( view, NULL ) != NULL;
 }
+
+QList<int> ViewManager::visibleViewIds( const char* className ) const
+{
+    QList<int> result;
+
+    for ( QMap<View*, ViewerWindow*>::const_iterator it = m_views.constBegin(); it != m_views.constEnd(); ++it ) {
+        View* view = it.key();
+        if ( !view->inherits( className ) || view->id() == 0 || result.contains( view->id() ) )
+            continue;
+        if ( view->mainWidget() && view->mainWidget()->isVisible() )
+            result.append( view->id() );
+    }
+
+    return result;
+}
@@ -118,6 +118,14 @@ public:
     */
     bool isStandAlone( View* view );
 
+    /**
+    * Return identifiers of visible views of the given type.
+    * Views which have no identifier or are hidden, for example in
+    * an inactive page of the main window, are not included.
+    * @param className The name of the view class.
+    */
+    QList<int> visibleViewIds( const char* className ) const;
+
 private:
     View* openView( const char* className, int id );
 
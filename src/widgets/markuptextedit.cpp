@@ -36,6 +36,7 @@
 #include <QWebView>
 #include <QInputDialog>
 #include <QDesktopWidget>
+#include <QRegExp>
 
 static void createButton( const QIcon& icon, const QString& text, QWidget* parent, QObject* receiver, const char* method, const QKeySequence& shortcut = QKeySequence() )
 {
@@ -146,7 +146,7 @@ void InputLineValueEditor::initializeDateTime( const DefinitionInfo& info, QWidg
     DateTimeLineEdit* edit = new DateTimeLineEdit( parentWidget );
 
     edit->setWithTime( info.metadata( "time" ).toBool() );
-    edit->setLocalTime( info.metadata( "local" ).toBool() );
+    edit->setLocalTime( info.isLocal() );
 
     edit->setRequired( info.metadata( "required" ).toBool() );
 
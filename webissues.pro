@@ -3,6 +3,10 @@ include( config.pri )
 TEMPLATE = subdirs
 SUBDIRS  = src
 
+benchmarks {
+    SUBDIRS += src/benchmarks
+}
+
 # NOTE: if you change the installation paths, please update application.cpp accordingly
 
 win32 {